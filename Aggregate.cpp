@@ -0,0 +1,232 @@
+#include "HeaderFiles/Aggregate.h"
+#include <algorithm>
+#include <cstring>
+
+AggregateFunction findAggregateFunction(const char* name){
+    if(strcmp(name, "count") == 0){
+        return AggregateFunction::count;
+    }
+    else if(strcmp(name, "sum") == 0){
+        return AggregateFunction::sum;
+    }
+    else if(strcmp(name, "min") == 0){
+        return AggregateFunction::min;
+    }
+    else if(strcmp(name, "max") == 0){
+        return AggregateFunction::max;
+    }
+    else if(strcmp(name, "avg") == 0){
+        return AggregateFunction::avg;
+    }
+    return AggregateFunction::error;
+}
+
+const char* aggregateName(AggregateFunction function){
+    switch(function){
+        case AggregateFunction::count:
+            return "count";
+        case AggregateFunction::sum:
+            return "sum";
+        case AggregateFunction::min:
+            return "min";
+        case AggregateFunction::max:
+            return "max";
+        case AggregateFunction::avg:
+            return "avg";
+        case AggregateFunction::none:
+        case AggregateFunction::error:
+            break;
+    }
+    return "?";
+}
+
+/// Bytes identifying value in hash map. 0.0 and -0.0 are same group
+static std::string groupKey(const Value& value){
+    switch(value.type){
+        case DataType::Int:
+            return std::string(reinterpret_cast<const char*>(&value.intValue), sizeof(int32_t));
+        case DataType::Float: {
+            float normalised = value.floatValue == 0 ? 0.0f : value.floatValue;
+            return std::string(reinterpret_cast<const char*>(&normalised), sizeof(float));
+        }
+        case DataType::Char:
+            return std::string(1, value.charValue);
+        case DataType::Bool:
+            return std::string(1, value.boolValue ? 1 : 0);
+        case DataType::String:
+            return std::string(value.stringValue, value.stringSize);
+    }
+    return "";
+}
+
+// =============================================
+//                 AGGREGATE SPEC
+// =============================================
+
+AggregateSpec::AggregateSpec(){
+    function = AggregateFunction::none;
+    column = -1;
+    position = -1;
+}
+
+// =============================================
+//                  OWNED VALUE
+// =============================================
+
+OwnedValue::OwnedValue(){
+    isSet = false;
+}
+
+void OwnedValue::set(const Value& value_){
+    value = value_;
+    if(value.type == DataType::String) text.assign(value.stringValue, value.stringSize);
+    isSet = true;
+}
+
+Value OwnedValue::get() const{
+    Value res = value;
+    if(res.type == DataType::String){
+        res.stringValue = text.data();
+        res.stringSize = text.size();
+    }
+    return res;
+}
+
+// =============================================
+//                  ACCUMULATOR
+// =============================================
+
+Accumulator::Accumulator(){
+    count = 0;
+    intSum = 0;
+    floatSum = 0;
+}
+
+void Accumulator::add(const Value& value){
+    ++count;
+    if(value.type == DataType::Int) intSum += value.intValue;
+    else if(value.type == DataType::Float) floatSum += value.floatValue;
+
+    if(!min.isSet || value.compare(min.get()) < 0) min.set(value);
+    if(!max.isSet || value.compare(max.get()) > 0) max.set(value);
+}
+
+void Accumulator::write(AggregateFunction function, ResultSink& sink) const{
+    if(function == AggregateFunction::count){
+        sink.integer(count);
+        return;
+    }
+    if(count == 0){
+        sink.null();
+        return;
+    }
+
+    switch(function){
+        case AggregateFunction::sum:
+            if(min.get().type == DataType::Int) sink.integer(intSum);
+            else sink.real(floatSum);
+            break;
+        case AggregateFunction::avg: {
+            double sum = (min.get().type == DataType::Int) ? static_cast<double>(intSum) : floatSum;
+            sink.real(sum / count);
+            break;
+        }
+        case AggregateFunction::min:
+            sink.value(min.get());
+            break;
+        case AggregateFunction::max:
+            sink.value(max.get());
+            break;
+        default:
+            break;
+    }
+}
+
+// =============================================
+//                  AGGREGATOR
+// =============================================
+
+Aggregator::Aggregator(std::vector<AggregateSpec> specs_, int32_t groupPosition_, bool streaming_, ResultSink& sink_): sink(sink_){
+    this->specs = std::move(specs_);
+    this->groupPosition = groupPosition_;
+    this->streaming = streaming_;
+    this->groupCount = 0;
+
+    // Without group by there is exactly one group even for empty input
+    if(groupPosition == -1){
+        groupValues.emplace_back();
+        accumulators.resize(specs.size());
+    }
+}
+
+int32_t Aggregator::findGroup(const Value& value){
+    if(streaming){
+        if(!groupValues.empty()){
+            if(value.compare(groupValues[0].get()) == 0) return 0;
+            if(!emit(0)) return -1;
+        }
+        groupValues.assign(1, OwnedValue());
+        groupValues[0].set(value);
+        accumulators.assign(specs.size(), Accumulator());
+        return 0;
+    }
+
+    auto inserted = groupIndex.emplace(groupKey(value), groupValues.size());
+    if(inserted.second){
+        groupValues.emplace_back();
+        groupValues.back().set(value);
+        accumulators.resize(accumulators.size() + specs.size());
+    }
+    return inserted.first->second;
+}
+
+bool Aggregator::consume(const RowBatch& batch){
+    for(int32_t s = 0; s < batch.selected; ++s){
+        int32_t i = batch.selection[s];
+        int32_t group = 0;
+        if(groupPosition != -1){
+            group = findGroup(batch.columns[groupPosition].get(i));
+            if(group == -1) return false;
+        }
+
+        Accumulator* groupAccumulators = accumulators.data() + group * specs.size();
+        for(int32_t a = 0; a < specs.size(); ++a){
+            auto& spec = specs[a];
+            if(spec.function == AggregateFunction::none) continue;
+            if(spec.position == -1) ++groupAccumulators[a].count;
+            else groupAccumulators[a].add(batch.columns[spec.position].get(i));
+        }
+    }
+    return true;
+}
+
+bool Aggregator::emit(int32_t group){
+    const Accumulator* groupAccumulators = accumulators.data() + group * specs.size();
+    sink.beginRow();
+    for(int32_t a = 0; a < specs.size(); ++a){
+        if(specs[a].function == AggregateFunction::none) sink.value(groupValues[group].get());
+        else groupAccumulators[a].write(specs[a].function, sink);
+    }
+    sink.endRow();
+    ++groupCount;
+    return true;
+}
+
+bool Aggregator::finish(){
+    if(groupPosition == -1 || streaming){
+        if(!groupValues.empty() && !emit(0)) return false;
+        groupValues.clear();
+        return true;
+    }
+
+    // Hash aggregation keeps groups in arrival order so they are sorted before printing
+    std::vector<int32_t> order(groupValues.size());
+    for(int32_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int32_t a, int32_t b){
+        return groupValues[a].get().compare(groupValues[b].get()) < 0;
+    });
+    for(int32_t group: order){
+        if(!emit(group)) return false;
+    }
+    return true;
+}
@@ -11,7 +11,8 @@
  */
 
 template <typename node_t>
-BPTreeNodeManager<node_t>::BPTreeNodeManager(const char* fileName, int32_t branchingFactor_, int32_t keySize_, int nodeLimit): base_t(nodeLimit){
+BPTreeNodeManager<node_t>::BPTreeNodeManager(const char* fileName, int32_t branchingFactor_, int32_t keySize_, WriteAheadLog* log_,
+                                             int64_t logOwner, int nodeLimit): base_t(nodeLimit){
     this->rootPageNum = 1;
     this->numPages = 0;
     this->branchingFactor = branchingFactor_;
@@ -21,7 +22,7 @@ BPTreeNodeManager<node_t>::BPTreeNodeManager(const char* fileName, int32_t branc
     this->stackSize = 0;
     this->indexStack = nullptr;
 
-    if(!this->open(fileName)){
+    if(!this->open(fileName, log_, logOwner)){
         throw std::runtime_error("Unable to Open Table");
     }
     this->getRoot();
@@ -41,13 +42,8 @@ bool BPTreeNodeManager<node_t>::getRoot(){
 
     root = std::make_unique<node_t>();
     // root->isLeaf = true;
-    this->fileLength = static_cast<uint32_t>(lseek(this->fileDescriptor, 0, SEEK_END));
-    this->maxPages = (this->fileLength + PAGE_SIZE - 1) / PAGE_SIZE;
-    if(this->maxPages > rootPageNum){
-        lseek(this->fileDescriptor, rootPageNum * PAGE_SIZE, SEEK_SET);
-        char* buffer = this->root->buffer.get();
-        ssize_t bytesRead = ::read(this->fileDescriptor, buffer, PAGE_SIZE);
-        if(bytesRead == -1){
+    if(this->pageCount() > rootPageNum){
+        if(!this->readPage(rootPageNum, this->root->buffer.get())){
             printf("Error reading Root Node: %d\n", errno);
             return false;
         }
@@ -66,13 +62,8 @@ template <typename node_t>
 bool BPTreeNodeManager<node_t>::getHeader(){
     if(this->header != nullptr) return true;
     this->header = std::make_unique<node_t>();
-    this->fileLength = static_cast<uint32_t>(lseek(this->fileDescriptor, 0, SEEK_END));
-    this->maxPages = (this->fileLength + PAGE_SIZE - 1) / PAGE_SIZE;
-    if(this->maxPages > 0){
-        lseek(this->fileDescriptor, 0, SEEK_SET);
-        char* buffer = this->header->buffer.get();
-        ssize_t bytesRead = ::read(this->fileDescriptor, buffer, PAGE_SIZE);
-        if(bytesRead == -1){
+    if(this->pageCount() > 0){
+        if(!this->readPage(0, this->header->buffer.get())){
             printf("Error reading Root Node: %d\n", errno);
             return false;
         }
@@ -153,13 +144,48 @@ bool BPTreeNodeManager<node_t>::flushAll(){
     return true;
 }
 
+template <typename node_t>
+bool BPTreeNodeManager<node_t>::flushChanges(){
+    if(!base_t::flushChanges()) return false;
+    if(root != nullptr && root->hasUncommitedChanges) return flushPage(root.get());
+    return true;
+}
+
+template <typename node_t>
+bool BPTreeNodeManager<node_t>::truncate(){
+    // Cached nodes are dropped so root must not point at them
+    root->unswizzle();
+    if(!base_t::truncate(1)) return false;
+
+    numPages = 0;
+    rootPageNum = 1;
+    indexStack[0] = 0;
+    root = std::make_unique<node_t>();
+    root->pageNum = rootPageNum;
+    root->allocate(2 * branchingFactor - 1, keySize);
+    incrementPageNum();
+    serializeHeaderMetaData();
+    this->header->hasUncommitedChanges = true;
+    return true;
+}
+
+/// Swizzled nodes are still reachable by pointer from their parent.
+/// They are unswizzled and kept for one more round so that hot inner nodes
+/// which never touch the LRU queue are not thrown out right away.
+template <typename node_t>
+bool BPTreeNodeManager<node_t>::canEvict(node_t* node){
+    if(node->swizzleParent != nullptr){
+        node->detachFromParent();
+        return false;
+    }
+    node->unswizzle();
+    return true;
+}
+
 template <typename node_t>
 bool BPTreeNodeManager<node_t>::flushPage(node_t* node){
-    off_t offset = lseek(this->fileDescriptor, node->pageNum * PAGE_SIZE, SEEK_SET);
-    if (offset == -1) return false;
     if(node->pageNum != 0) node->writeHeader();
-    ssize_t bytesWritten = write(this->fileDescriptor, node->buffer.get(), PAGE_SIZE);
-    if (bytesWritten == -1) return false;
+    if(!this->writePage(node->pageNum, node->buffer.get())) return false;
     node->hasUncommitedChanges = false;
     return true;
 }
@@ -168,8 +194,15 @@ template <typename node_t>
 row_t BPTreeNodeManager<node_t>::nextFreeIndexLocation(){
     if(indexStack[0] == 0) return numPages + 1;
     row_t nextRow = indexStack[indexStack[0]];
-    indexStack[0]--;
     this->header->hasUncommitedChanges = true;
+    if(nextRow < 0){
+        // Head of chain of freed pages. Its page holds the entry that was below it
+        nextRow = -nextRow;
+        node_t* node = read(nextRow);
+        memcpy(indexStack + indexStack[0], node->buffer.get() + BPTNodeHeaderSize, sizeof(row_t));
+        return nextRow;
+    }
+    indexStack[0]--;
     return nextRow;
 //    if(stackPtr == 0) return numPages + 1;
 //    Page* page = this->header.get();
@@ -197,14 +230,20 @@ void BPTreeNodeManager<node_t>::decrementPageNum(){
 }
 
 template <typename node_t>
-void BPTreeNodeManager<node_t>::addFreeIndexLocation(row_t location){
-    ++indexStack[0];
-    if(indexStack[0] >= stackSize){
-        printf("Stack Overflow occurred in main table.\n");
-        throw std::runtime_error("STACK OVERFLOWS HEADER PAGE");
-    }
-    indexStack[indexStack[0]] = location;
+void BPTreeNodeManager<node_t>::addFreeIndexLocation(node_t* node){
     this->header->hasUncommitedChanges = true;
+    if(indexStack[0] + 1 < stackSize){
+        ++indexStack[0];
+        indexStack[indexStack[0]] = node->pageNum;
+        node->hasUncommitedChanges = false;
+        return;
+    }
+
+    // Header page is full. Freed page keeps top entry and top becomes negated page number,
+    // chaining freed pages through themselves
+    memcpy(node->buffer.get() + BPTNodeHeaderSize, indexStack + indexStack[0], sizeof(row_t));
+    indexStack[indexStack[0]] = -node->pageNum;
+    node->hasUncommitedChanges = true;
 
 //    Page* page = this->header.get();
 //    char* buffer = page->buffer.get();
@@ -221,14 +260,24 @@ template<typename node_t>
 node_t* BPTreeNodeManager<node_t>::newNode(){
     row_t pageNum = nextFreeIndexLocation();
     incrementPageNum();
-    return read(pageNum);
+    node_t* node = read(pageNum);
+
+    // Page may be one freed by deleteNode whose frame still holds its old header
+    node->isLeaf = false;
+    node->size = 0;
+    node->leftSibling_ = 0;
+    node->rightSibling_ = 0;
+    node->unswizzle();
+    node->hasUncommitedChanges = true;
+    return node;
 }
 
 template<typename node_t>
 void BPTreeNodeManager<node_t>::deleteNode(node_t* node){
+    node->unswizzle();
+    node->detachFromParent();
     decrementPageNum();
-    addFreeIndexLocation(node->pageNum);
-    node->hasUncommitedChanges = false;
+    addFreeIndexLocation(node);
 }
 
 template<typename node_t>
@@ -245,6 +294,7 @@ void BPTreeNodeManager<node_t>::setRoot(node_t* newNode){
 
     // Set root to newRoot
     root = std::move(temp);
+    root->detachFromParent();
     this->rootPageNum = root->pageNum;
     Page* page = this->header.get();
     char* buffer = page->buffer.get();
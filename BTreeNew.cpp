@@ -12,7 +12,8 @@ template <> inline dbms::string convertDataType<dbms::string>(const std::string&
 
 
 template <typename key_t>
-BPTree<key_t>::BPTree(const char* filename, int32_t branchingFactor_, int32_t keySize_):manager(filename, branchingFactor_, keySize_){
+BPTree<key_t>::BPTree(const char* filename, int32_t branchingFactor_, int32_t keySize_, WriteAheadLog* log, int64_t logOwner):
+        manager(filename, branchingFactor_, keySize_, log, logOwner){
     this->branchingFactor = branchingFactor_;
     this->keySize = keySize_;
 }
@@ -21,7 +22,45 @@ BPTree<key_t>::BPTree(const char* filename, int32_t branchingFactor_, int32_t ke
 // ------------------------ GETTERS AND SETTERS ------------------------
 template <typename key_t>
 BPTNode<key_t>* BPTNode<key_t>::getChildNode(manager_t& manager, int32_t index){
-    return manager.read(child[index]);
+    // Hot path: child frame is already swizzled, no page map lookup needed
+    if(swizzled != nullptr && swizzled[index] != nullptr) return swizzled[index];
+    // Swizzled hits never refresh this frame, so it may be next in line for eviction
+    PinGuard pins{this};
+    Node* node = manager.read(child[index]);
+    if(node != nullptr) swizzle(index, node, 2 * manager.branchingFactor);
+    return node;
+}
+
+// ------------------------ POINTER SWIZZLING ------------------------
+template <typename key_t>
+void BPTNode<key_t>::swizzle(int32_t index, Node* node, int32_t maxChildren){
+    if(swizzled == nullptr){
+        swizzled = std::make_unique<Node*[]>(maxChildren);
+        swizzledCapacity = maxChildren;
+    }
+    node->detachFromParent();
+    swizzled[index] = node;
+    node->swizzleParent = this;
+    node->swizzleSlot = index;
+}
+
+template <typename key_t>
+void BPTNode<key_t>::unswizzle(){
+    if(swizzled == nullptr) return;
+    for(int32_t i = 0; i < swizzledCapacity; ++i){
+        if(swizzled[i] == nullptr) continue;
+        swizzled[i]->swizzleParent = nullptr;
+        swizzled[i]->swizzleSlot = -1;
+        swizzled[i] = nullptr;
+    }
+}
+
+template <typename key_t>
+void BPTNode<key_t>::detachFromParent(){
+    if(swizzleParent == nullptr) return;
+    swizzleParent->swizzled[swizzleSlot] = nullptr;
+    swizzleParent = nullptr;
+    swizzleSlot = -1;
 }
 
 template <typename key_t>
@@ -90,6 +129,183 @@ void inline BPTNode<dbms::string>::allocate(int32_t maxSize, int32_t keySize){
 template <typename key_t>
 bool BPTree<key_t>::insert(const std::string& keyStr, pkey_t pkey, row_t row) {
     auto key = convertDataType<key_t>(keyStr);
+    return insertKey(key, pkey, row);
+}
+
+template <typename key_t>
+bool BPTree<key_t>::insertCell(const char* cell, pkey_t pkey, row_t row){
+    key_t key;
+    memcpy(&key, cell, sizeof(key_t));
+    return insertKey(key, pkey, row);
+}
+
+template <>
+bool inline BPTree<dbms::string>::insertCell(const char* cell, pkey_t pkey, row_t row){
+    // Cell is not null terminated if string occupies whole column
+    std::vector<char> buffer(keySize + 1, '\0');
+    memcpy(buffer.data(), cell, strnlen(cell, keySize));
+    dbms::string key;
+    key.setBuffer(buffer.data(), keySize);
+    return insertKey(key, pkey, row);
+}
+
+template <typename key_t>
+bool BPTree<key_t>::insertCells(std::vector<std::vector<char>>& runs){
+    using entry_t = std::tuple<key_t, pkey_t, row_t>;
+    int32_t width = keySize + sizeof(pkey_t) + sizeof(row_t);
+    std::vector<std::vector<entry_t>> sortedRuns(runs.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&](){
+        for(size_t r = next++; r < runs.size(); r = next++){
+            auto& sorted = sortedRuns[r];
+            sorted.resize(runs[r].size() / width);
+            for(size_t i = 0; i < sorted.size(); ++i){
+                const char* entry = runs[r].data() + i * width;
+                memcpy(&std::get<0>(sorted[i]), entry, sizeof(key_t));
+                memcpy(&std::get<1>(sorted[i]), entry + keySize, sizeof(pkey_t));
+                memcpy(&std::get<2>(sorted[i]), entry + keySize + sizeof(pkey_t), sizeof(row_t));
+            }
+            std::vector<char>().swap(runs[r]);
+            std::sort(sorted.begin(), sorted.end());
+        }
+    };
+    int32_t threadCount = std::min<int32_t>(runs.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for(int32_t i = 1; i < threadCount; ++i) threads.emplace_back(worker);
+    worker();
+    for(auto& thread: threads) thread.join();
+
+    // K-way merge of sorted runs
+    std::vector<entry_t> sorted;
+    if(sortedRuns.size() == 1){
+        sorted = std::move(sortedRuns[0]);
+    }
+    else{
+        size_t total = 0;
+        for(auto& run: sortedRuns) total += run.size();
+        sorted.reserve(total);
+        using head_t = std::pair<entry_t, size_t>;
+        std::priority_queue<head_t, std::vector<head_t>, std::greater<>> heads;
+        std::vector<size_t> positions(sortedRuns.size(), 0);
+        for(size_t r = 0; r < sortedRuns.size(); ++r){
+            if(!sortedRuns[r].empty()) heads.emplace(sortedRuns[r][0], r);
+        }
+        while(!heads.empty()){
+            size_t r = heads.top().second;
+            sorted.push_back(heads.top().first);
+            heads.pop();
+            if(++positions[r] < sortedRuns[r].size()) heads.emplace(sortedRuns[r][positions[r]], r);
+            else std::vector<entry_t>().swap(sortedRuns[r]);
+        }
+    }
+    if(manager.root->size == 0) return bulkLoad(sorted);
+
+    for(auto& entry: sorted){
+        if(!insertKey(std::get<0>(entry), std::get<1>(entry), std::get<2>(entry))) return false;
+    }
+    return true;
+}
+
+/// String trees are not supported. Table::createIndex never builds one, so bulk paths refuse them
+template <>
+bool inline BPTree<dbms::string>::insertCells(std::vector<std::vector<char>>& runs){
+    return false;
+}
+
+/// Builds an empty tree one level at a time from entries sorted on (key, pkey)
+/// Every level is cut into as few nodes as fit and entries are spread evenly among them, so each
+/// non root node holds at least branchingFactor-1 keys. Separator of a child is its largest entry
+/// Level that fits in one node is written to root which keeps its page
+template <typename key_t>
+bool BPTree<key_t>::bulkLoad(const std::vector<std::tuple<key_t, pkey_t, row_t>>& entries){
+    Node* root = manager.root.get();
+    int32_t maxSize = 2 * branchingFactor - 1;
+    if(entries.empty()) return true;
+    root->unswizzle();
+    root->leftSibling_ = 0;
+    root->rightSibling_ = 0;
+    if(entries.size() <= maxSize){
+        for(int32_t i = 0; i < entries.size(); ++i){
+            root->keys[i] = std::get<0>(entries[i]);
+            root->pkeys[i] = std::get<1>(entries[i]);
+            root->child[i] = std::get<2>(entries[i]);
+        }
+        root->isLeaf = true;
+        root->size = entries.size();
+        root->hasUncommitedChanges = true;
+        return true;
+    }
+
+    // (page, largest key, largest pkey) of every node of level being built
+    struct Built{
+        row_t page;
+        key_t key;
+        pkey_t pkey;
+    };
+    std::vector<Built> level;
+
+    size_t nodes = (entries.size() + maxSize - 1) / maxSize;
+    size_t next = 0;
+    Node* previous = nullptr;
+    for(size_t n = 0; n < nodes; ++n){
+        size_t count = entries.size() / nodes + (n < entries.size() % nodes ? 1 : 0);
+        PinGuard pins{previous};
+        Node* leaf = manager.newNode();
+        leaf->isLeaf = true;
+        for(int32_t i = 0; i < count; ++i, ++next){
+            leaf->keys[i] = std::get<0>(entries[next]);
+            leaf->pkeys[i] = std::get<1>(entries[next]);
+            leaf->child[i] = std::get<2>(entries[next]);
+        }
+        leaf->size = count;
+        if(previous != nullptr){
+            leaf->leftSibling_ = previous->pageNum;
+            previous->rightSibling_ = leaf->pageNum;
+            previous->hasUncommitedChanges = true;
+        }
+        level.push_back({leaf->pageNum, leaf->keys[count-1], leaf->pkeys[count-1]});
+        previous = leaf;
+    }
+
+    // Internal node of k children has k-1 separators
+    int32_t maxChildren = maxSize + 1;
+    while(true){
+        bool last = (level.size() <= maxChildren);
+        nodes = last ? 1 : (level.size() + maxChildren - 1) / maxChildren;
+        std::vector<Built> parents;
+        next = 0;
+        previous = nullptr;
+        for(size_t n = 0; n < nodes; ++n){
+            size_t count = level.size() / nodes + (n < level.size() % nodes ? 1 : 0);
+            PinGuard pins{previous};
+            Node* node = last ? root : manager.newNode();
+            node->isLeaf = false;
+            for(int32_t i = 0; i < count; ++i, ++next){
+                node->child[i] = level[next].page;
+                if(i + 1 < count){
+                    node->keys[i] = level[next].key;
+                    node->pkeys[i] = level[next].pkey;
+                }
+            }
+            node->size = count - 1;
+            node->hasUncommitedChanges = true;
+
+            // Nodes of one level are linked like leaves
+            if(previous != nullptr){
+                node->leftSibling_ = previous->pageNum;
+                previous->rightSibling_ = node->pageNum;
+                previous->hasUncommitedChanges = true;
+            }
+            parents.push_back({node->pageNum, level[next-1].key, level[next-1].pkey});
+            previous = node;
+        }
+        if(last) return true;
+        level = std::move(parents);
+    }
+}
+
+template <typename key_t>
+bool BPTree<key_t>::insertKey(const key_t& key, pkey_t pkey, row_t row) {
     auto root = manager.root.get();
     if(root->size == 0){
         root->keys[0] = key;
@@ -163,9 +379,11 @@ void BPTree<key_t>::splitRoot(){
 //    auto newNode = manager.read(nextPageLocation);
 //    manager.incrementPageNum();
     auto newRoot = manager.newNode();
+    PinGuard pins{newRoot};
     auto newNode = manager.newNode();
 
     auto root = manager.root.get();
+    root->unswizzle();
     if (root->isLeaf) {
         newRoot->isLeaf = true;
         newNode->isLeaf = true;
@@ -213,6 +431,11 @@ void BPTree<key_t>::splitRoot(){
 template <typename key_t>
 void BPTree<key_t>::splitNode(Node* parent, Node* child, int indexFound){
     int maxSize = 2*branchingFactor - 1;
+    parent->unswizzle();
+    child->unswizzle();
+
+    // Loading new sibling and its right neighbour must not evict nodes being split
+    PinGuard pins{parent, child};
 
     // Shift keys right to accommodate a key from child
     for(int i = parent->size - 1; i >= indexFound; --i){
@@ -227,6 +450,7 @@ void BPTree<key_t>::splitNode(Node* parent, Node* child, int indexFound){
     // Node* newSibling = manager.read(nextPageNo);
     // manager.incrementPageNum();
     auto newSibling = manager.newNode();
+    pins.add(newSibling);
     newSibling->isLeaf = child->isLeaf;
 
     // Copy right half keys to newNode
@@ -337,16 +561,34 @@ int32_t BPTree<key_t>::binarySearch(Node* node, const key_t& key, const pkey_t p
 template <typename key_t>
 bool BPTree<key_t>::remove(const std::string& keyStr, const pkey_t pkey){
     auto key = convertDataType<key_t>(keyStr);
-    Node* root = manager.root.get();
-    if(root == nullptr || root->size == 0){
-        return false;
-    }
+    return removeKey(key, pkey);
+}
+
+template <typename key_t>
+bool BPTree<key_t>::removeCell(const char* cell, pkey_t pkey){
+    key_t key;
+    memcpy(&key, cell, sizeof(key_t));
+    return removeKey(key, pkey);
+}
 
-    Node* current = root;
+template <>
+bool inline BPTree<dbms::string>::removeCell(const char* cell, pkey_t pkey){
+    std::vector<char> buffer(keySize + 1, '\0');
+    memcpy(buffer.data(), cell, strnlen(cell, keySize));
+    dbms::string key;
+    key.setBuffer(buffer.data(), keySize);
+    return removeKey(key, pkey);
+}
+
+/// Descends to leaf where (key, pkey) lies. Every node passed on the way is left with more than
+/// branchingFactor-1 entries so that one entry can be removed from leaf without fixing parents
+template <typename key_t>
+BPTNode<key_t>* BPTree<key_t>::leafForRemove(const key_t& key, const pkey_t pkey){
+    Node* current = manager.root.get();
     Node* child;
-    int maxSize = 2*branchingFactor - 1;
+    // Entries with equal keys are ordered on pkey so (key, pkey) leads to the leaf holding this entry
     while(!current->isLeaf){
-        int indexFound = binarySearch(current, key, -1);
+        int indexFound = binarySearch(current, key, pkey);
         child = current->getChildNode(manager, indexFound);
 
         if(child->size != branchingFactor - 1){
@@ -355,14 +597,21 @@ bool BPTree<key_t>::remove(const std::string& keyStr, const pkey_t pkey){
         }
 
         // If child is of size branchingFactor-1 fix it and then traverse in
-        bool flag = false;
         Node *leftSibling = nullptr, *rightSibling = nullptr;
 
-        if(indexFound > 0 && (leftSibling = current->getChildNode(manager, indexFound - 1)) && leftSibling->size > branchingFactor-1){
+        // Siblings are read while child and left sibling are held
+        PinGuard pins{child};
+        if(indexFound > 0){
+            leftSibling = current->getChildNode(manager, indexFound - 1);
+            pins.add(leftSibling);
+        }
+        if(leftSibling != nullptr && leftSibling->size > branchingFactor-1){
             borrowFromLeftSibling(indexFound, current, child, leftSibling);
             current = child;
+            continue;
         }
-        else if(indexFound < current->size && (rightSibling = current->getChildNode(manager, indexFound + 1)) && rightSibling->size > branchingFactor-1){
+        if(indexFound < current->size) rightSibling = current->getChildNode(manager, indexFound + 1);
+        if(rightSibling != nullptr && rightSibling->size > branchingFactor-1){
             borrowFromRightSibling(indexFound, current, child, rightSibling);
             current = child;
         }
@@ -370,12 +619,22 @@ bool BPTree<key_t>::remove(const std::string& keyStr, const pkey_t pkey){
             mergeWithSibling(indexFound, current, child, leftSibling, rightSibling);
         }
     }
+    return current;
+}
+
+template <typename key_t>
+bool BPTree<key_t>::removeKey(const key_t& key, const pkey_t pkey){
+    Node* root = manager.root.get();
+    if(root == nullptr || root->size == 0){
+        return false;
+    }
+
+    Node* current = leafForRemove(key, pkey);
 
     // Now we are in a leaf node
     int indexFound = binarySearch(current, key, pkey);
     if(indexFound < current->size) {
-        if (current->keys[indexFound] == key){
-            pkey_t pkey = current->pkeys[indexFound];
+        if (current->keys[indexFound] == key && current->pkeys[indexFound] == pkey){
             deleteAtLeaf(current, indexFound);
             if(indexFound == current->size && root->size != 0){
                 removeHelper(key, pkey);
@@ -396,34 +655,7 @@ bool BPTree<key_t>::remove(const std::string& keyStr, const callback_t& callback
             return true;
         }
 
-        Node* current = root;
-        Node* child;
-        int maxSize = 2*branchingFactor - 1;
-        while(!current->isLeaf){
-            int indexFound = binarySearch(current, key, -1);
-            child = current->getChildNode(manager, indexFound);
-
-            if(child->size != branchingFactor - 1){
-                current = child;
-                continue;
-            }
-
-            // If child is of size branchingFactor-1 fix it and then traverse in
-            bool flag = false;
-            Node* leftSibling = nullptr, *rightSibling = nullptr;
-
-            if(indexFound > 0 && (leftSibling = current->getChildNode(manager, indexFound - 1)) && leftSibling->size > branchingFactor-1){
-                borrowFromLeftSibling(indexFound, current, child, leftSibling);
-                current = child;
-            }
-            else if(indexFound < current->size && (rightSibling = current->getChildNode(manager, indexFound + 1)) && rightSibling->size > branchingFactor-1){
-                borrowFromRightSibling(indexFound, current, child, rightSibling);
-                current = child;
-            }
-            else{
-                mergeWithSibling(indexFound, current, child, leftSibling, rightSibling);
-            }
-        }
+        Node* current = leafForRemove(key, -1);
 
         // Now we are in a leaf node
         int indexFound = binarySearch(current, key, -1);
@@ -443,12 +675,93 @@ bool BPTree<key_t>::remove(const std::string& keyStr, const callback_t& callback
     }
 }
 
+template <typename key_t>
+bool BPTree<key_t>::removeCells(const std::vector<char>& entries){
+    int32_t width = keySize + sizeof(pkey_t);
+    std::vector<std::pair<key_t, pkey_t>> sorted(entries.size() / width);
+    for(size_t i = 0; i < sorted.size(); ++i){
+        memcpy(&sorted[i].first, entries.data() + i * width, sizeof(key_t));
+        memcpy(&sorted[i].second, entries.data() + i * width + keySize, sizeof(pkey_t));
+    }
+    std::sort(sorted.begin(), sorted.end());
+    return removeSorted(sorted);
+}
+
+/// String trees are not supported. See insertCells
+template <>
+bool inline BPTree<dbms::string>::removeCells(const std::vector<char>& entries){
+    return false;
+}
+
+/// Leaf reached for first pending entry is walked once alongside entries and compacted in place
+/// Leaf keeps at least branchingFactor-1 entries so that later merges stay valid. Entries left
+/// over are taken up by next descent. Parent separator is fixed once if max of leaf was removed
+template <typename key_t>
+bool BPTree<key_t>::removeSorted(const std::vector<std::pair<key_t, pkey_t>>& entries){
+    bool res = true;
+    size_t next = 0;
+    while(next < entries.size()){
+        if(manager.root->size == 0) return false;
+        Node* leaf = leafForRemove(entries[next].first, entries[next].second);
+        bool isRoot = (leaf == manager.root.get());
+        int32_t removable = isRoot ? leaf->size : leaf->size - (branchingFactor - 1);
+        std::pair<key_t, pkey_t> oldMax(leaf->keys[leaf->size-1], leaf->pkeys[leaf->size-1]);
+
+        size_t first = next;
+        int32_t removed = 0;
+        int32_t kept = 0;
+        for(int32_t i = 0; i < leaf->size; ++i){
+            if(removed < removable){
+                std::pair<key_t, pkey_t> current(leaf->keys[i], leaf->pkeys[i]);
+                // Entries before current entry of leaf are not in tree
+                for(; next < entries.size() && entries[next] < current; ++next) res = false;
+                if(next < entries.size() && entries[next] == current){
+                    ++removed;
+                    ++next;
+                    continue;
+                }
+            }
+            if(kept != i){
+                leaf->keys[kept] = leaf->keys[i];
+                leaf->pkeys[kept] = leaf->pkeys[i];
+                leaf->child[kept] = leaf->child[i];
+            }
+            ++kept;
+        }
+
+        // First entry is past every entry of its leaf
+        if(next == first){
+            res = false;
+            ++next;
+        }
+        if(removed == 0) continue;
+
+        leaf->size = kept;
+        leaf->hasUncommitedChanges = true;
+        if(!isRoot && std::make_pair(leaf->keys[kept-1], leaf->pkeys[kept-1]) != oldMax){
+            removeHelper(oldMax.first, oldMax.second);
+        }
+    }
+    return res;
+}
+
+template <typename key_t>
+bool BPTree<key_t>::truncate(){
+    return manager.truncate();
+}
+
+template <typename key_t>
+bool BPTree<key_t>::flushChanges(){
+    return manager.flushChanges();
+}
+
 template <typename key_t>
 void BPTree<key_t>::removeHelper(const key_t& key, const pkey_t pkey){
     Node* current = manager.root.get();
     while(!current->isLeaf){
         int indexFound = binarySearch(current, key, pkey);
         if(indexFound < current->size && current->keys[indexFound] == key && current->pkeys[indexFound] == pkey){
+            PinGuard pins{current};
             auto maxInLeftChild = getMax(current->getChildNode(manager, indexFound));
             current->keys[indexFound] = std::move(maxInLeftChild.first);
             current->pkeys[indexFound] = maxInLeftChild.second;
@@ -487,6 +800,8 @@ row_t BPTree<key_t>::deleteAtLeaf(Node* node, int index){
 
 template <typename key_t>
 void BPTree<key_t>::borrowFromLeftSibling(int indexFound, Node* parent, Node* child, Node* leftSibling){
+    child->unswizzle();
+    leftSibling->unswizzle();
     if(child->isLeaf){
         for(int i = child->size-1; i >= 0; --i){
             child->keys[i+1] = child->keys[i];
@@ -521,6 +836,8 @@ void BPTree<key_t>::borrowFromLeftSibling(int indexFound, Node* parent, Node* ch
 
 template <typename key_t>
 void BPTree<key_t>::borrowFromRightSibling(int indexFound, Node* parent, Node* child, Node* rightSibling){
+    child->unswizzle();
+    rightSibling->unswizzle();
     if (child->isLeaf) {
         parent->keys[indexFound] = rightSibling->keys[0];
         parent->pkeys[indexFound] = rightSibling->pkeys[0];
@@ -558,6 +875,13 @@ void BPTree<key_t>::borrowFromRightSibling(int indexFound, Node* parent, Node* c
 template <typename key_t>
 void BPTree<key_t>::mergeWithSibling(int indexFound, Node*& parent, Node* child, Node* leftSibling, Node* rightSibling){
     int maxSize = 2 * branchingFactor - 1;
+    parent->unswizzle();
+    child->unswizzle();
+    if(leftSibling != nullptr) leftSibling->unswizzle();
+    if(rightSibling != nullptr) rightSibling->unswizzle();
+
+    // Neighbour of child is read below while these are held
+    PinGuard pins{parent, child, leftSibling, rightSibling};
     if(indexFound > 0){
         leftSibling->rightSibling_ =  child->rightSibling_;
         if(leftSibling->rightSibling_) {
@@ -683,35 +1007,48 @@ void BPTree<key_t>::mergeWithSibling(int indexFound, Node*& parent, Node* child,
 
 // ----------------------- JOIN ----------------------
 template <typename key_t>
-void BPTree<key_t>::naturalJoinBothIndex(Node* rootOfOtherBTree, const std::function<void(row_t rowOfCurrent, row_t rowOfOther)>& funcToPrint){
+bool BPTree<key_t>::naturalJoinBothIndex(BPTree<key_t>& other, const std::function<bool(row_t rowOfCurrent, row_t rowOfOther)>& callback){
     Node* currentRoot = manager.root.get();
+    Node* otherRoot = other.manager.root.get();
 
     // when either one is empty
-    if(!currentRoot->size || !rootOfOtherBTree->size) return;
-
-    Node* leftLeafCurrent = leftMostLeaf(currentRoot);
-    Node* leftLeafOther = leftMostLeaf(rootOfOtherBTree);
-
-    result_t itrCurrent = {0, leftLeafCurrent}, itrOther = {0, leftLeafOther};
-    while(itrCurrent.node && itrOther.node) {
+    if(currentRoot == nullptr || otherRoot == nullptr) return true;
+    if(!currentRoot->size || !otherRoot->size) return true;
+
+    result_t itrCurrent, itrOther;
+    itrCurrent.node = leftMostLeaf(currentRoot);
+    itrCurrent.index = 0;
+    itrOther.node = other.leftMostLeaf(otherRoot);
+    itrOther.index = 0;
+
+    // Rows of other tree having same key are buffered once instead of walking back over them
+    // Leaves left behind may already be evicted by then
+    std::vector<row_t> group;
+    while(itrCurrent.node && itrOther.node){
         key_t keyOfCurrent = itrCurrent.node->keys[itrCurrent.index];
         key_t keyOfOther = itrOther.node->keys[itrOther.index];
-        if(keyOfCurrent == keyOfOther){
-            result_t itrTempOther = itrOther;
-            row_t childOfCurrent = itrCurrent.node->child[itrCurrent.index];
-            while(itrTempOther.node && keyOfCurrent == itrTempOther.node->keys[itrTempOther.index]){
-                funcToPrint(childOfCurrent, itrTempOther.node->child[itrTempOther.index]);
-                incrementLinkedList(itrTempOther);
-            }
+        if(keyOfCurrent < keyOfOther){
             incrementLinkedList(itrCurrent);
         }
-        else if(keyOfCurrent < keyOfOther){
-            incrementLinkedList(itrCurrent);
+        else if(keyOfOther < keyOfCurrent){
+            other.incrementLinkedList(itrOther);
         }
-        else {
-            incrementLinkedList(itrOther);
+        else{
+            group.clear();
+            while(itrOther.node && itrOther.node->keys[itrOther.index] == keyOfCurrent){
+                group.push_back(itrOther.node->child[itrOther.index]);
+                other.incrementLinkedList(itrOther);
+            }
+            while(itrCurrent.node && itrCurrent.node->keys[itrCurrent.index] == keyOfCurrent){
+                row_t childOfCurrent = itrCurrent.node->child[itrCurrent.index];
+                for(row_t rowOfOther: group){
+                    if(!callback(childOfCurrent, rowOfOther)) return false;
+                }
+                incrementLinkedList(itrCurrent);
+            }
         }
     }
+    return true;
 }
 
 template <typename key_t>
@@ -723,23 +1060,210 @@ BPTNode<key_t>* BPTree<key_t>::leftMostLeaf(Node* node){
 }
 
 template <typename key_t>
-void BPTree<key_t>::naturalJoinOneIndex(Node* rootOfOtherBTree, const std::function<void(row_t rowOfCurrent, row_t rowOfOther)>& funcToPrint){
+BPTNode<key_t>* BPTree<key_t>::rightMostLeaf(Node* node){
+    while(!node->isLeaf){
+        node = node->getChildNode(manager, node->size);
+    }
+    return node;
+}
+
+template <typename key_t>
+template <typename run_t>
+bool BPTree<key_t>::naturalJoinOneIndex(run_t& other, const std::function<bool(row_t rowOfCurrent, row_t rowOfOther)>& callback){
+    Node* root = manager.root.get();
+    if(root == nullptr || root->size == 0) return true;
+
+    key_t keyOfOther;
+    row_t rowOfOther;
+    bool hasOther = other.next(keyOfOther, rowOfOther);
+
+    // Rows of other side matching current key. Reused while this tree repeats the key
+    std::vector<row_t> group;
+    key_t groupKey;
+    bool hasGroup = false;
+
+    result_t itrCurrent;
+    itrCurrent.node = leftMostLeaf(root);
+    itrCurrent.index = 0;
+    while(itrCurrent.node && (hasOther || hasGroup)){
+        key_t keyOfCurrent = itrCurrent.node->keys[itrCurrent.index];
+        if(!hasGroup || !(groupKey == keyOfCurrent)){
+            group.clear();
+            while(hasOther && keyOfOther < keyOfCurrent) hasOther = other.next(keyOfOther, rowOfOther);
+            while(hasOther && keyOfOther == keyOfCurrent){
+                group.push_back(rowOfOther);
+                hasOther = other.next(keyOfOther, rowOfOther);
+            }
+            hasGroup = !group.empty();
+            groupKey = keyOfCurrent;
+        }
 
+        row_t childOfCurrent = itrCurrent.node->child[itrCurrent.index];
+        for(row_t row: group){
+            if(!callback(childOfCurrent, row)) return false;
+        }
+        incrementLinkedList(itrCurrent);
+    }
+    return true;
 }
 
+template <typename key_t>
+bool BPTree<key_t>::probeSorted(const std::vector<std::pair<key_t, row_t>>& probes, const std::function<bool(row_t rowOfCurrent, row_t rowOfOther)>& callback){
+    Node* root = manager.root.get();
+    if(root == nullptr || root->size == 0) return true;
+
+    // Rows of this tree matching previous probe key. Reused when probe keys repeat
+    std::vector<row_t> group;
+    result_t position;
+    position.node = nullptr;
+    for(int32_t i = 0; i < probes.size(); ++i){
+        const key_t& key = probes[i].first;
+        if(i == 0 || !(probes[i - 1].first == key)){
+            group.clear();
+            // Entries before position are <= previous key so first entry >= key is at or after it
+            if(position.node != nullptr && !(position.node->keys[position.node->size - 1] < key)){
+                position.index = binarySearch(position.node, key, -1);
+            }
+            else{
+                // pkey -1 lands on first entry with key >= key
+                position = searchUtil(key, -1);
+                if(position.index == position.node->size){
+                    position.index--;
+                    incrementLinkedList(position);
+                }
+            }
+            while(position.node != nullptr && position.node->keys[position.index] == key){
+                group.push_back(position.node->child[position.index]);
+                incrementLinkedList(position);
+            }
+        }
 
+        for(row_t row: group){
+            if(!callback(row, probes[i].second)) return false;
+        }
+    }
+    return true;
+}
 
 // ----------------------- TRAVERSAL ----------------------
 template <typename key_t>
 bool BPTree<key_t>::traverse(const std::function<bool(row_t row)>& callback){
-    bfsTraverseDebug();
-    return true;
     Node* root = manager.root.get();
     if(root->size == 0) return true;
     while(!root->isLeaf) root = root->getChildNode(manager, 0);
     return iterateRightLeaf(root,0, callback);
 }
 
+template <typename key_t>
+bool BPTree<key_t>::traverseRange(const key_t* low, const key_t* high, bool descending, const std::function<bool(row_t row)>& callback){
+    Node* root = manager.root.get();
+    if(root == nullptr || root->size == 0) return true;
+
+    result_t position;
+    if(descending){
+        if(high == nullptr){
+            position.node = rightMostLeaf(root);
+            position.index = position.node->size - 1;
+        }
+        else{
+            // Largest pkey lands on first entry with key > high. Entry before it is last one <= high
+            position = searchUtil(*high, std::numeric_limits<pkey_t>::max());
+            if(position.index == position.node->size) position.index--;
+            else decrementLinkedList(position);
+        }
+
+        // Leaves are walked back through leftSibling_
+        while(position.node != nullptr){
+            if(low != nullptr && position.node->keys[position.index] < *low) break;
+            if(!callback(position.node->child[position.index])) return false;
+            decrementLinkedList(position);
+        }
+        return true;
+    }
+
+    if(low == nullptr){
+        position.node = leftMostLeaf(root);
+        position.index = 0;
+    }
+    else{
+        // pkey -1 lands on first entry with key >= low
+        position = searchUtil(*low, -1);
+        if(position.index == position.node->size){
+            position.index--;
+            incrementLinkedList(position);
+        }
+    }
+
+    while(position.node != nullptr){
+        if(high != nullptr && *high < position.node->keys[position.index]) break;
+        if(!callback(position.node->child[position.index])) return false;
+        incrementLinkedList(position);
+    }
+    return true;
+}
+
+template <typename key_t>
+bool BPTree<key_t>::traverseCellRange(const char* lowCell, const char* highCell, bool descending, const std::function<bool(row_t row)>& callback){
+    key_t low, high;
+    if(lowCell != nullptr) memcpy(&low, lowCell, sizeof(key_t));
+    if(highCell != nullptr) memcpy(&high, highCell, sizeof(key_t));
+    return traverseRange(lowCell ? &low : nullptr, highCell ? &high : nullptr, descending, callback);
+}
+
+template <>
+bool inline BPTree<dbms::string>::traverseCellRange(const char* lowCell, const char* highCell, bool descending, const std::function<bool(row_t row)>& callback){
+    std::vector<char> lowBuffer(keySize + 1, '\0');
+    std::vector<char> highBuffer(keySize + 1, '\0');
+    dbms::string low, high;
+    if(lowCell != nullptr){
+        memcpy(lowBuffer.data(), lowCell, strnlen(lowCell, keySize));
+        low.setBuffer(lowBuffer.data(), keySize);
+    }
+    if(highCell != nullptr){
+        memcpy(highBuffer.data(), highCell, strnlen(highCell, keySize));
+        high.setBuffer(highBuffer.data(), keySize);
+    }
+    return traverseRange(lowCell ? &low : nullptr, highCell ? &high : nullptr, descending, callback);
+}
+
+template <typename key_t>
+bool BPTree<key_t>::firstRow(row_t& row){
+    Node* root = manager.root.get();
+    if(root == nullptr || root->size == 0) return false;
+    Node* leaf = leftMostLeaf(root);
+    row = leaf->child[0];
+    return true;
+}
+
+template <typename key_t>
+bool BPTree<key_t>::lastRow(row_t& row){
+    Node* root = manager.root.get();
+    if(root == nullptr || root->size == 0) return false;
+    Node* leaf = rightMostLeaf(root);
+    row = leaf->child[leaf->size - 1];
+    return true;
+}
+
+template <typename key_t>
+int32_t BPTree<key_t>::height(){
+    Node* node = manager.root.get();
+    if(node == nullptr) return 0;
+
+    // Root of an empty tree is not marked as leaf and has no children
+    if(node->size == 0) return 1;
+    int32_t levels = 1;
+    while(!node->isLeaf){
+        node = node->getChildNode(manager, 0);
+        ++levels;
+    }
+    return levels;
+}
+
+template <typename key_t>
+int32_t BPTree<key_t>::fanout() const{
+    return branchingFactor;
+}
+
 template <typename key_t>
 bool BPTree<key_t>::BFStraverse(const std::function<bool(row_t row)>& callback){
     return traverseUtil(manager.root.get(), callback);
@@ -794,7 +1318,7 @@ void BPTree<key_t>::incrementLinkedList(result_t& currentPosition){
     }
     else {
         if(currentPosition.node->rightSibling_){
-            currentPosition.node = currentPosition.node->rightSibling_;
+            currentPosition.node = currentPosition.node->getRightSibling(manager);
             currentPosition.index = 0;
         }
         else {
@@ -811,7 +1335,7 @@ void BPTree<key_t>::decrementLinkedList(result_t& currentPosition){
     }
     else {
         if(currentPosition.node->leftSibling_){
-            currentPosition.node = currentPosition.node->leftSibling_;
+            currentPosition.node = currentPosition.node->getLeftSibling(manager);
             currentPosition.index = currentPosition.node->size-1;
         }
         else {
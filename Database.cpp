@@ -0,0 +1,289 @@
+#include "HeaderFiles/Database.h"
+#include "Executor.cpp"
+#include <filesystem>
+
+namespace dbms{
+
+// =============================================
+//                  RESULT SET
+// =============================================
+
+ResultSet ResultSet::failure(const char* message){
+    ResultSet res;
+    res.success = false;
+    res.error = message;
+    return res;
+}
+
+bool ResultSet::ok() const{
+    return success;
+}
+
+const std::string& ResultSet::message() const{
+    return error;
+}
+
+int32_t ResultSet::columnCount() const{
+    return names.size();
+}
+
+const std::string& ResultSet::columnName(int32_t column) const{
+    return names.at(column);
+}
+
+/// Bytes taken by value of cell whose tag is at offset
+static size_t cellSize(const std::string& data, size_t offset){
+    switch(static_cast<CellTag>(data[offset])){
+        case CellTag::null:
+            return 0;
+        case CellTag::character:
+        case CellTag::boolean:
+            return 1;
+        case CellTag::int32:
+        case CellTag::float32:
+            return 4;
+        case CellTag::int64:
+        case CellTag::float64:
+            return 8;
+        case CellTag::string: {
+            uint32_t length;
+            memcpy(&length, data.data() + offset + 1, sizeof(uint32_t));
+            return sizeof(uint32_t) + length;
+        }
+    }
+    return 0;
+}
+
+bool ResultSet::next(){
+    cells.clear();
+    if(nextRow + sizeof(uint32_t) > data.size()) return false;
+    uint32_t length;
+    memcpy(&length, data.data() + nextRow, sizeof(uint32_t));
+    size_t offset = nextRow + sizeof(uint32_t);
+    size_t end = offset + length;
+    while(offset < end){
+        cells.push_back(offset);
+        offset += 1 + cellSize(data, offset);
+    }
+    nextRow = end;
+    return true;
+}
+
+ValueType ResultSet::type(int32_t column) const{
+    if(column < 0 || column >= cells.size()) return ValueType::null;
+    switch(static_cast<CellTag>(data[cells[column]])){
+        case CellTag::null:
+            return ValueType::null;
+        case CellTag::int32:
+        case CellTag::int64:
+            return ValueType::integer;
+        case CellTag::float32:
+        case CellTag::float64:
+            return ValueType::real;
+        case CellTag::boolean:
+            return ValueType::boolean;
+        case CellTag::character:
+            return ValueType::character;
+        case CellTag::string:
+            return ValueType::string;
+    }
+    return ValueType::null;
+}
+
+bool ResultSet::isNull(int32_t column) const{
+    return type(column) == ValueType::null;
+}
+
+/// Copies value of cell at offset into a T
+template <typename T>
+static T readCell(const std::string& data, size_t offset){
+    T value;
+    memcpy(&value, data.data() + offset + 1, sizeof(T));
+    return value;
+}
+
+int64_t ResultSet::getInt(int32_t column) const{
+    if(column < 0 || column >= cells.size()) return 0;
+    size_t offset = cells[column];
+    switch(static_cast<CellTag>(data[offset])){
+        case CellTag::int32:
+            return readCell<int32_t>(data, offset);
+        case CellTag::int64:
+            return readCell<int64_t>(data, offset);
+        case CellTag::float32:
+            return static_cast<int64_t>(readCell<float>(data, offset));
+        case CellTag::float64:
+            return static_cast<int64_t>(readCell<double>(data, offset));
+        case CellTag::boolean:
+        case CellTag::character:
+            return readCell<char>(data, offset);
+        default:
+            return 0;
+    }
+}
+
+double ResultSet::getDouble(int32_t column) const{
+    if(column < 0 || column >= cells.size()) return 0;
+    size_t offset = cells[column];
+    switch(static_cast<CellTag>(data[offset])){
+        case CellTag::float32:
+            return readCell<float>(data, offset);
+        case CellTag::float64:
+            return readCell<double>(data, offset);
+        default:
+            return static_cast<double>(getInt(column));
+    }
+}
+
+bool ResultSet::getBool(int32_t column) const{
+    return getDouble(column) != 0;
+}
+
+std::string_view ResultSet::getString(int32_t column) const{
+    if(column < 0 || column >= cells.size()) return {};
+    size_t offset = cells[column];
+    switch(static_cast<CellTag>(data[offset])){
+        case CellTag::character:
+            return std::string_view(data.data() + offset + 1, 1);
+        case CellTag::string:
+            return std::string_view(data.data() + offset + 1 + sizeof(uint32_t), readCell<uint32_t>(data, offset));
+        default:
+            return {};
+    }
+}
+
+// =============================================
+//                  STATEMENT
+// =============================================
+
+Statement::Statement() = default;
+Statement::Statement(Statement&&) noexcept = default;
+Statement& Statement::operator=(Statement&&) noexcept = default;
+Statement::~Statement() = default;
+
+bool Statement::ok() const{
+    return prepared != nullptr;
+}
+
+const std::string& Statement::message() const{
+    return error;
+}
+
+int32_t Statement::parameterCount() const{
+    return prepared ? prepared->parameters.size() : 0;
+}
+
+bool Statement::bind(int32_t index, std::string_view value){
+    if(index < 0 || index >= parameterCount()) return false;
+    prepared->parameters[index]->assign(value);
+    return true;
+}
+
+bool Statement::bind(int32_t index, const char* value){
+    return bind(index, std::string_view(value));
+}
+
+bool Statement::bind(int32_t index, int64_t value){
+    return bind(index, std::string_view(std::to_string(value)));
+}
+
+bool Statement::bind(int32_t index, int32_t value){
+    return bind(index, static_cast<int64_t>(value));
+}
+
+bool Statement::bind(int32_t index, double value){
+    char text[32];
+    int len = snprintf(text, sizeof(text), "%.17g", value);
+    return bind(index, std::string_view(text, len));
+}
+
+bool Statement::bind(int32_t index, bool value){
+    return bind(index, std::string_view(value ? "true" : "false"));
+}
+
+ResultSet Statement::execute(){
+    if(!prepared) return ResultSet::failure(error.c_str());
+    return Connection::run(*executor, prepared->type, prepared->statement);
+}
+
+// =============================================
+//                  CONNECTION
+// =============================================
+
+Connection::Connection(std::shared_ptr<TableManager> manager){
+    executor = std::make_unique<Executor>(std::move(manager));
+    executor->quiet = true;
+    executor->captureDetail = true;
+    executor->sink.setFormat(OutputFormat::binary);
+}
+
+Connection::Connection(Connection&&) noexcept = default;
+Connection& Connection::operator=(Connection&&) noexcept = default;
+Connection::~Connection() = default;
+
+ResultSet Connection::run(Executor& executor, StatementType type, std::unique_ptr<QueryStatement>& statement){
+    ResultSet res;
+    executor.sink.capture([&res](const char* data, size_t length){
+        res.data.append(data, length);
+        return true;
+    });
+    executor.detail.clear();
+    auto executeRes = executor.execute(type, statement);
+    executor.sink.flush();
+    res.names = executor.sink.columnNames();
+    executor.sink.capture(nullptr);
+    res.error = executor.resultMessage(executeRes);
+    if(executeRes != ExecuteResult::success){
+        res.success = false;
+        res.data.clear();
+    }
+    return res;
+}
+
+ResultSet Connection::execute(std::string_view text){
+    Parser parser;
+    auto prepareRes = parser.parse(text);
+    if(prepareRes != PrepareResult::success) return ResultSet::failure(prepareMessage(prepareRes));
+    return run(*executor, parser.type, parser.statement);
+}
+
+Statement Connection::prepare(std::string_view text){
+    Statement statement;
+    statement.executor = executor.get();
+    auto prepared = std::make_unique<PreparedStatement>();
+    auto res = Parser::prepare(std::string(text), *prepared);
+    if(res != PrepareResult::success){
+        statement.error = prepareMessage(res);
+        return statement;
+    }
+    statement.prepared = std::move(prepared);
+    return statement;
+}
+
+// =============================================
+//                  DATABASE
+// =============================================
+
+Database::Database(std::shared_ptr<TableManager> manager_){
+    this->manager = std::move(manager_);
+}
+
+Database::~Database(){
+    manager->closeAll();
+}
+
+std::shared_ptr<Database> Database::open(const std::string& directory){
+    auto manager = std::make_shared<TableManager>(directory);
+    if(!manager->isOpen()) return nullptr;
+    return std::shared_ptr<Database>(new Database(std::move(manager)));
+}
+
+Connection Database::connect(){
+    return Connection(manager);
+}
+
+void Database::flush(){
+    manager->flushAll();
+}
+
+}
@@ -1,4 +1,10 @@
 #include "Parser.cpp"
+#include "HeaderFiles/Join.h"
+#include "HeaderFiles/Aggregate.h"
+#include "HeaderFiles/OrderBy.h"
+#include "HeaderFiles/Loader.h"
+#include "HeaderFiles/ResultSink.h"
+#include <cstdarg>
 
 enum class ExecuteResult{
     success,
@@ -8,101 +14,177 @@ enum class ExecuteResult{
     stringTooLarge,
     invalidColumnName,
     tableNotIndexed,
+    ungroupedColumn,
     unexpectedError
 };
 
-struct ErrorHandler{
-    static void handleTableManagerError(const TableManagerResult& res){
-        switch(res){
-            case TableManagerResult::tableCreatedSuccessfully:
-                printw("Table Created Successfully\n");
-                break;
-            case TableManagerResult::tableAlreadyExists:
-                printw("This Table already exists\n");
-                break;
-            case TableManagerResult::tableCreationFaliure:
-                printw("Failed To Create Table\n");
-                break;
-            case TableManagerResult::tableNotFound:
-                printw("Table Not Found\n");
-                break;
-            case TableManagerResult::openingFaliure:
-                printw("Failed To Open Table\n");
-                break;
-            case TableManagerResult::closedSuccessfully:
-                printw("Closed Table Successfully\n");
-                break;
-            case TableManagerResult::closingFaliure:
-                printw("Closed Table Successfully\n");
-                break;
-            case TableManagerResult::droppingFaliure:
-                printw("Error Dropping Table\n");
-                break;
-            case TableManagerResult::openedSuccessfully:
-                break;
-            case TableManagerResult::droppedSuccessfully:
-                break;
-            default:
-                printw("Unknown Error Occurred\n");
-                break;
-        }
-    }
-
-    static void handleTableMismatchError(int32_t actualSize, int32_t expectedSize){
-        printw("Number of values provided does not match number of columns\n"
-               "Expected %d value(s). Got %d value(s)\n", expectedSize, actualSize);
+/// Message printed for result of a statement
+const char* executeMessage(ExecuteResult result){
+    switch(result){
+        case ExecuteResult::success:
+            return "Executed.";
+        case ExecuteResult::tableFull:
+            return "Error: Table full.";
+        case ExecuteResult::faliure:
+            return "Action Failed";
+        case ExecuteResult::typeMismatch:
+            return "Type Mismatch Occured";
+        case ExecuteResult::stringTooLarge:
+            return "String Too Large";
+        case ExecuteResult::invalidColumnName:
+            return "Column names don't match table column names";
+        case ExecuteResult::tableNotIndexed:
+            return "There are no indexes for this table.\n"
+                   "Create atleast one and then try again.";
+        case ExecuteResult::ungroupedColumn:
+            return "Selected columns must be aggregated or used in group by";
+        case ExecuteResult::unexpectedError:
+            return "Unexpected Error occured";
     }
-
-    static void indexCreationError(const std::string& colName){
-        printw("Failed to create index on %s\n", colName.c_str());
-    }
-
-    static void indexCreationSuccessful(const std::string& colName){
-        printw("Successfully created index on %s\n", colName.c_str());
+    return "";
+}
+
+/// Message printed for result of TableManager. Empty when there is nothing to tell
+const char* tableManagerMessage(TableManagerResult res){
+    switch(res){
+        case TableManagerResult::tableCreatedSuccessfully:
+            return "Table Created Successfully";
+        case TableManagerResult::tableAlreadyExists:
+            return "This Table already exists";
+        case TableManagerResult::tableCreationFaliure:
+            return "Failed To Create Table";
+        case TableManagerResult::tableNotFound:
+            return "Table Not Found";
+        case TableManagerResult::openingFaliure:
+            return "Failed To Open Table";
+        case TableManagerResult::closedSuccessfully:
+            return "Closed Table Successfully";
+        case TableManagerResult::closingFaliure:
+            return "Closed Table Successfully";
+        case TableManagerResult::droppingFaliure:
+            return "Error Dropping Table";
+        case TableManagerResult::openedSuccessfully:
+        case TableManagerResult::droppedSuccessfully:
+            return "";
     }
-};
+    return "Unknown Error Occurred";
+}
 
 class Executor{
 public:
-    std::unique_ptr<TableManager> sharedManager;
+    std::shared_ptr<TableManager> sharedManager;
+    ResultSink sink;                    // Rows of select, join, delete, explain and analyze
+    StatementCache statements;
+    bool quiet{};                       // Leave out messages of statements that succeed
+
+    /// Messages of statement when captureDetail is set. Caller empties it before each statement
+    /// Library connections and server sessions return it with result instead of printing it on stdout of host
+    std::string detail;
+    bool captureDetail{};
+
+    /// Executor of REPL, batch and server. Manager prints what it finds while opening database
     explicit Executor(const std::string& baseURL){
-        sharedManager = std::make_unique<TableManager>(baseURL);
+        sharedManager = std::make_shared<TableManager>(baseURL, true);
+        acutalSize = 0;
+        expectedSize = 0;
+    }
+
+    /// Executor of a library connection. Tables are shared with other connections of manager
+    explicit Executor(std::shared_ptr<TableManager> manager){
+        sharedManager = std::move(manager);
         acutalSize = 0;
         expectedSize = 0;
     }
 
     ExecuteResult execute(Parser& parser){
+        return execute(parser.type, parser.statement);
+    }
+
+    ExecuteResult execute(StatementType type, std::unique_ptr<QueryStatement>& statement){
         ExecuteResult res;
-        switch(parser.type){
+        switch(type){
             case StatementType::insert:
-                res = executeInsert(parser.statement);
+                res = executeInsert(statement);
                 break;
             case StatementType::select:
-                res = executeSelect(parser.statement);
+                res = executeSelect(statement);
                 break;
             case StatementType::remove:
-                res = executeRemove(parser.statement);
+                res = executeRemove(statement);
                 break;
             case StatementType::create:
-                res = executeCreate(parser.statement);
+                res = executeCreate(statement);
                 break;
             case StatementType::index:
-                res = executeIndex(parser.statement);
+                res = executeIndex(statement);
                 break;
             case StatementType::update:
-                res = executeUpdate(parser.statement);
+                res = executeUpdate(statement);
                 break;
             case StatementType::drop:
-                res = executeDrop(parser.statement);
+                res = executeDrop(statement);
+                break;
+            case StatementType::analyze:
+                res = executeAnalyze(statement);
+                break;
+            case StatementType::join:
+                res = executeJoin(statement);
+                break;
+            case StatementType::load:
+                res = executeLoad(statement);
+                break;
+            case StatementType::prepare:
+                res = executePrepare(statement);
+                break;
+            case StatementType::execute:
+                res = executeExecute(statement);
+                break;
+            case StatementType::deallocate:
+                res = executeDeallocate(statement);
                 break;
         }
+        // Latches are released by now, so statements on other tables commit while this one waits for disk
+        StatementCommit commit = statementCommit;
+        statementCommit = StatementCommit{};
+        if(commit.failed || !sharedManager->sync(commit.position) || !sharedManager->checkpointIfLarge()){
+            if(res == ExecuteResult::success) res = ExecuteResult::unexpectedError;
+        }
         return res;
     }
 
     int32_t acutalSize;
     int32_t expectedSize;
 
+    /// Message about running statement. Printed right away unless captureDetail is set
+    void note(const char* format, ...){
+        va_list args;
+        va_start(args, format);
+        if(!captureDetail) vprintf(format, args);
+        else{
+            va_list copy;
+            va_copy(copy, args);
+            int length = vsnprintf(nullptr, 0, format, copy);
+            va_end(copy);
+            if(length > 0){
+                size_t start = detail.size();
+                detail.resize(start + length + 1);
+                vsnprintf(&detail[start], length + 1, format, args);
+                detail.resize(start + length);
+            }
+        }
+        va_end(args);
+    }
+
+    /// Result of statement followed by messages it left in detail, as library and server report it
+    std::string resultMessage(ExecuteResult res) const{
+        std::string message = detail;
+        if(res != ExecuteResult::success) message += executeMessage(res);
+        while(!message.empty() && message.back() == '\n') message.pop_back();
+        return message;
+    }
+
 private:
+    StatementCommit statementCommit;    // Commits made by latches of running statement
 
     ExecuteResult executeCreate(std::unique_ptr<QueryStatement>& statement){
         auto createStatement = dynamic_cast<CreateStatement*>(statement.get());
@@ -111,10 +193,11 @@ private:
                                          std::move(createStatement->colTypes),
                                          std::move(createStatement->colSize));
 
-        ErrorHandler::handleTableManagerError(res);
         if(res == TableManagerResult::tableCreatedSuccessfully){
+            if(!quiet) reportTableManager(res);
             return ExecuteResult::success;
         }
+        reportTableManager(res);
         return ExecuteResult::faliure;
     }
 
@@ -124,6 +207,8 @@ private:
         if(res != TableManagerResult::openedSuccessfully) {
             return ExecuteResult::faliure;
         }
+        TableLatch tableLock(*sharedManager, table.get(), statementCommit);
+        if(!table->isOpen()) return ExecuteResult::faliure;
 
         auto insertStatement = dynamic_cast<IndexStatement*>(statement.get());
         for(auto& colName: insertStatement->colNames){
@@ -132,15 +217,31 @@ private:
                 return ExecuteResult::invalidColumnName;
             }
             int32_t index = itr->second;
+            if(table->columnTypes[index] == DataType::String){
+                note("Indexes on string columns are not supported: %s\n", colName.c_str());
+                return ExecuteResult::faliure;
+            }
             if(!table->indexed[index]){
                 table->indexed[index] = true;
                 if(!sharedManager->createIndex(table, index)){
-                    ErrorHandler::indexCreationError(colName);
+                    table->indexed[index] = false;
+                    note("Failed to create index on %s\n", colName.c_str());
                     return ExecuteResult::faliure;
                 }
-                else{
-                    ErrorHandler::indexCreationSuccessful(colName);
+                // Rows inserted before index existed are added from heap
+                HeapScanner heap(table.get());
+                bool fillRes = heap.scan({}, [&](row_t row)->bool{
+                    Cursor cursor(table.get());
+                    cursor.row = row;
+                    const char* buffer = cursor.value();
+                    if(buffer == nullptr) return false;
+                    return table->trees[index]->insertCell(table->codec.cell(buffer, index), table->codec.getPKey(buffer), row);
+                });
+                if(!fillRes){
+                    note("Failed to create index on %s\n", colName.c_str());
+                    return ExecuteResult::faliure;
                 }
+                if(!quiet) note("Successfully created index on %s\n", colName.c_str());
             }
         }
         return ExecuteResult::success;
@@ -153,28 +254,110 @@ private:
         if(res != TableManagerResult::openedSuccessfully) {
             return ExecuteResult::faliure;
         }
-        if(!table->tableIsIndexed) return ExecuteResult::tableNotIndexed;
+        TableLatch tableLock(*sharedManager, table.get(), statementCommit);
+        if(!table->isOpen()) return ExecuteResult::faliure;
         auto insertStatement = dynamic_cast<InsertStatement*>(statement.get());
         int32_t columnCount = table->columnNames.size();
-        int32_t actualSize = insertStatement->data.size();
-        if(columnCount != actualSize){
-            ErrorHandler::handleTableMismatchError(actualSize, columnCount);
+        int32_t rowSize = table->getRowSize();
+
+        // Encode every row before taking any slot so that bad input leaves table untouched
+        std::vector<char> rows(insertStatement->rows.size() * rowSize, '\0');
+        for(size_t r = 0; r < insertStatement->rows.size(); ++r){
+            auto& data = insertStatement->rows[r];
+            int32_t actualSize = data.size();
+            if(columnCount != actualSize){
+                reportColumnMismatch(actualSize, columnCount);
+                return ExecuteResult::faliure;
+            }
+            auto encodeRes = table->codec.encode(data, rows.data() + r * rowSize);
+            if(encodeRes != CodecResult::success) return codecError(encodeRes);
+        }
+
+        BulkLoader loader(table.get());
+        bool appendRes = true;
+        for(size_t r = 0; r < insertStatement->rows.size() && appendRes; ++r){
+            appendRes = loader.append(rows.data() + r * rowSize);
+        }
+        if(!loader.finish() || !appendRes) return ExecuteResult::faliure;
+        if(loader.rowCount() > 1 && !quiet) note("Inserted %d row(s).\n", loader.rowCount());
+        return ExecuteResult::success;
+    }
+
+    ExecuteResult executeLoad(std::unique_ptr<QueryStatement>& statement){
+        std::shared_ptr<Table> table;
+        auto res = sharedManager->open(statement->tableName, table);
+        if(res != TableManagerResult::openedSuccessfully) {
+            reportTableManager(res);
             return ExecuteResult::faliure;
         }
+        TableLatch tableLock(*sharedManager, table.get(), statementCommit);
+        if(!table->isOpen()) return ExecuteResult::faliure;
+        auto loadStatement = dynamic_cast<LoadStatement*>(statement.get());
+
+        // Rows before a bad record stay loaded
+        ParallelLoader loader(table.get());
+        auto loadRes = loader.run(loadStatement->fileName, loadStatement->format, loadStatement->header);
+        ExecuteResult executeRes = ExecuteResult::faliure;
+        switch(loadRes){
+            case LoadResult::success:
+                executeRes = ExecuteResult::success;
+                break;
+            case LoadResult::cannotOpen:
+                note("Unable to open file '%s'\n", loadStatement->fileName.c_str());
+                return ExecuteResult::faliure;
+            case LoadResult::readError:
+            case LoadResult::writeError:
+                executeRes = ExecuteResult::unexpectedError;
+                break;
+            case LoadResult::malformed:
+                note("Malformed record\n");
+                break;
+            case LoadResult::columnCountMismatch:
+                reportColumnMismatch(loader.fieldCount, table->columnNames.size());
+                break;
+            case LoadResult::invalidValue:
+                executeRes = codecError(loader.codecResult);
+                break;
+        }
+        if(loadRes != LoadResult::success && loader.errorLine > 0){
+            const char* unit = (loadStatement->format == LoadFormat::csv) ? "line" : "record";
+            note("Stopped at %s %lld\n", unit, static_cast<long long>(loader.errorLine));
+        }
+        if(executeRes != ExecuteResult::success || !quiet) note("Loaded %d row(s).\n", loader.rowCount());
+        return executeRes;
+    }
+
+    ExecuteResult executePrepare(std::unique_ptr<QueryStatement>& statement){
+        auto prepareStatement = dynamic_cast<PrepareStatement*>(statement.get());
+        int32_t count = prepareStatement->prepared.parameters.size();
+        statements.put(prepareStatement->name, prepareStatement->text, std::move(prepareStatement->prepared));
+        if(!quiet) note("Prepared %s with %d parameter(s).\n", prepareStatement->name.c_str(), count);
+        return ExecuteResult::success;
+    }
 
-        // Serialise Data;
-        Cursor cursor(table.get());
-        cursor.row = table->nextFreeRowLocation();
-        char* buffer = cursor.value();
-        if(buffer == nullptr) return ExecuteResult::unexpectedError;
-        auto serializeRes = serializeRow(buffer, table.get(), insertStatement->data, table->nextPKey);
-        if(serializeRes != ExecuteResult::success) return serializeRes;
-        table->increaseRowCount();
-        cursor.addedChangesToCommit();
+    /// Binds values to parameters of cached parse and runs it. Table and filter are resolved again
+    /// on every run since plan depends on bound values
+    ExecuteResult executeExecute(std::unique_ptr<QueryStatement>& statement){
+        auto executeStatement = dynamic_cast<ExecuteStatement*>(statement.get());
+        PreparedStatement* prepared = statements.get(executeStatement->name);
+        if(prepared == nullptr){
+            note("No prepared statement named '%s'\n", executeStatement->name.c_str());
+            return ExecuteResult::faliure;
+        }
+        auto& values = executeStatement->values;
+        if(values.size() != prepared->parameters.size()){
+            note("Expected %zu parameter(s). Got %zu\n", prepared->parameters.size(), values.size());
+            return ExecuteResult::faliure;
+        }
+        for(size_t i = 0; i < values.size(); ++i) *prepared->parameters[i] = values[i];
+        return execute(prepared->type, prepared->statement);
+    }
 
-        if(!table->insertBTree(insertStatement->data, cursor.row)){
+    ExecuteResult executeDeallocate(std::unique_ptr<QueryStatement>& statement){
+        auto deallocateStatement = dynamic_cast<DeallocateStatement*>(statement.get());
+        if(!statements.remove(deallocateStatement->name)){
+            note("No prepared statement named '%s'\n", deallocateStatement->name.c_str());
             return ExecuteResult::faliure;
-            // Remove cursor.row from table
         }
         return ExecuteResult::success;
     }
@@ -183,68 +366,210 @@ private:
         std::shared_ptr<Table> table;
         auto res = sharedManager->open(statement->tableName, table);
         if(res != TableManagerResult::openedSuccessfully) {
-            ErrorHandler::handleTableManagerError(res);
+            reportTableManager(res);
             return ExecuteResult::faliure;
         }
+        TableLatch tableLock(*sharedManager, table.get(), statementCommit);
+        if(!table->isOpen()) return ExecuteResult::faliure;
         auto selectStatement = dynamic_cast<SelectStatement*>(statement.get());
+        if(selectStatement->isAggregate) return executeAggregate(table.get(), selectStatement);
 
-        std::vector<int32_t> indices;
-        if(!selectStatement->selectAllCols){
+        // Columns to print. These are always first columns in batch
+        std::vector<int32_t> columns;
+        if(selectStatement->selectAllCols){
+            for(int32_t i = 0; i < table->columnNames.size(); ++i) columns.push_back(i);
+        }
+        else{
             for(auto& str: selectStatement->colNames){
-                int32_t index = table->columnIndex[str];
-                indices.emplace_back(index);
+                auto itr = table->columnIndex.find(str);
+                if(itr == table->columnIndex.end()) return ExecuteResult::invalidColumnName;
+                columns.push_back(itr->second);
+            }
+        }
+        std::vector<int32_t> positions(columns.size());
+        for(int32_t i = 0; i < positions.size(); ++i) positions[i] = i;
+
+        int32_t orderColumn = -1, orderPosition = -1;
+        if(!selectStatement->orderBy.empty()){
+            auto itr = table->columnIndex.find(selectStatement->orderBy);
+            if(itr == table->columnIndex.end()) return ExecuteResult::invalidColumnName;
+            orderColumn = itr->second;
+            orderPosition = addColumn(columns, orderColumn);
+        }
+
+        Filter filter;
+        if(!selectStatement->selectAllRows){
+            auto compileRes = compileCondition(table.get(), selectStatement->condition, filter);
+            if(compileRes != ExecuteResult::success) return compileRes;
+        }
+        filter.bind(columns);
+
+        int64_t limit = selectStatement->limit;
+        auto plans = Planner::enumerate(table.get(), filter);
+        const Plan& plan = plans.front();
+        OrderPlan order;
+        if(orderColumn != -1) order = OrderBy::choose(table.get(), orderColumn, limit, plans);
+        if(selectStatement->explain){
+            std::vector<std::string> lines;
+            if(limit != -1) lines.push_back("Limit " + std::to_string(limit));
+            if(orderColumn != -1){
+                lines.push_back(order.describe(table.get(), orderColumn, selectStatement->descending, limit));
+                if(order.strategy != OrderStrategy::sort) explain(table.get(), {order.scan}, selectStatement, lines);
+                else explain(table.get(), {plan}, selectStatement, lines);
             }
+            else{
+                explain(table.get(), plans, selectStatement, lines);
+            }
+            return writePlan(lines);
         }
 
-        int32_t size = selectStatement->selectAllCols ? table->columnNames.size(): indices.size();
+        // Only rows from a heap scan or a top-N heap have passed filter already
+        bool applyFilter = (orderColumn == -1) ? (plan.path != AccessPath::heapScan)
+                                               : (order.strategy != OrderStrategy::topN);
+
+        std::vector<std::string> names;
+        for(int32_t p: positions) names.push_back(table->columnNames[columns[p]]);
+        sink.begin(names);
+
+        // Batch is cut at limit and scan is stopped right after it
         row_t count = 0;
-        auto callback = [&](row_t row)->bool{
-            Cursor cursor(table.get());
-            cursor.row = row;
-            char* buffer = cursor.value();
-            std::vector<std::string> data(size);
-            bool deserializeRes = deserializeRow(buffer, table, indices, data, selectStatement->selectAllCols);
-            if(!deserializeRes) return false;
-            for(auto& str: data){
-                std::cout << str << " | ";
+        bool limitReached = (limit == 0);
+        BatchScanner scanner(table.get(), columns, [&](RowBatch& batch)->bool{
+            if(applyFilter) filter.apply(batch);
+            if(limit != -1 && count + batch.selected >= limit){
+                batch.selected = limit - count;
+                limitReached = true;
+            }
+            sink.write(batch, positions);
+            count += batch.selected;
+            return !limitReached;
+        });
+
+        // Partial batch is handed over as soon as it may hold last row needed
+        int64_t pending = 0;
+        auto push = [&](row_t row)->bool{
+            if(!scanner.push(row)) return false;
+            if(limit != -1 && ++pending >= limit - count){
+                pending = 0;
+                return scanner.flush();
             }
-            std::cout << std::endl;
-            ++count;
             return true;
         };
 
-        if(selectStatement->selectAllRows){
-            bool traverseRes = table->trees[table->anyIndex]->traverse(callback);
-            if(!traverseRes) return ExecuteResult::unexpectedError;
-            printf("Found %d row(s).\n", count);
-            return ExecuteResult::success;
+        bool scanRes = limitReached;
+        if(!limitReached){
+            if(orderColumn == -1) scanRes = Planner::execute(table.get(), plan, filter, push);
+            else scanRes = OrderBy::execute(table.get(), orderColumn, selectStatement->descending, limit, order,
+                                            columns, orderPosition, filter, push);
+        }
+        bool scanned = limitReached || (scanRes && scanner.flush());
+        if(!sink.flush() || !scanned) return ExecuteResult::unexpectedError;
+        if(!quiet) note("Found %d row(s).\n", count);
+        return ExecuteResult::success;
+    }
+
+    ExecuteResult executeAggregate(Table* table, SelectStatement* selectStatement){
+        // Every plain column must be group column
+        if(selectStatement->selectAllCols) return ExecuteResult::ungroupedColumn;
+        std::vector<int32_t> columns;
+        int32_t groupColumn = -1, groupPosition = -1;
+        if(!selectStatement->groupBy.empty()){
+            auto itr = table->columnIndex.find(selectStatement->groupBy);
+            if(itr == table->columnIndex.end()) return ExecuteResult::invalidColumnName;
+            groupColumn = itr->second;
+            groupPosition = addColumn(columns, groupColumn);
+        }
+
+        std::vector<AggregateSpec> specs(selectStatement->colNames.size());
+        bool onlyMinMax = true;
+        for(int32_t i = 0; i < specs.size(); ++i){
+            auto& spec = specs[i];
+            spec.function = selectStatement->functions[i];
+            onlyMinMax &= (spec.function == AggregateFunction::min || spec.function == AggregateFunction::max);
+            if(selectStatement->colNames[i] == "*") continue;
+
+            auto itr = table->columnIndex.find(selectStatement->colNames[i]);
+            if(itr == table->columnIndex.end()) return ExecuteResult::invalidColumnName;
+            spec.column = itr->second;
+            if(spec.function == AggregateFunction::none && spec.column != groupColumn) return ExecuteResult::ungroupedColumn;
+            if(spec.function == AggregateFunction::sum || spec.function == AggregateFunction::avg){
+                DataType type = table->columnTypes[spec.column];
+                if(type != DataType::Int && type != DataType::Float) return ExecuteResult::typeMismatch;
+            }
+            spec.position = addColumn(columns, spec.column);
         }
 
-        auto condition = std::move(selectStatement->condition);
-        int32_t index = table->columnIndex[condition.col];
-
-//        if(condition.isCompound){
-//
-//        }
-//        else{
-//            switch(condition.compType1){
-//                case ComparisonType::equal:
-////                    table->bPlusTrees[index]
-//                    break;
-//                case ComparisonType::notEqual:
-//                    break;
-//                case ComparisonType::lessThan:
-//                    break;
-//                case ComparisonType::greaterThan:
-//                    break;
-//                case ComparisonType::lessThanOrEqual:
-//                    break;
-//                case ComparisonType::greaterThanOrEqual:
-//                    break;
-//                default: break;
-//            }
-//        }
+        Filter filter;
+        if(!selectStatement->selectAllRows){
+            auto compileRes = compileCondition(table, selectStatement->condition, filter);
+            if(compileRes != ExecuteResult::success) return compileRes;
+        }
+        filter.bind(columns);
+
+        // MIN and MAX of indexed columns are first and last entries of their trees
+        bool fromIndex = onlyMinMax && groupColumn == -1 && filter.empty();
+        for(auto& spec: specs){
+            fromIndex = fromIndex && table->indexed[spec.column] && table->columnTypes[spec.column] != DataType::String;
+        }
 
+        // Leaf scan of group column delivers groups one after other. Otherwise groups are hashed
+        auto plans = Planner::enumerate(table, filter);
+        Plan plan = plans.front();
+        bool streaming = false;
+        if(groupColumn != -1 && table->indexed[groupColumn] && table->columnTypes[groupColumn] != DataType::String){
+            double hashCost = plan.cost + table->getRowCount() * CPU_ROW_COST;
+            for(auto& candidate: plans){
+                if(candidate.path == AccessPath::indexScan && candidate.index == groupColumn && candidate.cost <= hashCost){
+                    plan = candidate;
+                    streaming = true;
+                }
+            }
+        }
+
+        if(selectStatement->explain){
+            std::vector<std::string> lines;
+            if(fromIndex) lines.emplace_back("Index Endpoints");
+            else lines.emplace_back(streaming ? "Group Aggregate" : "Hash Aggregate");
+            if(groupColumn != -1) lines.push_back("  Group Key: " + table->columnNames[groupColumn]);
+            if(!fromIndex){
+                size_t scanLine = lines.size();
+                explain(table, {plan}, selectStatement, lines);
+                lines[scanLine].insert(0, "  -> ");
+            }
+            return writePlan(lines);
+        }
+
+        std::vector<std::string> names;
+        for(int32_t i = 0; i < specs.size(); ++i){
+            auto& column = selectStatement->colNames[i];
+            if(specs[i].function == AggregateFunction::none) names.push_back(column);
+            else names.push_back(std::string(aggregateName(specs[i].function)) + "(" + column + ")");
+        }
+        sink.begin(names);
+        Aggregator aggregator(std::move(specs), groupPosition, streaming, sink);
+        bool applyFilter = (plan.path != AccessPath::heapScan);
+        BatchScanner scanner(table, columns, [&](RowBatch& batch)->bool{
+            if(applyFilter) filter.apply(batch);
+            return aggregator.consume(batch);
+        });
+
+        bool scanRes = true;
+        if(fromIndex){
+            // Extreme row of every column. Each column still takes its min or max over all pushed rows
+            for(int32_t column: columns){
+                row_t row;
+                if(table->trees[column]->firstRow(row)) scanRes = scanRes && scanner.push(row);
+                if(table->trees[column]->lastRow(row)) scanRes = scanRes && scanner.push(row);
+            }
+        }
+        else{
+            scanRes = Planner::execute(table, plan, filter, [&](row_t row)->bool{
+                return scanner.push(row);
+            });
+        }
+        bool aggregateRes = scanRes && scanner.flush() && aggregator.finish();
+        if(!sink.flush() || !aggregateRes) return ExecuteResult::unexpectedError;
+        if(!quiet) note("Found %d row(s).\n", aggregator.groupCount);
         return ExecuteResult::success;
     }
 
@@ -254,152 +579,307 @@ private:
         if(res != TableManagerResult::openedSuccessfully) {
             return ExecuteResult::faliure;
         }
+        TableLatch tableLock(*sharedManager, table.get(), statementCommit);
+        if(!table->isOpen()) return ExecuteResult::faliure;
 
         auto updateStatement = dynamic_cast<UpdateStatement*>(statement.get());
         std::vector<int32_t> indices;
         for(auto& str: updateStatement->colNames){
-            int32_t index = table->columnIndex[str];
-            indices.emplace_back(index);
-        }
-        // TODO: Search Btree for given condition
-        //       Read Matched Records
-        if(!updateStatement->condition.isCompound){
-            // Single Column
-            int colIndex = table->columnIndex[updateStatement->condition.col];
-            switch(updateStatement->condition.compType1){
-                case ComparisonType::equal:
-                    //table->deleteBTree() //(updateStatement->condition.data1);
-                    //auto updateStatement = dynamic_cast<UpdateStatement*>(statement.get());
-                    break;
-                case ComparisonType::notEqual:
-                    break;
-                case ComparisonType::lessThan:
-                    break;
-                case ComparisonType::greaterThan:
-                    break;
-                case ComparisonType::lessThanOrEqual:
-                    break;
-                case ComparisonType::greaterThanOrEqual:
-                    break;
-                case ComparisonType::error:
-                    break;
-            }
+            auto itr = table->columnIndex.find(str);
+            if(itr == table->columnIndex.end()) return ExecuteResult::invalidColumnName;
+            indices.emplace_back(itr->second);
         }
 
+        // New values are parsed once and written in place on every matched row
+        std::vector<Value> values(indices.size());
+        for(int32_t i = 0; i < indices.size(); ++i){
+            auto parseRes = table->codec.parse(indices[i], updateStatement->colValues[i], values[i]);
+            if(parseRes != CodecResult::success) return codecError(parseRes);
+        }
 
-        // Call this lambda on every matched row
-        auto updateCallback = [&](Cursor& cursor)->bool{
-            char* buffer = cursor.value();
-            if(buffer == nullptr) return false;
-            auto tempBuffer = std::make_unique<char[]>(cursor.table->getRowSize() + 1);
-            strncpy(tempBuffer.get(), buffer, table->getRowSize());
-            auto serializeRes = serializeRow(tempBuffer.get(), cursor.table, updateStatement->colValues, -1, false , &indices);
-            if(serializeRes != ExecuteResult::success) return false;
-            strncpy(buffer, tempBuffer.get(), table->getRowSize());
-            cursor.addedChangesToCommit();
-            return true;
-        };
+        Filter filter;
+        if(!updateStatement->updateAll){
+            auto compileRes = compileCondition(table.get(), updateStatement->condition, filter);
+            if(compileRes != ExecuteResult::success) return compileRes;
+        }
+        std::vector<int32_t> columns;
+        filter.bind(columns);
+
+        // Matches are collected before anything is written so that a scan of an index
+        // on an updated column never sees the same row twice
+        std::vector<row_t> matched;
+        if(!collectMatches(table.get(), filter, columns, matched)) return ExecuteResult::unexpectedError;
+
+        // Rows of a page are rewritten together so every page is dirtied once
+        int32_t rowsPerPage = table->getRowsPerPage();
+        int32_t rowSize = table->getRowSize();
+        std::string oldRow(rowSize, '\0');
+        row_t count = 0;
+        for(size_t first = 0; first < matched.size();){
+            int32_t pageNum = matched[first] / rowsPerPage + 1;
+            Page* page = table->pager->read(pageNum);
+            if(page == nullptr) return ExecuteResult::unexpectedError;
+            PinGuard pins{page};
+
+            bool changed = false;
+            size_t last = first;
+            for(; last < matched.size() && matched[last] / rowsPerPage + 1 == pageNum; ++last){
+                row_t row = matched[last];
+                char* buffer = page->buffer.get() + (row % rowsPerPage) * rowSize;
+                memcpy(&oldRow[0], buffer, rowSize);
+                for(int32_t i = 0; i < indices.size(); ++i){
+                    table->codec.set(buffer, indices[i], values[i]);
+                }
+                ++count;
+                if(memcmp(oldRow.data(), buffer, rowSize) == 0) continue;
+
+                changed = true;
+                if(!table->updateBTree(oldRow.data(), buffer, row)){
+                    page->hasUncommitedChanges = true;
+                    note("Updated %d row(s).\n", count);
+                    return ExecuteResult::unexpectedError;
+                }
+                table->stats.recordDelete(table->codec, oldRow.data());
+                table->stats.recordInsert(table->codec, buffer);
+            }
+            if(changed) page->hasUncommitedChanges = true;
+            first = last;
+        }
+        if(!quiet) note("Updated %d row(s).\n", count);
         return ExecuteResult::success;
     }
 
+    /// Rows matching filter in ascending order, found through cheapest access path
+    /// columns must be bound to filter
+    bool collectMatches(Table* table, const Filter& filter, const std::vector<int32_t>& columns, std::vector<row_t>& matched){
+        Plan plan = Planner::choose(table, filter);
+        BatchScanner scanner(table, columns, [&](RowBatch& batch)->bool{
+            filter.apply(batch);
+            for(int32_t s = 0; s < batch.selected; ++s) matched.push_back(batch.rows[batch.selection[s]]);
+            return true;
+        });
+        bool scanRes = Planner::execute(table, plan, filter, [&](row_t row)->bool{
+            if(plan.path == AccessPath::heapScan){
+                matched.push_back(row);
+                return true;
+            }
+            return scanner.push(row);
+        });
+        if(!scanRes || !scanner.flush()) return false;
+        std::sort(matched.begin(), matched.end());
+        return true;
+    }
+
     ExecuteResult executeRemove(std::unique_ptr<QueryStatement>& statement){
         std::shared_ptr<Table> table;
         auto res = sharedManager->open(statement->tableName, table);
         if(res != TableManagerResult::openedSuccessfully) {
             return ExecuteResult::faliure;
         }
+        TableLatch tableLock(*sharedManager, table.get(), statementCommit);
+        if(!table->isOpen()) return ExecuteResult::faliure;
 
         auto deleteStatement = dynamic_cast<DeleteStatement*>(statement.get());
-        // TODO: Search Btree for given condition
-        //       Read Matched Records
-        //       Write Updated Value
-        auto callback = [&](std::vector<std::string>& data)->bool{
-            for(auto& str: data){
-                std::cout << str << " | ";
+        if(deleteStatement->deleteAll){
+            row_t count = table->getRowCount();
+            if(!table->truncate()){
+                note("Some Error Occurred while deleting Rows.\n");
+                return ExecuteResult::faliure;
             }
-            std::cout << std::endl;
-            return true;
-        };
+            if(!quiet) note("Deleted %d row(s).\n", count);
+            return ExecuteResult::success;
+        }
 
-        auto condition = deleteStatement->condition;
-        if(!condition.isCompound){
-            // Single Column
-            auto itr = table->columnIndex.find(condition.col);
-            if(itr == table->columnIndex.end()){
-                printf("Wrong Column Name.\n");
-                return ExecuteResult::faliure;
+        Filter filter;
+        auto compileRes = compileCondition(table.get(), deleteStatement->condition, filter);
+        if(compileRes != ExecuteResult::success) return compileRes;
+        std::vector<int32_t> columns;
+        filter.bind(columns);
+
+        // Rows are found before any is removed since an index scan can't run on a tree being changed
+        std::vector<row_t> matched;
+        if(!collectMatches(table.get(), filter, columns, matched)) return ExecuteResult::unexpectedError;
+
+        auto deleteRes = removeRows(table.get(), matched);
+        if(!quiet || !deleteRes.first) note("Deleted %d row(s).\n", deleteRes.second);
+        if(!deleteRes.first) {
+            note("Some Error Occurred while deleting Rows.\n");
+            return ExecuteResult::faliure;
+        }
+        return ExecuteResult::success;
+    }
+
+    /// Prints and removes rows which must be sorted
+    /// Heap is walked page by page while (cell, pkey) of every index is gathered,
+    /// then each tree removes its entries in key order. Heap slots are freed last, so rows are
+    /// left in heap when a tree fails
+    std::pair<bool, row_t> removeRows(Table* table, const std::vector<row_t>& rows){
+        int32_t rowsPerPage = table->getRowsPerPage();
+        int32_t rowSize = table->getRowSize();
+        std::vector<std::vector<char>> entries(table->indexed.size());
+        row_t numRowsRemoved = 0;
+        sink.begin(table->columnNames);
+
+        for(size_t first = 0; first < rows.size();){
+            int32_t pageNum = rows[first] / rowsPerPage + 1;
+            Page* page = table->pager->read(pageNum);
+            if(page == nullptr) return std::make_pair(false, numRowsRemoved);
+            size_t last = first;
+            for(; last < rows.size() && rows[last] / rowsPerPage + 1 == pageNum; ++last){
+                const char* buffer = page->buffer.get() + (rows[last] % rowsPerPage) * rowSize;
+                sink.beginRow();
+                sink.values(table->codec, buffer);
+                sink.endRow();
+
+                pkey_t pkey = table->codec.getPKey(buffer);
+                for(int i = 0; i < table->indexed.size(); ++i){
+                    if(!table->indexed[i]) continue;
+                    const char* cell = table->codec.cell(buffer, i);
+                    entries[i].insert(entries[i].end(), cell, cell + table->columnSizes[i]);
+                    entries[i].insert(entries[i].end(), (const char*)&pkey, (const char*)&pkey + sizeof(pkey_t));
+                }
             }
-            int colIndex = itr->second;
-            if(!table->indexed[colIndex]){
-                printf("Index not found on given column.\n");
-                return ExecuteResult::faliure;
+            first = last;
+        }
+
+        bool res = sink.flush();
+        for(int i = 0; i < table->indexed.size(); ++i){
+            if(!table->indexed[i]) continue;
+            if(!table->trees[i]->removeCells(entries[i])) return std::make_pair(false, numRowsRemoved);
+        }
+
+        for(size_t first = 0; first < rows.size();){
+            int32_t pageNum = rows[first] / rowsPerPage + 1;
+            Page* page = table->pager->read(pageNum);
+            if(page == nullptr) return std::make_pair(false, numRowsRemoved);
+            size_t last = first;
+            for(; last < rows.size() && rows[last] / rowsPerPage + 1 == pageNum; ++last){
+                if(!table->deleteRow(rows[last])) return std::make_pair(false, numRowsRemoved);
+                table->stats.recordDelete(table->codec, page->buffer.get() + (rows[last] % rowsPerPage) * rowSize);
+                ++numRowsRemoved;
             }
-            std::pair<bool, row_t> deleteRes;
-            switch(condition.compType1){
-                case ComparisonType::equal:
-                    deleteRes = remove(colIndex, condition.data1, table, callback);
-                    break;
-                case ComparisonType::notEqual:
-                    break;
-                case ComparisonType::lessThan:
-                    break;
-                case ComparisonType::greaterThan:
-                    break;
-                case ComparisonType::lessThanOrEqual:
-                    break;
-                case ComparisonType::greaterThanOrEqual:
-                    break;
-                case ComparisonType::error:
-                    break;
+            first = last;
+        }
+        return std::make_pair(res, numRowsRemoved);
+    }
+
+    ExecuteResult executeAnalyze(std::unique_ptr<QueryStatement>& statement){
+        std::shared_ptr<Table> table;
+        auto res = sharedManager->open(statement->tableName, table);
+        if(res != TableManagerResult::openedSuccessfully) {
+            reportTableManager(res);
+            return ExecuteResult::faliure;
+        }
+        TableLatch tableLock(*sharedManager, table.get(), statementCommit);
+        if(!table->isOpen()) return ExecuteResult::faliure;
+
+        auto& stats = table->stats;
+        if(!stats.collect(table.get()) || !stats.save()) return ExecuteResult::unexpectedError;
+
+        note("Analyzed %d row(s).\n", stats.numRows);
+
+        // One row of statistics per column. min and max are null when column holds no value
+        sink.begin({"column", "distinct", "null", "min", "max", "buckets", "mcv"});
+        for(int32_t i = 0; i < stats.columns.size(); ++i){
+            auto& column = stats.columns[i];
+            sink.beginRow();
+            sink.text(table->columnNames[i]);
+            sink.integer(column.distinct);
+            sink.real(column.nullFraction);
+            if(column.count > 0){
+                sink.text(column.text(column.min));
+                sink.text(column.text(column.max));
             }
-            printf("Deleted %d row(s).\n", deleteRes.second);
-            if(!deleteRes.first) {
-                printf("Some Error Occurred while deleting Rows.\n");
-                return ExecuteResult::faliure;
+            else{
+                sink.null();
+                sink.null();
             }
+            sink.integer(column.bounds.size());
+            std::string mcv;
+            for(int32_t j = 0; j < column.mcvs.size(); ++j){
+                if(j) mcv += ",";
+                mcv += column.text(column.mcvs[j]) + "(" + std::to_string(column.mcvCounts[j]) + ")";
+            }
+            sink.text(mcv);
+            sink.endRow();
         }
-
+        if(!sink.flush()) return ExecuteResult::unexpectedError;
         return ExecuteResult::success;
     }
 
-    template <typename callback_t>
-    std::pair<bool, row_t> remove(int index, std::string& key, std::shared_ptr<Table>& table, const callback_t& callback){
-        bool res = true;
-        row_t numRowsRemoved = 0;
-
-        auto removeCallback = [&](row_t row)->bool{
-            Cursor cursor(table.get());
-            cursor.row = row;
-            char* buffer = cursor.value();
-            const auto size = table->columnNames.size();
-            std::vector<std::string> data(size);
-            pkey_t pkey;
-            bool deserializeRes = deserializeRow(buffer, table, data, pkey);
-            if(!deserializeRes) return false;
-            callback(data);
-            for(int i = 0; i < table->indexed.size(); ++i){
-                if(!table->indexed[i] || i == index) continue;
-                bool res = true;
-                std::string key = data[i];
-                switch(table->columnTypes[i]){
-                    BTREE_HANDLER(res, table->trees[i].get(), remove(key, pkey))
-                }
-                if(!res) return false;
+    ExecuteResult executeJoin(std::unique_ptr<QueryStatement>& statement){
+        auto joinStatement = dynamic_cast<JoinStatement*>(statement.get());
+        std::shared_ptr<Table> left, right;
+        auto res = sharedManager->open(joinStatement->tableName, left);
+        if(res == TableManagerResult::openedSuccessfully) res = sharedManager->open(joinStatement->otherTableName, right);
+        if(res != TableManagerResult::openedSuccessfully) {
+            reportTableManager(res);
+            return ExecuteResult::faliure;
+        }
+        // Self join holds its one latch once. Two latches are taken in address order, same as checkpoints
+        // take all of them, so that nobody deadlocks
+        Table* first = std::min(left.get(), right.get());
+        Table* second = std::max(left.get(), right.get());
+        TableLatch firstLock(*sharedManager, first, statementCommit), secondLock;
+        if(second != first) secondLock = TableLatch(*sharedManager, second, statementCommit);
+        if(!left->isOpen() || !right->isOpen()) return ExecuteResult::faliure;
+
+        auto leftItr = left->columnIndex.find(joinStatement->column);
+        auto rightItr = right->columnIndex.find(joinStatement->otherColumn);
+        if(leftItr == left->columnIndex.end() || rightItr == right->columnIndex.end()) return ExecuteResult::invalidColumnName;
+        int32_t leftColumn = leftItr->second, rightColumn = rightItr->second;
+        if(left->columnTypes[leftColumn] != right->columnTypes[rightColumn]) return ExecuteResult::typeMismatch;
+
+        // Every column of left row followed by every column of right row
+        std::vector<std::string> names;
+        for(auto& name: left->columnNames) names.push_back(left->getTableName() + "." + name);
+        for(auto& name: right->columnNames) names.push_back(right->getTableName() + "." + name);
+        sink.begin(names);
+        row_t count = 0;
+        std::string leftRow(left->getRowSize(), '\0');
+        JoinBatch batch([&](JoinBatch& pairs)->bool{
+            for(int32_t i = 0; i < pairs.size; ++i){
+                Cursor leftCursor(left.get());
+                leftCursor.row = pairs.left[i];
+                const char* buffer = leftCursor.value();
+                if(buffer == nullptr) return false;
+                // Both tables may share a page slot in pager so left row is copied first
+                memcpy(&leftRow[0], buffer, leftRow.size());
+
+                Cursor rightCursor(right.get());
+                rightCursor.row = pairs.right[i];
+                buffer = rightCursor.value();
+                if(buffer == nullptr) return false;
+
+                sink.beginRow();
+                sink.values(left->codec, leftRow.data());
+                sink.values(right->codec, buffer);
+                sink.endRow();
             }
-            table->deleteRow(row);
-            ++numRowsRemoved;
+            count += pairs.size;
             return true;
-        };
+        });
 
-        switch(table->columnTypes[index]){
-            BTREE_HANDLER(res, table->trees[index].get(), remove(key, removeCallback))
+        bool joined = false;
+        switch(chooseJoinMethod(left.get(), leftColumn, right.get(), rightColumn)){
+            case JoinMethod::hash:
+                joined = hashJoin(left.get(), leftColumn, right.get(), rightColumn, batch);
+                break;
+            case JoinMethod::sortMerge:
+                joined = sortMergeJoin(left.get(), leftColumn, right.get(), rightColumn, batch);
+                break;
+            case JoinMethod::indexNestedLoop:
+                joined = indexNestedLoopJoin(left.get(), leftColumn, right.get(), rightColumn, batch);
+                break;
         }
-        return std::make_pair(res, numRowsRemoved);
+        if(!sink.flush() || !joined) return ExecuteResult::unexpectedError;
+        if(!quiet) note("Found %d row(s).\n", count);
+        return ExecuteResult::success;
     }
 
     ExecuteResult executeDrop(std::unique_ptr<QueryStatement>& statement){
         auto res = sharedManager->drop(statement->tableName);
-        ErrorHandler::handleTableManagerError(res);
+        reportTableManager(res);
         if(res == TableManagerResult::droppedSuccessfully){
             return ExecuteResult::success;
         }
@@ -407,165 +887,98 @@ private:
     }
 
 private:
-    static ExecuteResult serializeRow(char* buffer, Table* table, std::vector<std::string>& data, pkey_t pkey = -1, bool serializeAll = true, std::vector<int32_t>* indices = nullptr){
-        int32_t offset = 0;
-        int32_t j = 0;
-        int32_t size = table->columnNames.size();
-        for(int32_t i = 0; i < size; ++i){
-            if(serializeAll || (*indices)[j] == i) {
-                switch (table->columnTypes[i]) {
-                    case DataType::Int:
-                        try {
-                            int32_t dataInt = std::stoi(data[j]);
-                            memcpy(buffer + offset, &dataInt, sizeof(int32_t));
-                        } catch (...) {
-                            return ExecuteResult::typeMismatch;
-                        }
-                        break;
-
-                    case DataType::Float:
-                        try {
-                            float dataInt = std::stof(data[j]);
-                            memcpy(buffer + offset, &dataInt, sizeof(float));
-                        } catch (...) {
-                            return ExecuteResult::typeMismatch;
-                        }
-                        break;
-
-                    case DataType::Char:
-                        if (data[i].size() != 1) {
-                            return ExecuteResult::typeMismatch;
-                        }
-                        memcpy(buffer + offset, &data[j][0], sizeof(char));
-                        break;
-
-                    case DataType::Bool:
-                        bool dataBool;
-                        if (strncmp(data[j].c_str(), "true", 4) == 0) {
-                            dataBool = true;
-                        } else if (strncmp(data[j].c_str(), "false", 4) == 0) {
-                            dataBool = false;
-                        } else {
-                            return ExecuteResult::typeMismatch;
-                        }
-                        memcpy(buffer + offset, &dataBool, sizeof(bool));
-
-                        break;
-
-                    case DataType::String:
-                        if (data[j].size() > table->columnSizes[i]) {
-                            return ExecuteResult::stringTooLarge;
-                        }
-                        strncpy(buffer + offset, data[j].c_str(), table->columnSizes[i]);
-                        break;
-                }
-                ++j;
-            }
-            offset += table->columnSizes[i];
-        }
-        if(pkey != -1){
-            try{
-                memcpy(buffer + offset, &pkey, sizeof(pkey_t));
-            }
-            catch(...){
-                printf("Error Saving Primary Key.\n");
-            }
-        }
+    /// Converts where clause into filter evaluated on pages and batches
+    static ExecuteResult compileCondition(Table* table, const Condition& condition, Filter& filter){
+        FilterNode root;
+        auto res = compileNode(table, condition, false, root);
+        if(res != ExecuteResult::success) return res;
+        filter.add(std::move(root));
         return ExecuteResult::success;
     }
 
-    static bool deserializeRow(char* buffer, std::shared_ptr<Table>& table, std::vector<int32_t>& indices, std::vector<std::string>& row, bool selectAll){
-        try{
-            int32_t size = table->columnNames.size();
-            int j = 0;
-            int32_t offset = 0;
-            for(int32_t i = 0; i < size; ++i){
-                if(selectAll || indices[j] == i){
-                    switch(table->columnTypes[i]){
-                        case DataType::Int:
-                            int32_t dataInt;
-                            memcpy(&dataInt, buffer + offset, table->columnSizes[i]);
-                            row[j] = std::move(std::to_string(dataInt));
-                            break;
-
-                        case DataType::Float:
-                            float dataFloat;
-                            memcpy(&dataFloat, buffer + offset, table->columnSizes[i]);
-                            row[j] = std::move(std::to_string(dataFloat));
-                            break;
-
-                        case DataType::Char:
-                            char dataChar;
-                            memcpy(&dataChar, buffer + offset, table->columnSizes[i]);
-                            row[j] = std::move(std::string(1, dataChar));
-                            break;
-
-                        case DataType::Bool:
-                            bool dataBool;
-                            memcpy(&dataBool, buffer + offset, table->columnSizes[i]);
-                            row[j] = dataBool? "true": "false";
-                            break;
-
-                        case DataType::String:
-                            std::string dataString(table->columnSizes[i], '\0');
-                            memcpy((void*)dataString.c_str(), buffer + offset, table->columnSizes[i]);
-                            row[j] = std::move(dataString);
-                            break;
-                    }
-                    ++j;
+    /// Negations are pushed down to comparisons, turning && into || and back on the way
+    static ExecuteResult compileNode(Table* table, const Condition& condition, bool negated, FilterNode& node){
+        switch(condition.type){
+            case ConditionType::comparison: {
+                auto itr = table->columnIndex.find(condition.col);
+                if(itr == table->columnIndex.end()) return ExecuteResult::invalidColumnName;
+                node.type = FilterType::predicate;
+                ComparisonType op = negated ? negateComparison(condition.compType) : condition.compType;
+                auto res = node.predicate.compile(table, itr->second, op, condition.data);
+                if(res != CodecResult::success) return codecError(res);
+                return ExecuteResult::success;
+            }
+            case ConditionType::negation:
+                return compileNode(table, condition.children[0], !negated, node);
+            case ConditionType::conjunction:
+            case ConditionType::disjunction: {
+                bool conjunction = (condition.type == ConditionType::conjunction) != negated;
+                node.type = conjunction ? FilterType::conjunction : FilterType::disjunction;
+                node.children.resize(condition.children.size());
+                for(int32_t i = 0; i < condition.children.size(); ++i){
+                    auto res = compileNode(table, condition.children[i], negated, node.children[i]);
+                    if(res != ExecuteResult::success) return res;
                 }
-                offset += table->columnSizes[i];
+                return ExecuteResult::success;
             }
         }
-        catch(...){
-            return false;
+        return ExecuteResult::unexpectedError;
+    }
+
+    /// Appends chosen plan, its filter and rejected plans to lines of explain output
+    static void explain(Table* table, const std::vector<Plan>& plans, SelectStatement* statement, std::vector<std::string>& lines){
+        appendLines(lines, "", "", plans.front().describe(table));
+        if(!statement->selectAllRows){
+            lines.push_back("  Filter: " + conditionText(statement->condition));
+        }
+        for(int32_t i = 1; i < plans.size(); ++i){
+            appendLines(lines, "  Rejected: ", "  ", plans[i].describe(table));
         }
-        return true;
     }
-    static bool deserializeRow(char* buffer, std::shared_ptr<Table>& table, std::vector<std::string>& row, pkey_t& pkey){
-        try{
-            int32_t size = table->columnNames.size();
-            int j = 0;
-            int32_t offset = 0;
-            for(int32_t i = 0; i < size; ++i){
-                switch(table->columnTypes[i]){
-                    case DataType::Int:
-                        int32_t dataInt;
-                        memcpy(&dataInt, buffer + offset, table->columnSizes[i]);
-                        row[i] = std::move(std::to_string(dataInt));
-                        break;
-
-                    case DataType::Float:
-                        float dataFloat;
-                        memcpy(&dataFloat, buffer + offset, table->columnSizes[i]);
-                        row[i] = std::move(std::to_string(dataFloat));
-                        break;
-
-                    case DataType::Char:
-                        char dataChar;
-                        memcpy(&dataChar, buffer + offset, table->columnSizes[i]);
-                        row[i] = std::move(std::string(1, dataChar));
-                        break;
-
-                    case DataType::Bool:
-                        bool dataBool;
-                        memcpy(&dataBool, buffer + offset, table->columnSizes[i]);
-                        row[i] = dataBool? "true": "false";
-                        break;
-
-                    case DataType::String:
-                        std::string dataString(table->columnSizes[i], '\0');
-                        memcpy((void*)dataString.c_str(), buffer + offset, table->columnSizes[i]);
-                        row[i] = std::move(dataString);
-                        break;
-                }
-                offset += table->columnSizes[i];
-            }
-            memcpy(&pkey, buffer + offset, sizeof(pkey_t));
+
+    /// Splits text of a plan, which has a line per node of bitmap plans, into lines
+    /// prefix goes before first line and indent before the rest so they stay under it
+    static void appendLines(std::vector<std::string>& lines, const std::string& prefix, const std::string& indent, const std::string& text){
+        size_t start = 0;
+        while(true){
+            size_t end = text.find('\n', start);
+            lines.push_back((start == 0 ? prefix : indent) + text.substr(start, end == std::string::npos ? end : end - start));
+            if(end == std::string::npos) break;
+            start = end + 1;
         }
-        catch(...){
-            return false;
+    }
+
+    /// Explain output goes out as rows of one column, so that it reaches clients like any result
+    ExecuteResult writePlan(const std::vector<std::string>& lines){
+        sink.begin({"plan"});
+        for(auto& line: lines){
+            sink.beginRow();
+            sink.text(line);
+            sink.endRow();
         }
-        return true;
+        if(!sink.flush()) return ExecuteResult::unexpectedError;
+        return ExecuteResult::success;
+    }
+
+    void reportTableManager(TableManagerResult res){
+        const char* message = tableManagerMessage(res);
+        if(*message != '\0') note("%s\n", message);
+    }
+
+    void reportColumnMismatch(int32_t actualSize, int32_t expectedSize){
+        note("Number of values provided does not match number of columns\n"
+             "Expected %d value(s). Got %d value(s)\n", expectedSize, actualSize);
+    }
+
+    static ExecuteResult codecError(CodecResult res){
+        switch(res){
+            case CodecResult::typeMismatch:
+                return ExecuteResult::typeMismatch;
+            case CodecResult::stringTooLarge:
+                return ExecuteResult::stringTooLarge;
+            case CodecResult::success:
+                return ExecuteResult::success;
+        }
+        return ExecuteResult::unexpectedError;
     }
 };
\ No newline at end of file
@@ -1,14 +1,6 @@
 #include "HeaderFiles/ExternalSort.h"
 #include <fstream>
 
-// CONVERT TEMPLATE SECIALIZATION
-template <> inline int convertDataType<int>(const std::string& str)    {  return std::stoi(str);  }
-template <> inline char convertDataType<char>(const std::string& str)  {  return str[0];          }
-template <> inline bool convertDataType<bool>(const std::string& str)  {  return str == "true";   }
-template <> inline float convertDataType<float>(const std::string& str){  return std::stof(str);  }
-template <> inline dbms::string convertDataType<dbms::string>(const std::string& str){  return dbms::string(str);  }
-
-
 // ---------------------- SeqPageReader ----------------------
 
 SeqPageReader::~SeqPageReader(){
@@ -20,6 +12,7 @@ void SeqPageReader::flushRemaining(){
     if(writeThread.joinable()) writeThread.join();
     if(inFileDescriptor != -1)  ::close(inFileDescriptor);
     if(outFileDescriptor != -1) ::close(outFileDescriptor);
+    inFileDescriptor = outFileDescriptor = -1;
     primaryOutputBuffer.reset();
     secondaryInputBuffer.reset();
     primaryOutputBuffer.reset();
@@ -134,6 +127,7 @@ void ExtSortPager::flushRemaining(){
     if(writeThread.joinable()) writeThread.join();
     if(inFileDescriptor != -1) ::close(inFileDescriptor);
     if(outFileDescriptor != -1) ::close(outFileDescriptor);
+    inFileDescriptor = outFileDescriptor = -1;
 };
 
 void ExtSortPager::initialise(const char* inFileName, const char* outFileName, int64_t blocksPerBuffer_, uint64_t offset_, int k_){
@@ -296,8 +290,12 @@ ExternalSort<key_t>::ExternalSort(const std::string& databaseName_, const std::s
         deletedRows[i] = rowStack[i + 1];
     }
     std::sort(deletedRows.begin(), deletedRows.end());
-    this->partiallySortedFileName[0] = std::string("extSortTemp/") + "_0_" + fileName_;
-    this->partiallySortedFileName[1] = std::string("extSortTemp/") + "_1_" + fileName_;
+
+    // Runs are kept next to table so that final rename never crosses devices
+    std::string tempDirectory = databaseName_ + "/extSortTemp/";
+    std::filesystem::create_directories(tempDirectory);
+    this->partiallySortedFileName[0] = tempDirectory + "_0_" + fileName_;
+    this->partiallySortedFileName[1] = tempDirectory + "_1_" + fileName_;
 }
 
 template <typename key_t>
@@ -309,6 +307,9 @@ void ExternalSort<key_t>::sort(int rowSize_, int columnOffset_, int32_t keySize_
     rowsPerOutputBlock  = EXT_WRITE_BLOCKS * extBlockSize / (sizeof(row_t) + keySize);
     fileIdx             = 0;
     getData(headerOffset);
+
+    // Deleted rows were skipped so only written entries take part in merging
+    numRows = currentWriteRow;
     // convertToText<key_t>(partiallySortedFileName[0], "initial.txt", keySize, numRows);
 
     pager.readSize = rowsPerInputBlock * (sizeof(row_t) + keySize);
@@ -339,12 +340,15 @@ void ExternalSort<key_t>::getData(uint32_t headerOffset){
     auto nextDeletedRow = deletedRows.begin();
 
     while(readNextRow(key)){
+        // readNextRow has already moved past the row it read
+        row_t row = currentReadRow - 1;
+
         // Check if this row is deleted
-        if(nextDeletedRow != deletedRows.end() && currentReadRow == *nextDeletedRow){
+        if(nextDeletedRow != deletedRows.end() && row == *nextDeletedRow){
             ++nextDeletedRow;
         }
         else{
-            writeNextRow(key, currentReadRow);
+            writeNextRow(key, row);
         }
     }
 
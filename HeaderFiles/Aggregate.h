@@ -0,0 +1,107 @@
+#ifndef DBMS_AGGREGATE_H
+#define DBMS_AGGREGATE_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// Aggregator is the last operator of an aggregate select
+/// It consumes RowBatches and keeps one Accumulator per aggregate per group
+/// 1. Hash aggregation      => groups are found through a hash map on group value
+///                             and printed in group order once input ends
+/// 2. Streaming aggregation => input arrives ordered on group column (BPTree leaf scan)
+///                             so only current group is kept and it is printed as soon as value changes
+/// Without group by whole input is a single group
+
+/// ---------------- SELECT LIST ----------------
+/// select {count(*), sum(<col>), min(<col>), max(<col>), avg(<col>), <group-col>} from <table> group by <group-col>
+/// sum and avg only work on int and float columns
+/// Aggregates over no rows (other than count) are printed as null
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "RowBatch.h"
+#include "RowCodec.h"
+#include "DataTypes.h"
+#include "ResultSink.h"
+
+enum class AggregateFunction{
+    none,                               // Group column printed as it is
+    count,
+    sum,
+    min,
+    max,
+    avg,
+    error
+};
+
+AggregateFunction findAggregateFunction(const char* name);
+const char* aggregateName(AggregateFunction function);
+
+/// One entry of select list
+class AggregateSpec{
+public:
+    AggregateFunction function;
+    int32_t column;                     // Column number in table. -1 for count(*)
+    int32_t position;                   // Position of column in batch. -1 for count(*)
+
+    AggregateSpec();
+};
+
+/// Value which owns its string bytes so that it outlives batch it was read from
+class OwnedValue{
+    Value value;
+    std::string text;
+
+public:
+    bool isSet;
+
+    OwnedValue();
+
+    void set(const Value& value_);
+    Value get() const;
+};
+
+/// Running state of one aggregate of one group
+class Accumulator{
+public:
+    int64_t count;
+    int64_t intSum;
+    double floatSum;
+    OwnedValue min;
+    OwnedValue max;
+
+    Accumulator();
+
+    void add(const Value& value);
+    void write(AggregateFunction function, ResultSink& sink) const;
+};
+
+class Aggregator{
+    std::vector<AggregateSpec> specs;
+    int32_t groupPosition;              // Position of group column in batch. -1 without group by
+    bool streaming;
+
+    std::unordered_map<std::string, int32_t> groupIndex;
+    std::vector<OwnedValue> groupValues;
+    std::vector<Accumulator> accumulators;   // specs.size() per group
+
+    ResultSink& sink;
+
+public:
+    int32_t groupCount;                 // Groups printed so far
+
+    /// Groups are written to sink as one row each
+    Aggregator(std::vector<AggregateSpec> specs_, int32_t groupPosition_, bool streaming_, ResultSink& sink_);
+
+    /// Adds selected rows of batch
+    bool consume(const RowBatch& batch);
+
+    /// Prints remaining groups
+    bool finish();
+
+private:
+    int32_t findGroup(const Value& value);
+    bool emit(int32_t group);
+};
+
+#endif //DBMS_AGGREGATE_H
@@ -30,15 +30,25 @@ public:
     row_t rootPageNum;
     std::unique_ptr<node_t> root;
 
-    BPTreeNodeManager(const char* fileName, int32_t branchingFactor_, int32_t keySize_,int nodeLimit_ = DEFAULT_PAGE_LIMIT);
+    BPTreeNodeManager(const char* fileName, int32_t branchingFactor_, int32_t keySize_, WriteAheadLog* log_ = nullptr,
+                      int64_t logOwner = -1, int nodeLimit_ = DEFAULT_PAGE_LIMIT);
     ~BPTreeNodeManager();
     row_t nextFreeIndexLocation();
-    void addFreeIndexLocation(row_t location);
+
+    /// Pushes page of node on free page stack. Once header page is full the rest are chained through freed pages
+    void addFreeIndexLocation(node_t* node);
     node_t* read(int32_t pageNo);
     node_t* readChild(node_t* parent, int32_t childIndex);
     bool flushPage(node_t* node) override;
+    bool canEvict(node_t* node) override;
     bool flush(uint32_t pageNum);
     bool flushAll();
+
+    /// Writes header, root and cached nodes only when they changed
+    bool flushChanges();
+
+    /// Leaves an empty root and no free pages as in a newly created file
+    bool truncate();
     bool getRoot();
     void setRoot(node_t* newRoot);
     bool getHeader();
@@ -11,6 +11,12 @@
 #include <memory>
 #include <utility>
 #include <functional>
+#include <limits>
+#include <algorithm>
+#include <tuple>
+#include <queue>
+#include <thread>
+#include <atomic>
 #include "Constants.h"
 #include "Table.h"
 #include "BPTreeNodeManager.h"
@@ -39,6 +45,15 @@ class BPTNode: public Page{
     pkey_t* pkeys;
     row_t* child;
 
+    /// ---------------- POINTER SWIZZLING ----------------
+    /// In memory only. swizzled[i] is frame of child[i] if it has been reached through this node.
+    /// Parent and slot are kept on child so that it can be unswizzled when evicted.
+    /// Whole array is cleared whenever child[] of this node is rearranged.
+    std::unique_ptr<Node*[]> swizzled;
+    int32_t swizzledCapacity;
+    Node* swizzleParent;
+    int32_t swizzleSlot;
+
     template <typename o_key_t>
     friend class BPTree;
 
@@ -56,12 +71,18 @@ public:
     inline void readHeader(int32_t maxSize, int32_t keySize);
     void writeHeader();
     void allocate(int32_t maxSize, int32_t keySize);
+    void swizzle(int32_t index, Node* node, int32_t maxChildren);
+    void unswizzle();
+    void detachFromParent();
 
     BPTNode(){
         isLeaf = false;
         size = 0;
         leftSibling_ = 0;
         rightSibling_ = 0;
+        swizzledCapacity = 0;
+        swizzleParent = nullptr;
+        swizzleSlot = -1;
         this->hasUncommitedChanges = true;
     }
 
@@ -89,6 +110,41 @@ public:
     virtual ~BPlusTreeBase() = default;
     virtual void traverseAllWithKey(std::string){}
     virtual bool traverse(const std::function<bool(row_t row)>& callback){return false;}
+
+    /// Key is read directly from cell bytes of a row
+    virtual bool insertCell(const char* cell, pkey_t pkey, row_t row){return false;}
+
+    /// Every run holds | cell | pkey | row | of keySize + sizeof(pkey_t) + sizeof(row_t) bytes in any order
+    /// Runs are sorted on their own threads and merged. Runs are emptied
+    /// Empty tree is built bottom up from merged entries. Otherwise they are inserted in key order
+    /// String trees are not supported and return false
+    virtual bool insertCells(std::vector<std::vector<char>>& runs){return false;}
+    virtual bool removeCell(const char* cell, pkey_t pkey){return false;}
+
+    /// entries holds | cell | pkey | of keySize + sizeof(pkey_t) bytes one after another in any order
+    /// Entries falling in one leaf are removed together after a single descent
+    /// false when some entry was not found. Others are still removed
+    /// String trees are not supported and return false
+    virtual bool removeCells(const std::vector<char>& entries){return false;}
+
+    /// Drops every entry and shrinks file back to an empty tree
+    virtual bool truncate(){return false;}
+
+    /// Writes out nodes changed since last call so that they can be committed
+    virtual bool flushChanges(){return false;}
+
+    /// Visits rows with lowCell <= key <= highCell in key order
+    /// nullptr bound means that side is open
+    /// Descending visits them from highCell down to lowCell
+    virtual bool traverseCellRange(const char* lowCell, const char* highCell, bool descending, const std::function<bool(row_t row)>& callback){return false;}
+
+    /// Rows holding smallest and largest key. false when tree is empty
+    virtual bool firstRow(row_t& row){return false;}
+    virtual bool lastRow(row_t& row){return false;}
+
+    /// Shape of tree used by planner to cost index scans
+    virtual int32_t height(){return 0;}
+    virtual int32_t fanout() const{return 0;}
 };
 
 template <typename key_t>
@@ -102,10 +158,32 @@ class BPTree: public BPlusTreeBase{
     int32_t branchingFactor;
 
 public:
-    BPTree(const char* filename, int32_t branchingFactor_, int32_t keySize_);
+    BPTree(const char* filename, int32_t branchingFactor_, int32_t keySize_, WriteAheadLog* log = nullptr, int64_t logOwner = -1);
     bool insert(const std::string& keyStr, pkey_t pkey, row_t row);
+    bool insertKey(const key_t& key, pkey_t pkey, row_t row);
+    bool insertCell(const char* cell, pkey_t pkey, row_t row) override;
+    bool insertCells(std::vector<std::vector<char>>& runs) override;
     bool search(const std::string& str);
     bool traverse(const std::function<bool(row_t row)>& callback) override;
+    bool traverseRange(const key_t* low, const key_t* high, bool descending, const std::function<bool(row_t row)>& callback);
+    bool traverseCellRange(const char* lowCell, const char* highCell, bool descending, const std::function<bool(row_t row)>& callback) override;
+    bool firstRow(row_t& row) override;
+    bool lastRow(row_t& row) override;
+    int32_t height() override;
+    int32_t fanout() const override;
+
+    /// Merges leaf chains of both trees. Callback gets rows with equal keys
+    bool naturalJoinBothIndex(BPTree<key_t>& other, const std::function<bool(row_t rowOfCurrent, row_t rowOfOther)>& callback);
+
+    /// Merges leaf chain of this tree with other side sorted on same key
+    /// run_t must provide `bool next(key_t& key, row_t& row)` returning (key, row) in key order
+    template <typename run_t>
+    bool naturalJoinOneIndex(run_t& other, const std::function<bool(row_t rowOfCurrent, row_t rowOfOther)>& callback);
+
+    /// Looks up every probe key. Probes must be sorted on key
+    /// Probe whose key lies in leaf reached by previous probe reuses that leaf instead of descending from root
+    /// Callback gets (row of this tree, row of probe) and must not read this tree
+    bool probeSorted(const std::vector<std::pair<key_t, row_t>>& probes, const std::function<bool(row_t rowOfCurrent, row_t rowOfOther)>& callback);
     bool BFStraverse(const std::function<bool(row_t row)>& callback);
     void traverseAllWithKey(const std::string& strKey, const std::function<void(row_t rowOfCurrent)>& funcToPrint);
     void bfsTraverseDebug();
@@ -113,6 +191,11 @@ public:
     /// true  -> (key, pkey) found and deleted
     /// false -> (key, pkey) not found
     bool remove(const std::string& key, const pkey_t pkey);
+    bool removeKey(const key_t& key, const pkey_t pkey);
+    bool removeCell(const char* cell, pkey_t pkey) override;
+    bool removeCells(const std::vector<char>& entries) override;
+    bool truncate() override;
+    bool flushChanges() override;
 
     /// true  -> all found records deleted
     /// false -> some data inconsistency
@@ -127,10 +210,9 @@ private:
     int32_t binarySearch(Node* node, const key_t& key, const pkey_t pkey);
     void splitRoot();
     void splitNode(Node* parent, Node* child, int indexFound);
+    bool bulkLoad(const std::vector<std::tuple<key_t, pkey_t, row_t>>& entries);
     void bfsTraverseUtilDebug(Node* start);
     bool traverseUtil(Node* start, const std::function<bool(row_t row)>& callback);
-    void naturalJoinBothIndex(Node* rootOfOtherBTree, const std::function<void(row_t rowOfCurrent, row_t rowOfOther)>& funcToPrint);
-    void naturalJoinOneIndex(Node* rootOfOtherBTree, const std::function<void(row_t rowOfCurrent, row_t rowOfOther)>& funcToPrint);
 
 //    void greaterThanEquals(const key_t& key);
 //    void smallerThanEquals(const key_t& key);
@@ -142,6 +224,8 @@ private:
     // MARK:- HELPER FUNCTIONS
     // Delete Helpers
     row_t deleteAtLeaf(Node* node, int index);
+    Node* leafForRemove(const key_t& key, const pkey_t pkey);
+    bool removeSorted(const std::vector<std::pair<key_t, pkey_t>>& entries);
     void borrowFromLeftSibling(int indexFound, Node* parent, Node* child, Node* leftSibling);
     void borrowFromRightSibling(int indexFound, Node* parent, Node* child, Node* rightSibling);
     void mergeWithSibling(int indexFound, Node*& parent, Node* child, Node* leftSibling, Node* rightSibling);
@@ -152,7 +236,7 @@ private:
 
     // Join Helpers
     BPTNode<key_t>* leftMostLeaf(Node* root);
-//   void removeMultipleAtLeaf(Node* leaf, int startIndex, int countToDelete);
+    BPTNode<key_t>* rightMostLeaf(Node* root);
 //   void iterateLeftLeaf(Node* node, int startIndex);
 };
 
@@ -15,6 +15,16 @@ enum class DataType{
     String,
 };
 
+enum class ComparisonType{
+    equal,
+    notEqual,
+    lessThan,
+    greaterThan,
+    lessThanOrEqual,
+    greaterThanOrEqual,
+    error
+};
+
 template <typename T>
 T convertDataType(const std::string& str);
 
@@ -0,0 +1,155 @@
+#ifndef DBMS_DATABASE_H
+#define DBMS_DATABASE_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// Library interface to the engine, built as libdbms (static and shared) without the REPL
+/// 1. Database   => database directory opened once per process. Tables are shared by its connections
+/// 2. Connection => session with its own executor, output buffer and prepared statements
+/// 3. Statement  => statement parsed once whose ? parameters are bound before every execute()
+/// 4. ResultSet  => rows produced by a statement, read column by column with next()
+/// Connections of one Database may be used from different threads. One connection must not be used by two at once
+/// Statements on different tables run in parallel. Those on one table run one at a time
+/// Connections may not outlive their Database and Statements may not outlive their Connection
+
+/// ---------------- EXAMPLE ----------------
+/// auto db = dbms::Database::open("./MyDatabase");
+/// auto connection = db->connect();
+/// auto statement = connection.prepare("select {id, name} from users where id == ?");
+/// statement.bind(0, 42);
+/// auto rows = statement.execute();
+/// while(rows.next()) use(rows.getInt(0), rows.getString(1));
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Executor;
+class TableManager;
+struct QueryStatement;
+struct PreparedStatement;
+enum class StatementType;
+
+namespace dbms{
+    enum class ValueType{
+        null,
+        integer,
+        real,
+        boolean,
+        character,
+        string
+    };
+
+    class ResultSet{
+        friend class Connection;
+        friend class Statement;
+
+        bool success = true;
+        std::string error;
+        std::vector<std::string> names;
+        std::string data;               // | row length | tagged cells | per row as written by binary output
+        size_t nextRow = 0;
+        std::vector<size_t> cells;      // Offsets of cells of current row
+
+    public:
+        ResultSet() = default;
+
+        /// false when statement failed. message() tells why, or what statement reported when it succeeded
+        bool ok() const;
+        const std::string& message() const;
+
+        int32_t columnCount() const;
+        const std::string& columnName(int32_t column) const;
+
+        /// Moves to next row. false after last one
+        bool next();
+
+        ValueType type(int32_t column) const;
+        bool isNull(int32_t column) const;
+
+        /// Integers, booleans and characters as numbers. Reals are truncated
+        int64_t getInt(int32_t column) const;
+        double getDouble(int32_t column) const;
+        bool getBool(int32_t column) const;
+
+        /// Strings and characters. Valid until ResultSet is destroyed
+        std::string_view getString(int32_t column) const;
+
+    private:
+        static ResultSet failure(const char* message);
+    };
+
+    class Statement{
+        friend class Connection;
+
+        Executor* executor = nullptr;
+        std::unique_ptr<PreparedStatement> prepared;
+        std::string error;
+
+    public:
+        Statement();
+        Statement(Statement&&) noexcept;
+        Statement& operator=(Statement&&) noexcept;
+        ~Statement();
+
+        /// false when text could not be prepared. message() tells why
+        bool ok() const;
+        const std::string& message() const;
+        int32_t parameterCount() const;
+
+        /// Sets parameter at index, counting ? from 0 in order of appearance. false if there is no such parameter
+        bool bind(int32_t index, int64_t value);
+        bool bind(int32_t index, int32_t value);
+        bool bind(int32_t index, double value);
+        bool bind(int32_t index, bool value);
+        bool bind(int32_t index, std::string_view value);
+        bool bind(int32_t index, const char* value);
+
+        ResultSet execute();
+    };
+
+    class Connection{
+        friend class Database;
+        friend class Statement;
+
+        std::unique_ptr<Executor> executor;
+
+        explicit Connection(std::shared_ptr<TableManager> manager);
+
+        /// Executes statement with output of executor captured into result
+        static ResultSet run(Executor& executor, StatementType type, std::unique_ptr<QueryStatement>& statement);
+
+    public:
+        Connection(Connection&&) noexcept;
+        Connection& operator=(Connection&&) noexcept;
+        ~Connection();
+
+        /// Runs any statement. Rows of select, join, delete, explain and analyze come back in ResultSet
+        /// Nothing is printed. Messages of statement come back as message() of ResultSet
+        ResultSet execute(std::string_view text);
+
+        /// Parses insert, select, update or delete once for many executions
+        Statement prepare(std::string_view text);
+    };
+
+    class Database{
+        std::shared_ptr<TableManager> manager;
+
+        explicit Database(std::shared_ptr<TableManager> manager_);
+
+    public:
+        ~Database();
+
+        /// Opens directory, creating it when missing and recovering it from its write-ahead log
+        /// nullptr when it can't be used
+        static std::shared_ptr<Database> open(const std::string& directory);
+
+        Connection connect();
+
+        /// Writes every changed page of open tables to disk
+        void flush();
+    };
+}
+
+#endif //DBMS_DATABASE_H
@@ -45,8 +45,8 @@ using block_t = int64_t;
 /// This is responsible for sequentially reading table file
 /// This is double buffered
 class SeqPageReader{
-    int inFileDescriptor;
-    int outFileDescriptor;
+    int inFileDescriptor = -1;
+    int outFileDescriptor = -1;
     int64_t inputFileSize;
     int64_t outputFileSize;
     int requiredNumberOfFetches;
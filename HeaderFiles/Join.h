@@ -0,0 +1,264 @@
+#ifndef DBMS_JOIN_H
+#define DBMS_JOIN_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// Equi join of two tables on one column each
+/// Matching (left row, right row) pairs are collected in a JoinBatch and handed over
+/// BATCH_SIZE pairs at a time so that result is never materialised
+
+/// ---------------- SORT MERGE JOIN ----------------
+/// Both sides are read in key order and merged
+/// 1. Side with BPTree on join column => leaf chain of tree
+/// 2. Side without index              => SortedRun of (key, row)
+/// SortedRun sorts in memory when it fits JOIN_MEMORY_BUDGET and uses ExternalSort otherwise
+
+/// ---------------- HASH JOIN ----------------
+/// Used when neither join column is indexed
+/// Smaller table is the build side. Its (key, row) are put in an open addressing JoinHashTable
+/// and every row of other table probes it
+/// When build side doesn't fit JOIN_MEMORY_BUDGET both sides are radix partitioned on high bits
+/// of key hash into temp files (Grace hash join) and each pair of partitions is joined on its own
+/// Files are <db>/joinTemp/{build,probe}_<join>_<partition>.part and are removed once join is done
+/// Partition entry => | cell of join column | row |
+
+/// ---------------- INDEX NESTED LOOP JOIN ----------------
+/// Used when one side is small and other side has BPTree on join column
+/// Keys of outer side are collected JOIN_PROBE_BATCH at a time, sorted and looked up with
+/// BPTree::probeSorted so that neighbouring keys share a leaf instead of descending again
+/// Matches of a batch are handed over in row order of inner side so its heap pages are read in order
+
+/// ---------------- CHOOSING METHOD ----------------
+/// Costs are in units of Planner. Output rows are fetched the same way by every method so only
+/// reading join columns is costed
+/// Sort Merge => per side: indexed ? (height + leaf pages) * RANDOM_PAGE_COST + rows * CPU_ROW_COST
+///                                 : heap pages * SEQ_PAGE_COST + rows * log2(rows) * CPU_ROW_COST
+/// Index NLJ  => outer heap pages * SEQ_PAGE_COST + outer rows * (log2(batch) + height) * CPU_ROW_COST
+///             + min(outer rows, inner leaf pages) * RANDOM_PAGE_COST
+/// Hash join is used when neither column is indexed
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <type_traits>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include "Table.h"
+#include "RowBatch.h"
+#include "ExternalSort.h"
+#include "Planner.h"
+#include "Constants.h"
+
+const int64_t JOIN_MEMORY_BUDGET = (1 << 24);                             // 16MB
+const int64_t JOIN_READ_SIZE     = (1 << 16);                             // Bytes read at once from sorted file
+const int64_t JOIN_SPILL_BUFFER  = (1 << 14);                             // Write buffer of each partition
+const int64_t JOIN_SPILL_READ    = (1 << 20);                             // Read buffer of a partition file
+const int32_t JOIN_MAX_RADIX_BITS = 8;                                    // At most 256 partitions
+const int32_t JOIN_PROBE_BATCH   = BATCH_SIZE;                            // Outer keys looked up together
+
+#define JOIN_SPILL_READ_ASYNC
+
+enum class JoinMethod{
+    hash,
+    sortMerge,
+    indexNestedLoop
+};
+
+/// Calls callback with join column cell of every row of table in heap order
+bool scanCells(Table* table, int32_t column, const std::function<bool(const char* cell, row_t row)>& callback);
+
+/// Key of join column as stored in cell
+/// Strings are compared as std::string since dbms::string keys can't be copied safely
+template <typename key_t>
+inline key_t readKey(const char* cell, int32_t width){
+    key_t key;
+    memcpy(&key, cell, sizeof(key_t));
+    return key;
+}
+
+template <>
+inline std::string readKey<std::string>(const char* cell, int32_t width){
+    return std::string(cell, strnlen(cell, width));
+}
+
+class JoinBatch{
+public:
+    row_t left[BATCH_SIZE];
+    row_t right[BATCH_SIZE];
+    int32_t size;
+
+    explicit JoinBatch(std::function<bool(JoinBatch&)> consumer_);
+
+    inline bool push(row_t leftRow, row_t rightRow){
+        left[size] = leftRow;
+        right[size] = rightRow;
+        if(++size == BATCH_SIZE) return flush();
+        return true;
+    }
+
+    /// Hands over partially filled batch
+    bool flush();
+
+private:
+    std::function<bool(JoinBatch&)> consumer;
+};
+
+/// (key, row) of every row of a table in key order
+template <typename key_t>
+class SortedRun{
+    std::vector<std::pair<key_t, row_t>> entries;
+    size_t position;
+    bool descending;
+
+    // ExternalSort output. Every entry is | key | row |
+    // Descending run reads it back to front
+    bool external;
+    int fileDescriptor;
+    std::string sortedFileName;
+    std::unique_ptr<char[]> buffer;
+    int64_t bufferSize;
+    int64_t bufferOffset;
+    int64_t fileOffset;
+
+public:
+    SortedRun();
+    ~SortedRun();
+
+    bool build(Table* table, int32_t column, bool descending_ = false);
+
+    /// false when all entries are read
+    bool next(key_t& key, row_t& row);
+
+private:
+    bool buildInMemory(Table* table, int32_t column);
+    bool buildExternal(Table* table, int32_t column);
+};
+
+/// Merges two runs sorted on same key. Callback gets (left row, right row)
+template <typename key_t, typename left_t, typename right_t>
+bool mergeRuns(left_t& left, right_t& right, const std::function<bool(row_t, row_t)>& callback);
+
+/// Sort merge join of left.leftColumn == right.rightColumn
+/// Columns must be of same type
+bool sortMergeJoin(Table* left, int32_t leftColumn, Table* right, int32_t rightColumn, JoinBatch& output);
+
+/// Never 0 so that 0 marks an empty slot
+template <typename key_t>
+inline uint32_t hashKey(const key_t& key){
+    uint64_t bits = 0;
+    memcpy(&bits, &key, sizeof(key_t));
+    if constexpr(std::is_floating_point<key_t>::value){
+        if(key == 0) bits = 0;                                  // -0.0 == 0.0
+    }
+    bits *= 0x9E3779B97F4A7C15ULL;
+    return static_cast<uint32_t>(bits >> 32) | 1u;
+}
+
+template <>
+inline uint32_t hashKey<std::string>(const std::string& key){
+    uint64_t bits = std::hash<std::string>{}(key);
+    bits *= 0x9E3779B97F4A7C15ULL;
+    return static_cast<uint32_t>(bits >> 32) | 1u;
+}
+
+/// Open addressing with linear probing. Each distinct key has one slot holding a chain of its rows
+/// so that duplicate keys cost neither insert nor probe a walk past other keys
+/// Hash is kept in slot so that most mismatches never compare keys
+template <typename key_t>
+class JoinHashTable{
+    struct Slot{
+        uint32_t hash;                  // 0 => empty
+        uint32_t first;                 // Chain of rows of key in entries, in insertion order
+        uint32_t last;
+        key_t key;
+    };
+    struct Entry{
+        row_t row;
+        uint32_t next;                  // NO_ENTRY ends chain
+    };
+    static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+    std::vector<Slot> slots;
+    std::vector<Entry> entries;
+    uint32_t mask;
+    size_t count;                       // Distinct keys
+
+public:
+    /// Bytes used per build row at load factor of 1/2 when every key is distinct
+    static constexpr int64_t entrySize = 2 * sizeof(Slot) + sizeof(Entry);
+
+    explicit JoinHashTable(size_t rows);
+
+    void insert(const key_t& key, uint32_t hash, row_t row);
+
+    /// Calls callback with every row whose key equals key
+    bool probe(const key_t& key, uint32_t hash, const std::function<bool(row_t row)>& callback) const;
+
+private:
+    void grow();
+};
+
+/// Sequentially reads a file of fixed size entries
+/// Next block is fetched into secondary buffer while primary buffer is consumed
+class PartitionReader{
+    int fileDescriptor;
+    int32_t entrySize;
+    int64_t blockSize;
+    std::unique_ptr<char[]> primaryBuffer;
+    std::unique_ptr<char[]> secondaryBuffer;
+    int64_t primarySize;
+    int64_t secondarySize;
+    int64_t offset;
+    std::thread readThread;
+
+public:
+    PartitionReader(const std::string& fileName, int32_t entrySize_);
+    ~PartitionReader();
+
+    /// Pointer to next entry. nullptr when file is exhausted
+    const char* next();
+
+private:
+    void fetchFromStorage();
+    void fetchInput();
+};
+
+/// Radix partitions (cell, row) entries into 2^radixBits temp files
+class PartitionWriter{
+    std::vector<int> fileDescriptors;
+    std::vector<std::unique_ptr<char[]>> buffers;
+    std::vector<int64_t> used;
+    int32_t width;
+    int32_t entrySize;
+    int32_t shift;
+
+public:
+    std::vector<std::string> fileNames;
+
+    PartitionWriter(const std::string& prefix, int32_t radixBits, int32_t width_);
+    ~PartitionWriter();
+
+    bool append(uint32_t hash, const char* cell, row_t row);
+
+    /// Writes partially filled buffers and closes files
+    bool finish();
+    static void remove(const std::vector<std::string>& fileNames);
+
+private:
+    bool flush(int32_t partition);
+};
+
+/// Hash join of left.leftColumn == right.rightColumn
+/// Columns must be of same type
+bool hashJoin(Table* left, int32_t leftColumn, Table* right, int32_t rightColumn, JoinBatch& output);
+
+/// Index nested loop join of left.leftColumn == right.rightColumn
+/// At least one column must have a BPTree. When both do larger side is the inner one
+bool indexNestedLoopJoin(Table* left, int32_t leftColumn, Table* right, int32_t rightColumn, JoinBatch& output);
+
+/// Cheapest method for left.leftColumn == right.rightColumn
+JoinMethod chooseJoinMethod(Table* left, int32_t leftColumn, Table* right, int32_t rightColumn);
+
+#include "../Join.cpp"
+
+#endif //DBMS_JOIN_H
@@ -0,0 +1,70 @@
+#ifndef DBMS_LEXER_H
+#define DBMS_LEXER_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// Lexer splits a statement into tokens on demand in a single pass over its text
+/// Tokens are views into the text so nothing is copied until parser keeps a field
+/// Text must outlive every token taken from it
+
+/// ---------------- TOKENS ----------------
+/// 1. Word   => run of characters other than spaces, quotes and symbols. Keywords, names, numbers, * and ?
+/// 2. String => "<text>". Token text is without quotes
+/// 3. File   => '<text>'. Token text is without quotes
+/// 4. Symbol => { } ( ) , : = == != < > <= >= && || ! or another pair of = ! < > followed by = < >
+/// 5. Error  => quote which is not closed, or single & or |
+/// Values are read with value() which ends an unquoted value only at , & | } ) or space
+/// so that they may hold characters which are symbols elsewhere
+
+#include <string_view>
+#include <cstddef>
+
+enum class TokenType{
+    word,
+    string,
+    file,
+    symbol,
+    end,
+    error
+};
+
+struct Token{
+    TokenType type{TokenType::end};
+    std::string_view text;
+    size_t offset{};                    // Position of token in text
+
+    /// Word or symbol spelled exactly as text
+    inline bool is(std::string_view text_) const{
+        return (type == TokenType::word || type == TokenType::symbol) && text == text_;
+    }
+};
+
+class Lexer{
+    std::string_view input;
+    size_t position;
+
+public:
+    explicit Lexer(std::string_view input_);
+
+    Token next();
+
+    /// Next token without consuming it
+    Token peek();
+
+    /// Consumes next token only when it is word or symbol text
+    bool accept(std::string_view text);
+
+    /// Quoted string or unquoted run of characters up to , & | } ) or space. Empty word when there is none
+    Token value();
+
+    /// Nothing but spaces left
+    bool atEnd();
+
+    /// Text after current position without leading spaces
+    std::string_view rest();
+
+private:
+    void skipSpaces();
+    Token quoted(TokenType type, char quote);
+};
+
+#endif //DBMS_LEXER_H
@@ -0,0 +1,140 @@
+#ifndef DBMS_LOADER_H
+#define DBMS_LOADER_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// Inserts many rows into a table at once
+/// 1. ChunkReader    => reads input file in LOAD_CHUNK_SIZE pieces cut at record boundaries
+/// 2. ParallelLoader => parses chunks on a pool of threads into encoded rows and hands them to
+///                      a BulkLoader in file order so that slots and pkeys follow input order
+/// 3. BulkLoader     => copies encoded rows straight into heap pages, filling slots of deleted rows first
+///                      Pages past last used slot are gathered and written LOAD_WRITE_PAGES at a time
+///                      Header is written once at the end and (cell, pkey, row) of every indexed column
+///                      is collected in runs of LOAD_RUN_ROWS. Runs are sorted on their own threads and
+///                      merged so that each BPTree is built or updated in key order afterwards
+
+/// ---------------- PIPELINE ----------------
+/// Worker takes next chunk from reader, parses it and leaves it for calling thread which writes
+/// chunks in order. Workers wait while LOAD_CHUNKS_PER_THREAD chunks per thread are ahead of writer
+/// so that memory stays bounded when parsing outruns writing
+/// Rows before a bad record stay loaded and nothing after it is written
+
+/// ---------------- CSV ----------------
+/// Fields are separated by ',' and records by '\n'. '\r\n' and empty lines are accepted
+/// Quoted field may hold ',', newlines and "" for a quote
+
+/// ---------------- BINARY ----------------
+/// Rows laid out like on page without pkey, i.e. cells of all columns back to back
+/// Strings are null padded to width of column and bools are 0 or 1
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "Table.h"
+#include "RowCodec.h"
+#include "Constants.h"
+
+const int64_t LOAD_CHUNK_SIZE        = (1 << 22);                       // Bytes read from file at once
+const int32_t LOAD_CHUNKS_PER_THREAD = 2;
+const int32_t LOAD_WRITE_PAGES       = 256;                             // New heap pages written at once
+const int32_t LOAD_RUN_ROWS          = (1 << 18);                       // Index entries sorted together
+
+enum class LoadFormat{
+    csv,
+    binary
+};
+
+enum class LoadResult{
+    success,
+    cannotOpen,
+    readError,
+    writeError,
+    malformed,                          // Quote was not closed or binary file ends inside a row
+    columnCountMismatch,
+    invalidValue
+};
+
+/// Records of input file handed to one parse thread
+struct LoadChunk{
+    int64_t sequence;
+    int64_t firstLine;                  // Line of first record. Record number for binary
+    std::vector<char> data;
+
+    // Parse output
+    std::vector<char> rows;             // Encoded rows without pkey
+    int32_t count = 0;
+    LoadResult result = LoadResult::success;
+    int64_t errorLine = 0;
+    int32_t fieldCount = 0;             // Fields of record with wrong number of them
+    CodecResult codecResult = CodecResult::success;
+};
+
+class ChunkReader{
+    int fileDescriptor;
+    LoadFormat format;
+    int32_t recordSize;
+    std::vector<char> carry;            // Bytes after last whole record of previous chunk
+    int64_t nextLine;
+    bool endOfFile;
+
+public:
+    ChunkReader(const std::string& fileName, LoadFormat format_, int32_t recordSize_);
+    ~ChunkReader();
+
+    bool isOpen() const;
+
+    /// Fills data and firstLine of chunk. false at end of file or when read fails
+    bool next(LoadChunk& chunk, bool& failed);
+};
+
+class BulkLoader{
+    Table* table;
+    int32_t rowsPerPage;
+    int32_t rowSize;
+    row_t freeRows;                     // Slots of deleted rows still to be filled
+    row_t endSlot;                      // Slot after last used one
+    pkey_t nextPKey;
+    row_t count;
+    Page* page;                         // Page rows are being written to
+
+    // Pages which held no row before load. Written around pager
+    int32_t firstNewPage;
+    std::unique_ptr<char[]> run;
+    int32_t runStart;
+    int32_t runPages;
+
+    std::vector<std::vector<std::vector<char>>> entries;    // Runs of | cell | pkey | row | of every indexed column
+
+public:
+    explicit BulkLoader(Table* table_);
+
+    /// Copies row whose columns are encoded and gives it next pkey
+    bool append(const char* row);
+
+    /// Writes pages and header and builds indexes. Must be called even if append failed
+    bool finish();
+
+    row_t rowCount() const;
+
+private:
+    bool flushRun();
+};
+
+class ParallelLoader{
+    Table* table;
+    row_t count;
+
+public:
+    // Set when run() fails on a record
+    int64_t errorLine;
+    int32_t fieldCount;
+    CodecResult codecResult;
+
+    explicit ParallelLoader(Table* table_);
+
+    /// Loads every record of file. header skips first record of a CSV file
+    LoadResult run(const std::string& fileName, LoadFormat format, bool header);
+
+    row_t rowCount() const;
+};
+
+#endif //DBMS_LOADER_H
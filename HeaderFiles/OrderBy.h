@@ -0,0 +1,79 @@
+#ifndef DBMS_ORDERBY_H
+#define DBMS_ORDERBY_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// Produces rows of a select in order of one column
+/// Rows are handed over one at a time so that caller can stop as soon as limit is reached
+/// 1. Index Order => leaf chain of BPTree on column. Descending order walks it back through leftSibling_
+/// 2. Top-N       => with limit only limit rows are kept in a bounded heap while table is scanned
+/// 3. Sort        => SortedRun of whole table which spills to ExternalSort over JOIN_MEMORY_BUDGET
+
+/// ---------------- COST MODEL ----------------
+/// Index Order => cost of index scan on column, scaled down to fraction of it read before limit
+/// Top-N       => cheapest scan + matches * log2(limit) * CPU_ROW_COST + limit * RANDOM_PAGE_COST
+/// Sort        => heap pages * SEQ_PAGE_COST (3 times when external) + rows * log2(rows) * CPU_ROW_COST
+///              + fetched pages * RANDOM_PAGE_COST
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "Table.h"
+#include "RowBatch.h"
+#include "Planner.h"
+#include "Aggregate.h"
+#include "Join.h"
+
+enum class OrderStrategy{
+    indexOrder,
+    topN,
+    sort
+};
+
+class OrderPlan{
+public:
+    OrderStrategy strategy;
+    Plan scan;                          // Index scan for index order, scan feeding heap for top-N
+    double cost;
+
+    OrderPlan();
+
+    /// One line description like `Top-N Sort on a (limit=10 cost=12.00)`
+    std::string describe(Table* table, int32_t column, bool descending, int64_t limit) const;
+};
+
+/// Keeps k first rows in output order seen so far
+/// Root of heap is the kept row which would be printed last so it is the one replaced
+class TopK{
+    std::vector<std::pair<OwnedValue, row_t>> heap;
+    int64_t k;
+    bool descending;
+
+public:
+    TopK(int64_t k_, bool descending_);
+
+    void push(const Value& value, row_t row);
+
+    /// Kept rows in output order. Empties heap
+    std::vector<row_t> sorted();
+
+private:
+    bool before(const std::pair<OwnedValue, row_t>& a, const std::pair<OwnedValue, row_t>& b) const;
+};
+
+class OrderBy{
+public:
+    /// Cheapest way of ordering on column. plans are from Planner::enumerate
+    /// limit is -1 when there is none
+    static OrderPlan choose(Table* table, int32_t column, int64_t limit, const std::vector<Plan>& plans);
+
+    /// Callback gets rows in order. Returning false stops
+    /// Only top-N applies filter itself. Rows of other strategies must still be filtered by caller
+    /// columns are columns of caller's batch and position is place of column in them
+    static bool execute(Table* table, int32_t column, bool descending, int64_t limit, const OrderPlan& plan,
+                        const std::vector<int32_t>& columns, int32_t position,
+                        const Filter& filter, const std::function<bool(row_t row)>& callback);
+};
+
+#include "../OrderBy.cpp"
+
+#endif //DBMS_ORDERBY_H
@@ -5,6 +5,7 @@
 /// Pager directly deals with File IO
 /// It can read/write given page in a file
 /// It also maintains a cache of recently used pages
+/// With a WriteAheadLog pages are written to log instead of file and read back from it until next checkpoint
 
 #include <cstdio>
 #include <cstdlib>
@@ -13,28 +14,50 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <cerrno>
+#include <stdexcept>
 #include <memory>
 #include <unordered_map>
 #include <functional>
+#include <initializer_list>
 #include <queue>
 #include <list>
 #include "Constants.h"
+#include "WriteAheadLog.h"
 
 class Page{
 public:
     std::unique_ptr<char[]> buffer;
     bool hasUncommitedChanges;
     int32_t pageNum;
+    int32_t pinCount;                   // Pages held by pointer across other reads. Never evicted
 
     Page(){
         buffer = std::make_unique<char[]>(PAGE_SIZE);
         hasUncommitedChanges = false;
         pageNum = 0;
-        printf("Page Created\n");
+        pinCount = 0;
+    }
+};
+
+/// Pins pages for its lifetime so that reading other pages can't evict them
+class PinGuard{
+    Page* pages[4];
+    int32_t count;
+
+public:
+    PinGuard(std::initializer_list<Page*> pages_){
+        count = 0;
+        for(Page* page: pages_) add(page);
+    }
+
+    ~PinGuard(){
+        for(int32_t i = 0; i < count; ++i) --pages[i]->pinCount;
     }
 
-    ~Page(){
-        printf("Page Destructed\n");
+    void add(Page* page){
+        if(page == nullptr) return;
+        ++page->pinCount;
+        pages[count++] = page;
     }
 };
 
@@ -49,15 +72,34 @@ protected:
     int32_t maxPages;                   // Maximum number of pages this file has
     std::unordered_map<int32_t, iterator_t> pageMap;
     list_t pageQueue;
-    bool open(const char* fileName);
+    WriteAheadLog* log;                 // nullptr when pages go straight to file
+    uint32_t logFile;                   // Id of file in log
+    bool open(const char* fileName, WriteAheadLog* log_ = nullptr, int64_t logOwner = -1);
+    void evictPage();
+
+    /// Pages of file counting those held by log. Sets maxPages and fileLength
+    int32_t pageCount();
+
+    /// Reads page from log, or from file when log holds none. Pages past end are left as they are
+    bool readPage(int32_t pageNum, char* buffer);
+    bool writePage(int32_t pageNum, const char* buffer);
+
+    /// Called on least recently used page before it is evicted
+    /// Returning false keeps the page in cache for one more round
+    /// It must return true when the same page comes up again untouched
+    virtual bool canEvict(page_t* page);
 
 public:
     std::unique_ptr<page_t> header;
 
     explicit Pager(int pageLimit_ = DEFAULT_PAGE_LIMIT);
-    Pager(const char* fileName, int pageLimit_ = DEFAULT_PAGE_LIMIT);
+    /// logOwner is id of file whose commits cover this one, -1 for file itself
+    Pager(const char* fileName, WriteAheadLog* log_ = nullptr, int64_t logOwner = -1, int pageLimit_ = DEFAULT_PAGE_LIMIT);
     ~Pager();
 
+    /// Id of file in log. Index files of a table pass id of its heap file as owner to open()
+    uint32_t getLogFile() const;
+
     int64_t getFileLength();
     bool getHeader();
     bool close();
@@ -65,6 +107,20 @@ public:
     virtual bool flushPage(page_t* page);
     bool flushAll();
 
+    /// Writes header and cached pages only when they changed
+    bool flushChanges();
+
+    /// Copies pages held by log into file so that it can be read around pager. Changes must be committed
+    bool writeBack();
+
+    /// Drops cached pages and cuts file down to its first pages pages
+    /// Header is kept in memory and must be rewritten by caller
+    bool truncate(int32_t pages);
+
+    /// Writes pages consecutive pages starting at firstPage with one call, bypassing cache
+    /// Cached copies of them are dropped so pages must not be pinned or hold other changes
+    bool writeRun(int32_t firstPage, const char* data, int32_t pages);
+
     page_t* read(uint32_t pageNum, std::function<void(page_t*)> callback = nullptr);
 };
 
@@ -0,0 +1,113 @@
+#ifndef DBMS_PLANNER_H
+#define DBMS_PLANNER_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// Planner picks how rows of a single table are read for a where clause
+/// Heap scan and a scan of every index in Table::trees are costed and the cheapest one is used
+/// Costs are in units of one sequential page read
+
+/// ---------------- COST MODEL ----------------
+/// Heap Scan  => pages * SEQ_PAGE_COST + slots * CPU_ROW_COST
+/// Index Scan => (height + leaf pages) * RANDOM_PAGE_COST
+///             + fetched heap pages * RANDOM_PAGE_COST + matches * CPU_ROW_COST
+/// Every match is one Cursor::value() so heap pages are fetched once per match
+/// unless whole table fits in page cache
+/// Bitmap Scan => sum of bitmap index scans ((height + leaf pages) * RANDOM_PAGE_COST + rows * CPU_ROW_COST)
+///              + min(bitmap rows, heap pages) * RANDOM_PAGE_COST + bitmap rows * CPU_ROW_COST
+/// Rows of a bitmap are fetched in row order so every heap page is read at most once
+
+/// ---------------- BITMAP SCAN ----------------
+/// Used for conditions over several indexed columns and for disjunctions
+/// Row numbers found by index scans are collected in RowBitmaps which are intersected for &&
+/// and united for ||. An index scan joins an intersection only when heap pages it saves
+/// are worth more than scanning it. A disjunction needs an index scan for every branch
+
+#include <string>
+#include <vector>
+#include "Table.h"
+#include "RowBatch.h"
+#include "RowBitmap.h"
+#include "Constants.h"
+
+const double SEQ_PAGE_COST = 1.0;
+const double RANDOM_PAGE_COST = 4.0;
+const double CPU_ROW_COST = 0.01;
+
+/// Used when column has no stats (as in empty table)
+const double DEFAULT_EQUAL_SELECTIVITY = 0.005;
+const double DEFAULT_RANGE_SELECTIVITY = 0.33;
+
+enum class AccessPath{
+    heapScan,
+    indexScan,
+    bitmapScan
+};
+
+enum class BitmapOp{
+    indexScan,
+    intersect,
+    unite
+};
+
+/// Tree of index scans whose rows are combined in a RowBitmap
+class BitmapPlan{
+public:
+    BitmapOp op;
+    int32_t index;                      // Column whose tree is scanned
+    std::vector<ColumnPredicate> bounds;    // Predicates on index column
+    int32_t low;                        // Position of bounding predicates in bounds. -1 when open
+    int32_t high;
+    std::vector<BitmapPlan> children;
+    double rows;
+    double cost;
+
+    BitmapPlan();
+
+    /// Appends one line per node, indented by depth
+    void describe(Table* table, int32_t depth, std::string& out) const;
+};
+
+class Plan{
+public:
+    AccessPath path;
+    int32_t index;                      // Column whose tree is scanned
+    int32_t low;                        // Predicates bounding index scan. -1 when open
+    int32_t high;
+    BitmapPlan bitmap;                  // Only for bitmap scan
+    double rows;
+    double cost;
+
+    Plan();
+
+    /// One line description like `Index Scan using a on t (cost=12.00 rows=3)`
+    /// Bitmap scan is followed by a line for every node of its bitmap
+    std::string describe(Table* table) const;
+};
+
+class Planner{
+public:
+    /// Plans of every access path. First one is cheapest
+    static std::vector<Plan> enumerate(Table* table, const Filter& filter);
+
+    static Plan choose(Table* table, const Filter& filter);
+
+    /// Runs plan and calls callback on every row it produces
+    /// Heap scan filters rows itself but index and bitmap scans only narrow them down
+    /// so caller still has to apply filter
+    /// Index scan produces rows in key order, reversed when descending. Bitmap scan in row order
+    static bool execute(Table* table, const Plan& plan, const Filter& filter, const std::function<bool(row_t row)>& callback, bool descending = false);
+
+private:
+    static double selectivity(Table* table, const std::vector<ColumnPredicate>& predicates);
+    static double selectivity(Table* table, const FilterNode& node);
+
+    /// Positions of predicates on column which bound a scan of its tree
+    static void bounds(const std::vector<ColumnPredicate>& predicates, int32_t column, int32_t& low, int32_t& high);
+
+    /// false when node can't be answered from indexes
+    static bool bitmapPlan(Table* table, const FilterNode& node, BitmapPlan& plan);
+    static bool bitmapIndexScan(Table* table, const std::vector<ColumnPredicate>& predicates, int32_t column, BitmapPlan& plan);
+    static bool buildBitmap(Table* table, const BitmapPlan& plan, RowBitmap& bitmap);
+};
+
+#endif //DBMS_PLANNER_H
@@ -0,0 +1,61 @@
+#ifndef DBMS_PROTOCOL_H
+#define DBMS_PROTOCOL_H
+
+/// ---------------- PROTOCOL DESCRIPTION ----------------
+/// Wire format spoken between `DBMS --server` and its clients over a Unix-domain or loopback TCP socket
+/// Every message is | length (uint32) | type (uint8) | payload | where length counts type and payload
+/// Integers are in native byte order since both ends run on the same host
+
+/// ---------------- CONVERSATION ----------------
+/// Client sends query messages. Server answers each with, in order
+/// 1. columns => | count (uint32) | length (uint32) | name | ... |. Only for statements that return rows
+/// 2. rows    => rows as written by `.mode binary`, streamed in pieces of about SERVER_BATCH_SIZE bytes
+/// 3. done    => | status (uint8) | message |. status is 0 when statement succeeded
+///               message tells why statement failed, or what it reported when it succeeded
+/// explain and analyze answer with rows like select
+/// Queries sent before done arrives are queued and answered in order
+
+/// ---------------- ADDRESSES ----------------
+/// unix:<path>  => Unix-domain socket at path
+/// <port>       => TCP on 127.0.0.1:<port>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+const uint32_t MESSAGE_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint8_t);
+const uint32_t MAX_MESSAGE_SIZE    = (1 << 24);             // Longest query accepted
+const size_t   SERVER_BATCH_SIZE   = (1 << 16);             // Row bytes sent in one rows message
+
+enum class MessageType: uint8_t{
+    // Client to server
+    query   = 1,
+
+    // Server to client
+    columns = 16,
+    rows    = 17,
+    done    = 18
+};
+
+enum class MessageStatus: uint8_t{
+    success = 0,
+    failure = 1
+};
+
+/// Appends message of type holding payload to out
+inline void appendMessage(std::string& out, MessageType type, const char* payload, size_t length){
+    auto total = static_cast<uint32_t>(length + sizeof(uint8_t));
+    out.append(reinterpret_cast<const char*>(&total), sizeof(uint32_t));
+    out.push_back(static_cast<char>(type));
+    out.append(payload, length);
+}
+
+/// Length field of message starting at data, which must hold MESSAGE_HEADER_SIZE bytes
+/// Message is complete once sizeof(uint32_t) + length bytes have arrived
+inline uint32_t messageLength(const char* data){
+    uint32_t length;
+    memcpy(&length, data, sizeof(uint32_t));
+    return length;
+}
+
+#endif //DBMS_PROTOCOL_H
@@ -0,0 +1,117 @@
+#ifndef DBMS_RESULTSINK_H
+#define DBMS_RESULTSINK_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// ResultSink is where every result row of a statement ends up
+/// Rows are formatted into a RESULT_BUFFER_SIZE buffer which is written out only when it fills
+/// and once at the end of statement, so output never costs a write per row
+/// Output goes to stdout unless a file is opened with `.output <file-name>`
+/// Batch mode defers flushes so that rows of a whole script leave stdio buffer together
+/// Library connections and server sessions capture output instead. Rows are handed to a consumer
+/// every batchSize bytes, which keeps them in memory for ResultSet or streams them to a client
+
+/// ---------------- FORMATS ----------------
+/// Chosen with `.mode <pretty|csv|tsv|binary>`
+/// 1. Pretty => `val | val | ` per line. Default
+/// 2. CSV    => header line of column names, fields quoted when they hold ',', '"' or newlines
+/// 3. TSV    => header line of column names, '\t', '\n', '\r' and '\\' escaped with '\\'
+/// 4. Binary => | row length (uint32) | cells | per row, native byte order
+///              Every cell is a one byte tag followed by its value
+///              null => nothing, int => int32, float => float, char => char, bool => one byte,
+///              string => uint32 length and bytes, bigint => int64, double => double
+/// Floats are printed with 6 decimals by pretty and with all significant digits by CSV and TSV
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <functional>
+#include "RowBatch.h"
+#include "RowCodec.h"
+#include "DataTypes.h"
+
+const int64_t RESULT_BUFFER_SIZE = (1 << 20);
+
+enum class OutputFormat{
+    pretty,
+    csv,
+    tsv,
+    binary
+};
+
+enum class CellTag: uint8_t{
+    null,
+    int32,
+    float32,
+    character,
+    boolean,
+    string,
+    int64,
+    float64
+};
+
+/// Format named in `.mode`. false when there is no such format
+bool findOutputFormat(const std::string& name, OutputFormat& format);
+
+class ResultSink{
+    OutputFormat format;
+    FILE* file;                         // stdout when no file is open
+    std::string buffer;
+    size_t rowStart;                    // Offset of current row in buffer
+    int32_t cells;                      // Cells of current row so far
+    bool failed;
+    bool deferred;                      // flush() hands rows to stdio without flushing file
+    std::function<bool(const char* data, size_t length)> consumer;     // Receives output instead of file when set
+    size_t batchSize;                   // Buffered bytes which are written out as soon as a row ends
+    std::vector<std::string> columns;   // Names given to begin(). Kept only while capturing
+
+public:
+    ResultSink();
+    ~ResultSink();
+
+    OutputFormat getFormat() const;
+    void setFormat(OutputFormat format_);
+    void setDeferred(bool deferred_);
+
+    /// Sends output to fileName, which is truncated. Empty name sends it back to stdout
+    bool open(const std::string& fileName);
+
+    /// Hands output to consumer_ in pieces of about batchSize_ bytes instead of writing it to file
+    /// A consumer returning false fails the statement. nullptr writes to file again
+    void capture(std::function<bool(const char* data, size_t length)> consumer_, size_t batchSize_ = RESULT_BUFFER_SIZE);
+    const std::vector<std::string>& columnNames() const;
+
+    /// Starts output of a statement. CSV and TSV print names as a header line
+    void begin(const std::vector<std::string>& names);
+
+    inline void beginRow(){
+        rowStart = buffer.size();
+        cells = 0;
+        if(format == OutputFormat::binary) buffer.append(sizeof(uint32_t), '\0');
+    }
+
+    void value(const Value& value);
+    void text(const std::string& value);
+    void integer(int64_t value);
+    void real(double value);
+    void null();
+
+    void endRow();
+
+    /// Every selected row of batch with columns at positions
+    void write(const RowBatch& batch, const std::vector<int32_t>& positions);
+
+    /// Every column of row stored in page as cells of current row
+    void values(const RowCodec& codec, const char* row);
+
+    /// Writes out buffered rows. false if any write of this statement failed
+    /// When deferred, rows are only handed to stdio and file is flushed once deferring stops
+    bool flush();
+
+private:
+    void writeOut();
+    void separator();
+    void appendText(const char* text, size_t length);
+    void appendTag(CellTag tag, const void* data, size_t length);
+};
+
+#endif //DBMS_RESULTSINK_H
@@ -0,0 +1,171 @@
+#ifndef DBMS_ROWBATCH_H
+#define DBMS_ROWBATCH_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// RowBatch carries up to BATCH_SIZE rows between executor operators
+/// Rows are stored column wise. Int, Float, Char and Bool are decoded in typed arrays
+/// and Strings are stored in single character buffer indexed by offsets
+/// Operators never copy rows. They only narrow down the selection vector
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "Table.h"
+#include "DataTypes.h"
+#include "Constants.h"
+
+const int32_t BATCH_SIZE = 1024;
+
+class ColumnVector{
+public:
+    DataType type;
+    int32_t column;                     // Column number in table
+    int32_t width;                      // Bytes occupied by this column in a row
+
+    std::vector<int32_t> ints;
+    std::vector<float> floats;
+    std::vector<char> chars;            // Char and Bool
+    std::vector<int32_t> offsets;       // String i is data[offsets[i], offsets[i+1])
+    std::vector<char> data;
+
+    ColumnVector(DataType type_, int32_t column_, int32_t width_);
+
+    void clear();
+
+    /// Decodes one cell from row stored in page
+    void append(const char* cell);
+
+    /// Text form used while printing results
+    void appendText(int32_t i, std::string& out) const;
+
+    /// Typed value of entry i. Strings point inside this vector
+    Value get(int32_t i) const;
+};
+
+class RowBatch{
+public:
+    std::vector<ColumnVector> columns;
+    row_t rows[BATCH_SIZE];             // Row in table of every entry
+    int32_t selection[BATCH_SIZE];      // Positions which passed all operators so far
+    int32_t size;
+    int32_t selected;
+
+    RowBatch() = default;
+    RowBatch(Table* table, const std::vector<int32_t>& columns_);
+
+    void clear();
+};
+
+/// Single comparison of a column against a constant
+/// Constant is converted to column type once and then compared in a tight loop over the batch
+class ColumnPredicate{
+public:
+    int32_t column;                     // Column number in table
+    int32_t position;                   // Position of column in batch
+    ComparisonType op;
+    DataType type;
+    int32_t width;                      // Bytes occupied by column in a row
+
+    int32_t intValue;
+    float floatValue;
+    char charValue;
+    std::string stringValue;
+    std::string cell;                   // Constant laid out like a cell of this column
+
+    /// Converts value to column type once
+    CodecResult compile(Table* table, int32_t column_, ComparisonType op_, const std::string& value);
+
+    /// Removes rows which do not satisfy this predicate from batch selection
+    void apply(RowBatch& batch) const;
+
+    /// Same as apply but on rows still lying in page
+    /// Column is read from first count rows of page. Only positions in selection are kept
+    int32_t applyPage(const char* page, int32_t count, int32_t rowSize, int32_t offset, int32_t* selection, int32_t selected) const;
+};
+
+enum class FilterType{
+    predicate,
+    conjunction,                        // Every child holds
+    disjunction                         // Any child holds
+};
+
+/// Node of a where clause in negation normal form
+/// Negations are already folded into comparisons so only && and || are left
+class FilterNode{
+public:
+    FilterType type;
+    ColumnPredicate predicate;          // Only for predicate
+    std::vector<FilterNode> children;
+
+    FilterNode();
+
+    /// Removes rows which do not satisfy this node from batch selection
+    void apply(RowBatch& batch) const;
+
+    /// Same as apply but on rows still lying in page. Returns count of positions kept in selection
+    int32_t applyPage(const char* page, int32_t count, int32_t rowSize, const RowCodec& codec, int32_t* selection, int32_t selected) const;
+
+    /// Sets position of every predicate, adding its column to columns when missing
+    void bind(std::vector<int32_t>& columns);
+};
+
+/// Compiled where clause
+/// Comparisons joined by top level && are kept apart as predicates. They bound index scans
+/// and are evaluated first. Disjunctions are residual and evaluated on rows left after them
+class Filter{
+public:
+    std::vector<ColumnPredicate> predicates;
+    std::vector<FilterNode> residual;
+
+    /// Adds node as one more conjunct
+    void add(FilterNode node);
+
+    bool empty() const;
+
+    /// Whole filter as one conjunction
+    FilterNode root() const;
+
+    void bind(std::vector<int32_t>& columns);
+    void apply(RowBatch& batch) const;
+    int32_t applyPage(const char* page, int32_t count, int32_t rowSize, const RowCodec& codec, int32_t* selection, int32_t selected) const;
+};
+
+/// Returns position of column in batch, adding it if not already present
+int32_t addColumn(std::vector<int32_t>& columns, int32_t column);
+
+/// Source operator of the pipeline
+/// Rows are pushed one by one (usually from BPTree traversal) and decoded straight
+/// from their pages. Every full batch is handed over to consumer.
+class BatchScanner{
+    Table* table;
+    RowBatch batch;
+    std::vector<int32_t> columnOffsets;
+    std::function<bool(RowBatch&)> consumer;
+
+    Page* page;
+    int32_t pageNum;
+
+public:
+    BatchScanner(Table* table_, const std::vector<int32_t>& columns, std::function<bool(RowBatch&)> consumer_);
+
+    /// false -> consumer asked to stop or page could not be read
+    bool push(row_t row);
+
+    /// Hands over partially filled batch
+    bool flush();
+};
+
+/// Source operator which reads table pages sequentially
+/// Deleted rows are skipped and filter is evaluated on rows while they
+/// are still in page, so only matching rows are passed on
+class HeapScanner{
+    Table* table;
+
+public:
+    explicit HeapScanner(Table* table_);
+
+    /// false -> callback asked to stop or page could not be read
+    bool scan(const Filter& filter, const std::function<bool(row_t row)>& callback);
+};
+
+#endif //DBMS_ROWBATCH_H
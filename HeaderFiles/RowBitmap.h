@@ -0,0 +1,52 @@
+#ifndef DBMS_ROWBITMAP_H
+#define DBMS_ROWBITMAP_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// Sorted set of row numbers laid out like a roaring bitmap
+/// High 16 bits of a row pick a container and low 16 bits are stored in it
+/// 1. Array container  => sorted low bits while container holds at most BITMAP_ARRAY_LIMIT rows
+/// 2. Bitset container => one bit for each of 2^16 rows once it holds more
+/// Containers are kept in order of high bits so rows are visited in ascending order,
+/// which is also order of heap pages
+
+#include <vector>
+#include <functional>
+#include "Constants.h"
+
+const int32_t BITMAP_ARRAY_LIMIT = 4096;                 // Past this an array is larger than a bitset
+const int32_t BITMAP_WORDS       = (1 << 16) / 64;
+
+class RowBitmap{
+    struct Container{
+        uint16_t key;                   // High 16 bits of rows
+        int32_t cardinality;
+        std::vector<uint16_t> values;   // Array container
+        std::vector<uint64_t> bits;     // Bitset container. Empty for array container
+
+        inline bool isBitset() const{ return !bits.empty(); }
+    };
+    std::vector<Container> containers;
+
+public:
+    RowBitmap() = default;
+
+    /// Rows may come in any order and repeat
+    explicit RowBitmap(std::vector<row_t> rows);
+
+    RowBitmap intersect(const RowBitmap& other) const;
+    RowBitmap unite(const RowBitmap& other) const;
+
+    int64_t cardinality() const;
+    bool empty() const;
+
+    /// Calls callback on every row in ascending order. Returning false stops
+    bool forEach(const std::function<bool(row_t row)>& callback) const;
+
+private:
+    static Container intersect(const Container& a, const Container& b);
+    static Container unite(const Container& a, const Container& b);
+    static void toBitset(Container& container);
+    static void toArray(Container& container);
+};
+
+#endif //DBMS_ROWBITMAP_H
@@ -0,0 +1,120 @@
+#ifndef DBMS_ROWCODEC_H
+#define DBMS_ROWCODEC_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// RowCodec knows binary layout of rows of a table
+/// It is generated once from schema and keeps offset of every column
+/// Cells are read and written with memcpy at precomputed offsets
+/// Text is only produced/parsed at client boundary (parse, appendText)
+
+/// ---------------- ROW LAYOUT ----------------
+/// | col-1 | col-2 | ... | col-n | pkey |
+/// Strings occupy their declared size and are null terminated only if shorter
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <cerrno>
+#include <cstdlib>
+#include "DataTypes.h"
+#include "Constants.h"
+
+enum class CodecResult{
+    success,
+    typeMismatch,
+    stringTooLarge
+};
+
+/// Typed value of a single cell
+/// Strings are not copied. stringValue points to row bytes or to parsed text
+class Value{
+public:
+    DataType type;
+    union{
+        int32_t intValue;
+        float floatValue;
+        char charValue;
+        bool boolValue;
+    };
+    const char* stringValue;
+    int32_t stringSize;
+
+    Value();
+
+    /// Reads cell of given type stored at cell
+    static Value read(DataType type, const char* cell, int32_t width);
+
+    /// Writes this value in cell of given width
+    void write(char* cell, int32_t width) const;
+
+    /// <0, 0, >0 like strcmp. Both values must be of same type
+    int compare(const Value& other) const;
+
+    void appendText(std::string& out) const;
+};
+
+class RowCodec{
+public:
+    std::vector<DataType> types;
+    std::vector<int32_t> sizes;
+    std::vector<int32_t> offsets;
+    int32_t pkeyOffset;
+    int32_t rowSize;
+
+    RowCodec();
+    RowCodec(const std::vector<DataType>& types_, const std::vector<uint32_t>& sizes_);
+
+    int32_t columnCount() const;
+
+    inline const char* cell(const char* row, int32_t col) const{
+        return row + offsets[col];
+    }
+
+    inline Value get(const char* row, int32_t col) const{
+        return Value::read(types[col], row + offsets[col], sizes[col]);
+    }
+
+    inline void set(char* row, int32_t col, const Value& value) const{
+        value.write(row + offsets[col], sizes[col]);
+    }
+
+    inline pkey_t getPKey(const char* row) const{
+        pkey_t pkey;
+        memcpy(&pkey, row + pkeyOffset, sizeof(pkey_t));
+        return pkey;
+    }
+
+    inline void setPKey(char* row, pkey_t pkey) const{
+        memcpy(row + pkeyOffset, &pkey, sizeof(pkey_t));
+    }
+
+    /// Client boundary: text -> typed value of column col
+    /// For strings value points inside text so text must outlive value
+    CodecResult parse(int32_t col, const std::string& text, Value& value) const;
+
+    /// Same as above for text of length bytes which must be followed by '\0'
+    CodecResult parse(int32_t col, const char* text, int32_t length, Value& value) const;
+
+    /// Client boundary: text of all columns -> row bytes
+    CodecResult encode(const std::vector<std::string>& data, char* row) const;
+
+    /// Client boundary: typed value of column col -> text
+    void appendText(const char* row, int32_t col, std::string& out) const;
+};
+
+/// Row detached from any page. Owns bytes laid out exactly like a row on page
+class Row{
+public:
+    const RowCodec* codec;
+    std::unique_ptr<char[]> buffer;
+
+    explicit Row(const RowCodec& codec_);
+
+    inline char* data(){ return buffer.get(); }
+    inline Value get(int32_t col) const{ return codec->get(buffer.get(), col); }
+    inline void set(int32_t col, const Value& value){ codec->set(buffer.get(), col, value); }
+};
+
+#endif //DBMS_ROWCODEC_H
@@ -0,0 +1,109 @@
+#ifndef DBMS_STATISTICS_H
+#define DBMS_STATISTICS_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// TableStats keeps per column statistics used by Planner to estimate
+/// how many rows a predicate selects. They are built by `analyze <table>` with one
+/// heap scan and persisted in <baseURL>/<table-name>.stats so that planning never scans
+/// Inserts and deletes adjust them in place. They are rebuilt only when
+/// modifications since last analyze exceed STATS_STALE_FRACTION of rows
+/// Values (min, max, histogram bounds, MCVs) are kept as cell bytes of their column
+
+/// ---------------- FILE LAYOUT ----------------
+/// | version | numRows | modified | column count | column-1 | column-2 | ... |
+/// column => | type | width | count | distinct | null fraction | min | max |
+///           | bucket count | bound-1 | ... | mcv count | mcv-1 | mcv-1 count | ... |
+/// Every value is stored as | length | bytes |
+
+#include <string>
+#include <vector>
+#include "DataTypes.h"
+#include "RowCodec.h"
+#include "Constants.h"
+
+class Table;
+
+const int32_t STATS_VERSION = 2;
+const int32_t HISTOGRAM_BUCKETS = 32;
+
+/// At most these many values are kept as most common values.
+/// A value must occur more than once to be one
+const int32_t MCV_COUNT = 10;
+
+/// Stats are collected again when rows modified since analyze exceed this fraction
+const double STATS_STALE_FRACTION = 0.2;
+
+class ColumnStats{
+public:
+    DataType type;
+    int32_t width;
+    row_t count;
+    row_t distinct;
+
+    /// Rows never store NULL yet so this is always 0
+    /// Kept so that estimates and file layout don't change once they do
+    double nullFraction;
+    std::string min;
+    std::string max;
+
+    /// Equi-depth histogram. bounds[i] is largest value of bucket i
+    /// and every bucket holds count/bounds.size() rows
+    std::vector<std::string> bounds;
+
+    /// Most common values with number of rows holding each
+    std::vector<std::string> mcvs;
+    std::vector<row_t> mcvCounts;
+
+    ColumnStats();
+
+    /// Builds stats from every value of column. cells are sorted in place
+    void build(std::vector<std::string>& cells);
+
+    /// Fraction of rows satisfying `column op cell`
+    double selectivity(ComparisonType op, const std::string& cell) const;
+
+    void recordInsert(const char* cell);
+    void recordDelete(const char* cell);
+
+    std::string text(const std::string& cell) const;
+
+private:
+    Value value(const std::string& cell) const;
+    Value value(const char* cell) const;
+    std::string key(const char* cell) const;
+
+    /// Fraction of rows strictly smaller than cell
+    double fractionBelow(const std::string& cell) const;
+    double fractionEqual(const std::string& cell) const;
+};
+
+class TableStats{
+public:
+    std::string fileName;
+    row_t numRows;
+    row_t modified;                     // Rows inserted or deleted since last analyze
+    bool dirty;                         // In memory stats differ from file
+    std::vector<ColumnStats> columns;
+
+    TableStats();
+
+    bool empty() const;
+
+    /// true when table changed enough since analyze that estimates are unreliable
+    bool isStale() const;
+
+    /// Scans heap of table once and rebuilds stats of every column
+    /// Columns are summarised in parallel
+    bool collect(Table* table);
+
+    void recordInsert(const RowCodec& codec, const char* row);
+    void recordDelete(const RowCodec& codec, const char* row);
+
+    /// Forgets column stats so that planner treats table as never analyzed
+    void clear();
+
+    bool save();
+    bool load();
+};
+
+#endif //DBMS_STATISTICS_H
@@ -9,8 +9,11 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <mutex>
 #include "Pager.h"
 #include "DataTypes.h"
+#include "RowCodec.h"
+#include "Statistics.h"
 #include "BTree.h"
 #include "Constants.h"
 
@@ -77,10 +80,19 @@ class Table{
     row_t* rowStack;
     int32_t stackSize;
 
+    /// Free row stack continues here once header page is full. Opened on first use
+    std::unique_ptr<Pager<Page>> freePager;
+
     bool tableOpen;
     std::string tableName;
+    std::string fileName;
+    WriteAheadLog* log;
 
 public:
+    /// Held by a statement for its whole run over table, guarding rows, header, pagers and trees
+    /// Statements on different tables run in parallel
+    std::mutex latch;
+
     bool tableIsIndexed;
     int32_t anyIndex;
     pkey_t nextPKey;
@@ -90,31 +102,61 @@ public:
     std::vector<uint32_t> columnSizes;
     std::map<std::string, int> columnIndex;
     std::vector<bool> indexed;
+    RowCodec codec;
+    TableStats stats;
     std::unique_ptr<Pager<Page>> pager;
+    std::string freeRowsFileName;
     std::vector<int32_t> stackPtr;
     std::vector<std::unique_ptr<BPlusTreeBase>> trees;
 
-    Table(std::string tableName, const std::string& fileName);
+    /// Pages of heap and index files go through log when it is given
+    Table(std::string tableName, const std::string& fileName, WriteAheadLog* log_ = nullptr);
     ~Table();
 
     bool close();
+
+    /// Writes pages of heap and index files changed since last call so that they can be committed
+    bool flushChanges();
     void storeMetadata();
     void loadMetadata();
     void createColumns(std::vector<std::string>&& columnNames, std::vector<DataType>&& columnTypes, std::vector<uint32_t>&& columnSizes);
 
+    /// false once table is closed or dropped
+    bool isOpen() const;
+    const std::string& getTableName() const;
+    const std::string& getFileName() const;
     int32_t getRowSize() const;
-    void increaseRowCount();
+    int32_t getRowsPerPage() const;
+    row_t getRowCount() const;
+
+    /// Number of row slots ever used. Deleted rows keep their slot until reused
+    row_t getRowSlots() const;
+
+    /// Sorted slots of deleted rows
+    bool getFreeRows(std::vector<row_t>& freeRows);
+
+    /// Adds count rows to header and hands out count pkeys
+    void increaseRowCount(row_t count = 1);
+    /// Returns -1 when free row stack can't be read
     row_t nextFreeRowLocation();
-    void addFreeRowLocation(row_t location);
+    bool addFreeRowLocation(row_t location);
     bool deleteRow(row_t row);
-    bool insertBTree(std::vector<std::string>& data, row_t row);
+
+    /// Empties table by cutting heap and index files down to their headers
+    bool truncate();
+    bool insertBTree(const char* data, row_t row);
     bool removeBTree(int index, std::string& key);
-    bool updateBTree(std::vector<std::string>& data, row_t row);
+
+    /// Moves entries of row in trees of columns whose cell differs between oldData and newData
+    bool updateBTree(const char* oldData, const char* newData, row_t row);
     Cursor start();
     Cursor end();
 
 private:
     void createColumnIndex();
+
+    /// Entry index of free row stack, from header page or free rows file past it. nullptr when it can't be read
+    row_t* freeRowEntry(row_t index, bool write);
     bool createIndex(int index, const std::string& filename);
     void calculateRowInfo();
     void serailizeColumnMetadata(char* buffer);
@@ -9,6 +9,9 @@
 #include <unordered_map>
 #include <queue>
 #include <filesystem>
+#include <shared_mutex>
+#include <thread>
+#include <condition_variable>
 #include "Table.h"
 #include "Constants.h"
 
@@ -16,10 +19,22 @@
 /// Table Manager deals with tasks like opening/closing/deleting table
 /// It can find and return required Table object from table name
 /// Usually every Database will have a single Table Manager
+/// It may be shared by threads. tableMap is guarded by catalogMutex, which is always taken before latch of any table
+/// Statements lock latch of their tables themselves through TableLatch, after open() has returned
+/// Pages of every table go through one WriteAheadLog. Changes of a statement are committed when its latch is released
+/// whether it succeeded or not, a failed statement keeps changes it made before failing
+/// Log left by a crash is replayed when manager is created. A background thread checkpoints every
+/// CHECKPOINT_INTERVAL ms, so replay never has more than about one interval of changes to redo
 
 /// ---------------- FILE NAMING SCHEME ----------------
 /// 1. Base Table => <baseURL>/<table-name>.db
 /// 2. Index on col => <baseURL>/<table-name>_<col-number>.idx
+/// 3. Column statistics => <baseURL>/<table-name>.stats
+/// 4. Write-ahead log => <baseURL>/dbms.wal
+/// 5. Free rows past header page => <baseURL>/<table-name>.free
+
+const int32_t CHECKPOINT_INTERVAL = 1000;                   // Milliseconds between background checkpoints
+const uint64_t LOG_CHECKPOINT_LIMIT = 4 * LOG_CHECKPOINT_SIZE;  // Log past this is checkpointed by statement itself
 
 enum class TableManagerResult{
     tableNotFound,
@@ -34,23 +49,51 @@ enum class TableManagerResult{
     droppingFaliure
 };
 
+/// Commits made while a statement ran. Statement is durable once position is synced
+struct StatementCommit{
+    uint64_t position = 0;
+    bool failed = false;
+};
+
 enum class TableFileType{
     indexFile,
-    baseTable
+    baseTable,
+    statistics,
+    freeRows
 };
 
 class TableManager {
+    /// Declared before tableMap so that tables are closed while log still exists. nullptr when manager failed
+    std::unique_ptr<WriteAheadLog> log;
+
     /// When Database is opened all table names are stored in tableMap with all entries pointing nullptr
     /// With usage tables are opened and pointers are changed
     /// When a table is closed pointer is again set in nullptr
     std::unordered_map<std::string, std::shared_ptr<Table>> tableMap{};
+    std::shared_mutex catalogMutex;     // Shared for lookups. Exclusive to open, create, drop or close tables
 
     /// This stores the baseURL where all database files are stored
     std::string baseURL;
+    bool verbose;                       // Prints tables and indexes as they are found. Library stays silent
+
+    std::thread checkpointer;
+    std::mutex checkpointMutex;
+    std::condition_variable checkpointWake;
+    bool checkpointWanted = false;
+    bool stopping = false;
+
+    /// false when directory, log or its recovery failed. Every operation is then rejected
+    bool opened = false;
+    std::string error;
 
 public:
 
-    explicit TableManager(std::string baseURL_);
+    explicit TableManager(std::string baseURL_, bool verbose_ = false);
+    ~TableManager();
+
+    /// Database is usable only when this is true. Otherwise getError() tells why it could not be opened
+    bool isOpen() const;
+    const std::string& getError() const;
 
     /// This opens the table when given tableName if not open already
     /// And share its ownership with table parameter passed as reference
@@ -69,15 +112,69 @@ public:
     TableManagerResult close(const std::string &tableName);
     bool createIndex(std::shared_ptr<Table>& table, int32_t index);
     TableManagerResult closeAll();
+
+    /// Writes every open table to its files through a checkpoint
     void flushAll();
 
     void loadIndexes(const std::shared_ptr<Table>& table);
 
+    /// Writes out changes of table and commits them. Caller holds latch of table
+    /// Position to sync() is raised in commit
+    void commit(Table* table, StatementCommit& commit);
+
+    /// Waits until commits up to position are durable as synchronous level asks
+    bool sync(uint64_t position);
+
+    void setSynchronous(SyncLevel level);
+    SyncLevel getSynchronous();
+
+    /// Commits every open table and copies log into table files. Waits for running statements to finish
+    bool checkpoint();
+
+    /// Wakes background checkpointer once log has grown past LOG_CHECKPOINT_SIZE
+    /// Past LOG_CHECKPOINT_LIMIT caller checkpoints incrementally itself, so that a busy table can't outrun checkpointer
+    /// Caller holds no latch
+    bool checkpointIfLarge();
+
 private:
 
+    /// checkpoint() with catalogMutex held exclusively
+    bool checkpointTables();
+
+    /// Fuzzy checkpoint. Pages of one idle table at a time are copied into its files while others keep running
+    /// Log is then emptied by a checkpoint that only has pages changed since to copy, when every table is idle
+    /// Tables busy with a statement are skipped and left for a later round. Never waits for a latch
+    bool checkpointIncrementally();
+    void runCheckpointer();
+    void stopCheckpointer();
+
+    /// Removes empty table and index files left by creates that were never committed
+    void removeEmptyFiles();
+
+    /// open() with catalogMutex held exclusively
+    TableManagerResult openTable(const std::string &tableName, std::shared_ptr<Table> &table);
+
     /// This is helper function to get proper file names
     std::string getFileName(const std::string &tableName, TableFileType type, int index = -1);
 };
 
+/// Latch of a table held by a statement. Changes of statement are committed to log when it is released
+class TableLatch{
+    TableManager* manager;
+    Table* table;
+    StatementCommit* commit;
+
+public:
+    /// Empty latch holding no table
+    TableLatch();
+    TableLatch(TableManager& manager_, Table* table_, StatementCommit& commit_);
+    TableLatch(TableLatch&& other) noexcept;
+    TableLatch& operator=(TableLatch&& other) noexcept;
+    TableLatch(const TableLatch&) = delete;
+    TableLatch& operator=(const TableLatch&) = delete;
+    ~TableLatch();
+
+    void release();
+};
 
 #endif //DBMS_TABLEMANAGER_H
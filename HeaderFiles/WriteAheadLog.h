@@ -0,0 +1,168 @@
+#ifndef DBMS_WRITEAHEADLOG_H
+#define DBMS_WRITEAHEADLOG_H
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// WriteAheadLog keeps every page written by pagers of a database in one sequential file, <baseURL>/dbms.wal
+/// Table and index files are left untouched until a checkpoint copies committed pages into them, so a crash
+/// can never leave them holding half of a committed statement. Nothing is rolled back: a statement that fails
+/// partway is committed with whatever pages it had already written, same as without the log
+/// 1. Pages     => evicted or committed pages are appended as page records. Records are gathered in memory and
+///                 written to file by commit. Later reads of them are served from log through an in memory index of
+///                 latest record of every page
+/// 2. Commit    => marks every earlier record of one owner as committed. Owner is heap file of a table and
+///                 covers its index files too, so statements on different tables commit independently
+/// 3. Sync      => commits waiting for disk share one fdatasync. Whoever finds no sync running starts one for
+///                 everything appended so far while later commits queue behind it
+/// 4. Checkpoint=> latest image of every page is copied into its file, files are synced and log is emptied
+///                 When some owner has uncommitted records, only committed ones are replayed in log order and
+///                 log is kept. Positions keep growing across checkpoints so that waiters compare them safely
+///                 Pages of one owner can also be copied on their own while other owners keep writing, which
+///                 leaves little for the checkpoint that empties log
+/// 5. Recovery  => log left by a crash is replayed on open. Records after last commit of their owner and a torn
+///                 record at end are dropped
+
+/// ---------------- RECORD FORMAT ----------------
+/// | type (uint8) | owner (uint32) | file (uint32) | page (int32) | length (uint32) | checksum (uint32) | payload |
+/// 1. File     => payload is path of file relative to database directory. Written before first record of file
+/// 2. Page     => payload is PAGE_SIZE bytes of page
+/// 3. Truncate => file is cut down to page pages
+/// 4. Commit   => records of owner so far are committed
+/// checksum covers header and payload so that a torn record at end of log is recognised
+
+/// ---------------- SYNCHRONOUS LEVELS ----------------
+/// 1. off    => nothing is ever synced. Survives crash of process but not of machine
+/// 2. normal => log is synced only before checkpoints. Crash of machine may lose latest commits
+/// 3. full   => every statement that changed a table waits until its commit is on disk
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <sys/types.h>
+#include "Constants.h"
+
+enum class SyncLevel{
+    off,
+    normal,
+    full
+};
+
+bool findSyncLevel(const std::string& name, SyncLevel& level);
+const char* syncLevelName(SyncLevel level);
+
+enum class LogRecordType: uint8_t{
+    file     = 1,
+    page     = 2,
+    truncate = 3,
+    commit   = 4
+};
+
+const int32_t LOG_RECORD_HEADER_SIZE = sizeof(uint8_t) + 5 * sizeof(uint32_t);
+const int64_t LOG_READ_SIZE = (1 << 20);                // Bytes read at once while replaying
+const size_t LOG_BUFFER_SIZE = (1 << 20);               // Records gathered before they are written without a commit
+const uint64_t LOG_CHECKPOINT_SIZE = (64 << 20);        // Log grown past this is checkpointed after statement
+
+class WriteAheadLog{
+    struct FileCopy{
+        std::string path;
+        int32_t truncatedTo;
+        int32_t pageCount;
+        std::vector<std::pair<int32_t, off_t>> pages;   // Page and offset of its image in log file
+    };
+
+    struct FileState{
+        std::string path;                               // Relative to directory
+        uint32_t owner;
+        bool declared;                                  // File record written since log was last emptied
+        int32_t truncatedTo;                            // Pages of file on disk beyond this are gone. -1 if none
+        int32_t pageCount;                              // One past highest page held by log
+        std::unordered_map<int32_t, uint64_t> pages;    // Log offset of payload of latest record of page
+    };
+
+    std::string directory;
+    std::string fileName;
+    int fileDescriptor;
+    SyncLevel level;
+
+    std::mutex mutex;
+    std::condition_variable synced;
+    uint64_t base;                                      // Position of first byte of log file
+    uint64_t end;                                       // Position after last record
+    uint64_t written;                                   // Position up to which records are in log file
+    std::vector<char> tail;                             // Records from written up to end
+    uint64_t durable;                                   // Position up to which log is on disk
+    bool syncing;
+    std::vector<FileState> files;
+    std::unordered_map<std::string, uint32_t> fileIds;
+    std::unordered_map<uint32_t, int32_t> uncommitted;  // Records appended by owner since its last commit
+
+public:
+    explicit WriteAheadLog(std::string directory_);
+    ~WriteAheadLog();
+
+    /// Opens log, creating it when missing. false when it can't be written
+    bool open();
+
+    /// Replays commits left in log by a crash into their files and empties log. Call once after open()
+    /// commits is number of commits replayed
+    bool recover(int64_t& commits);
+
+    void setLevel(SyncLevel level_);
+    SyncLevel getLevel();
+
+    /// Bytes in log file
+    uint64_t size();
+
+    /// Id of file at path. Records of file are committed together with those of owner, which is file itself when -1
+    uint32_t attach(const std::string& path, int64_t owner = -1);
+
+    bool writePage(uint32_t file, int32_t pageNum, const char* data);
+
+    /// Copies latest logged image of page into data, or zeros when a logged truncate cut page off
+    /// false when page is to be read from file
+    bool readPage(uint32_t file, int32_t pageNum, char* data);
+
+    /// Pages of file whose file on disk has diskPages pages
+    int32_t pageCount(uint32_t file, int32_t diskPages);
+
+    bool truncate(uint32_t file, int32_t pages);
+
+    /// Commits records of owner. position is set to sync() for durability, 0 when owner logged nothing
+    /// false when commit record could not be written
+    bool commit(uint32_t owner, uint64_t& position);
+
+    /// Waits until log is on disk up to position when level is full
+    bool sync(uint64_t position);
+
+    /// Writes pages of file held by log into descriptor so that file can be read directly
+    /// Records of file must be committed
+    bool writeBack(uint32_t file, int descriptor);
+
+    /// Copies pages of files of owner into them so that they are read from files again. Log keeps its records
+    /// Caller holds latch of owner. Other owners may write meanwhile
+    bool copyOwner(uint32_t owner);
+
+    /// Copies committed pages into their files and empties log
+    /// Log is kept when some owner has uncommitted records. Caller keeps every pager of database idle
+    bool checkpoint();
+
+private:
+    bool append(LogRecordType type, uint32_t owner, uint32_t file, int32_t page, const char* payload, uint32_t length);
+    bool declare(uint32_t file);
+    bool writeOut();
+    bool syncLog();
+
+    /// Waits until log is on disk up to position. Concurrent callers share one fdatasync
+    bool waitDurable(std::unique_lock<std::mutex>& lock, uint64_t position);
+    bool replay(uint64_t length, int64_t& commits);
+    FileCopy snapshot(const FileState& state);
+    bool copyFile(const FileCopy& copy);
+
+    /// Writes latest logged image of every page into its file. Every record must be committed
+    bool copyPages();
+    void reset();
+};
+
+#endif //DBMS_WRITEAHEADLOG_H
@@ -1,12 +1,20 @@
 #include <iostream>
 #include <cstdio>
 #include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 enum class MetaCommandResult{
     exit,
     empty,
     unrecognized,
-    flush
+    flush,
+    mode,
+    output,
+    synchronous
 };
 
 class InputBuffer{
@@ -34,6 +42,15 @@ public:
         else if(buffer == ".flush"){
             return MetaCommandResult::flush;
         }
+        else if(command() == ".mode"){
+            return MetaCommandResult::mode;
+        }
+        else if(command() == ".output"){
+            return MetaCommandResult::output;
+        }
+        else if(command() == ".synchronous"){
+            return MetaCommandResult::synchronous;
+        }
         else if(buffer.empty()){
             return MetaCommandResult::empty;
         }
@@ -41,6 +58,69 @@ public:
             return MetaCommandResult::unrecognized;
         }
     }
+
+    /// Word of meta command before first space
+    std::string command() const{
+        return buffer.substr(0, buffer.find(' '));
+    }
+
+    /// Text of meta command after its first word without surrounding spaces
+    std::string argument() const{
+        size_t start = buffer.find(' ');
+        if(start == std::string::npos) return "";
+        start = buffer.find_first_not_of(' ', start);
+        if(start == std::string::npos) return "";
+        return buffer.substr(start, buffer.find_last_not_of(' ') + 1 - start);
+    }
+};
+
+/// Statements of batch mode. A regular file is mapped into memory and read in place
+/// Pipes can't be mapped so they are read whole into a buffer
+class ScriptFile{
+    int fileDescriptor = -1;
+    char* mapping = nullptr;
+    size_t length = 0;
+    std::string buffer;
+
+public:
+    ScriptFile() = default;
+    ScriptFile(const ScriptFile&) = delete;
+    ScriptFile& operator=(const ScriptFile&) = delete;
+
+    ~ScriptFile(){
+        if(mapping != nullptr) munmap(mapping, length);
+        if(fileDescriptor > STDIN_FILENO) close(fileDescriptor);
+    }
+
+    /// fileName is read from stdin when it is nullptr or "-"
+    bool open(const char* fileName){
+        bool useStdin = (fileName == nullptr || std::string_view(fileName) == "-");
+        fileDescriptor = useStdin ? STDIN_FILENO : ::open(fileName, O_RDONLY);
+        if(fileDescriptor < 0) return false;
+
+        struct stat info{};
+        if(fstat(fileDescriptor, &info) == 0 && S_ISREG(info.st_mode)){
+            length = info.st_size;
+            if(length == 0) return true;
+            void* res = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+            if(res != MAP_FAILED){
+                mapping = static_cast<char*>(res);
+                madvise(mapping, length, MADV_SEQUENTIAL);
+                return true;
+            }
+            length = 0;
+        }
+
+        char chunk[1 << 16];
+        ssize_t len;
+        while((len = read(fileDescriptor, chunk, sizeof(chunk))) > 0) buffer.append(chunk, len);
+        return len == 0;
+    }
+
+    std::string_view text() const{
+        if(mapping != nullptr) return {mapping, length};
+        return buffer;
+    }
 };
 
 inline void printPrompt(){
@@ -0,0 +1,676 @@
+#include "HeaderFiles/Join.h"
+
+// =============================================
+//                 JOIN BATCH
+// =============================================
+
+JoinBatch::JoinBatch(std::function<bool(JoinBatch&)> consumer_):consumer(std::move(consumer_)){
+    size = 0;
+}
+
+bool JoinBatch::flush(){
+    if(size == 0) return true;
+    bool res = consumer(*this);
+    size = 0;
+    return res;
+}
+
+bool scanCells(Table* table, int32_t column, const std::function<bool(const char* cell, row_t row)>& callback){
+    HeapScanner heap(table);
+    return heap.scan({}, [&](row_t row)->bool{
+        Cursor cursor(table);
+        cursor.row = row;
+        const char* buffer = cursor.value();
+        if(buffer == nullptr) return false;
+        return callback(table->codec.cell(buffer, column), row);
+    });
+}
+
+// =============================================
+//                 SORTED RUN
+// =============================================
+
+template <typename key_t>
+SortedRun<key_t>::SortedRun(){
+    position = 0;
+    descending = false;
+    external = false;
+    fileDescriptor = -1;
+    bufferSize = 0;
+    bufferOffset = 0;
+    fileOffset = 0;
+}
+
+template <typename key_t>
+SortedRun<key_t>::~SortedRun(){
+    if(fileDescriptor != -1) ::close(fileDescriptor);
+    if(!sortedFileName.empty()) std::filesystem::remove(sortedFileName);
+}
+
+template <typename key_t>
+bool SortedRun<key_t>::build(Table* table, int32_t column, bool descending_){
+    descending = descending_;
+    // ExternalSort copies raw key bytes so only fixed size keys can spill
+    if constexpr(!std::is_same<key_t, std::string>::value){
+        int64_t entrySize = sizeof(key_t) + sizeof(row_t);
+        if(table->getRowCount() * entrySize > JOIN_MEMORY_BUDGET) return buildExternal(table, column);
+    }
+    return buildInMemory(table, column);
+}
+
+template <typename key_t>
+bool SortedRun<key_t>::buildInMemory(Table* table, int32_t column){
+    int32_t width = table->columnSizes[column];
+    entries.reserve(table->getRowCount());
+    bool res = scanCells(table, column, [&](const char* cell, row_t row)->bool{
+        entries.emplace_back(readKey<key_t>(cell, width), row);
+        return true;
+    });
+    if(!res) return false;
+
+    if(descending){
+        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b){
+            return b.first < a.first;
+        });
+    }
+    else{
+        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b){
+            return a.first < b.first;
+        });
+    }
+    position = 0;
+    return true;
+}
+
+template <typename key_t>
+bool SortedRun<key_t>::buildExternal(Table* table, int32_t column){
+    // ExternalSort reads table file directly, so pages still held by log are copied into it first
+    if(!table->pager->flushAll() || !table->pager->writeBack()) return false;
+
+    std::filesystem::path path(table->getFileName());
+    std::string directory = path.parent_path().string();
+    sortedFileName = directory + "/extSortTemp/" + path.stem().string() + "_" + std::to_string(column) + ".sorted";
+
+    std::vector<row_t> freeRows;
+    if(!table->getFreeRows(freeRows)) return false;
+    std::vector<int> rowStack(freeRows.size() + 1);
+    rowStack[0] = freeRows.size();
+    std::copy(freeRows.begin(), freeRows.end(), rowStack.begin() + 1);
+
+    ExternalSort<key_t> sorter(directory, path.filename().string(), sortedFileName, table->getRowSlots(), rowStack.data());
+    sorter.sort(table->getRowSize(), table->codec.offsets[column], sizeof(key_t), PAGE_SIZE);
+
+    fileDescriptor = ::open(sortedFileName.c_str(), O_RDONLY);
+    if(fileDescriptor == -1) return false;
+    external = true;
+    int64_t entrySize = sizeof(key_t) + sizeof(row_t);
+    buffer = std::make_unique<char[]>(JOIN_READ_SIZE / entrySize * entrySize);
+    bufferSize = 0;
+    bufferOffset = 0;
+    fileOffset = std::filesystem::file_size(sortedFileName);
+    return true;
+}
+
+template <typename key_t>
+bool SortedRun<key_t>::next(key_t& key, row_t& row){
+    if(!external){
+        if(position == entries.size()) return false;
+        key = entries[position].first;
+        row = entries[position].second;
+        ++position;
+        return true;
+    }
+
+    if constexpr(!std::is_same<key_t, std::string>::value){
+        int64_t entrySize = sizeof(key_t) + sizeof(row_t);
+        if(descending){
+            if(bufferOffset == 0){
+                int64_t readSize = std::min(JOIN_READ_SIZE / entrySize * entrySize, fileOffset);
+                if(readSize <= 0) return false;
+                fileOffset -= readSize;
+                if(::pread(fileDescriptor, buffer.get(), readSize, fileOffset) != readSize) return false;
+                bufferOffset = readSize;
+            }
+            bufferOffset -= entrySize;
+            memcpy(&key, buffer.get() + bufferOffset, sizeof(key_t));
+            memcpy(&row, buffer.get() + bufferOffset + sizeof(key_t), sizeof(row_t));
+            return true;
+        }
+        if(bufferOffset == bufferSize){
+            bufferSize = ::read(fileDescriptor, buffer.get(), JOIN_READ_SIZE / entrySize * entrySize);
+            bufferOffset = 0;
+            if(bufferSize <= 0) return false;
+        }
+        memcpy(&key, buffer.get() + bufferOffset, sizeof(key_t));
+        memcpy(&row, buffer.get() + bufferOffset + sizeof(key_t), sizeof(row_t));
+        bufferOffset += entrySize;
+        return true;
+    }
+    return false;
+}
+
+// =============================================
+//              SORT MERGE JOIN
+// =============================================
+
+template <typename key_t, typename left_t, typename right_t>
+bool mergeRuns(left_t& left, right_t& right, const std::function<bool(row_t, row_t)>& callback){
+    key_t leftKey, rightKey;
+    row_t leftRow, rightRow;
+    bool hasLeft = left.next(leftKey, leftRow);
+    bool hasRight = right.next(rightKey, rightRow);
+
+    // Right rows of current key are buffered and matched with every equal left row
+    std::vector<row_t> group;
+    while(hasLeft && hasRight){
+        if(leftKey < rightKey){
+            hasLeft = left.next(leftKey, leftRow);
+        }
+        else if(rightKey < leftKey){
+            hasRight = right.next(rightKey, rightRow);
+        }
+        else{
+            key_t key = leftKey;
+            group.clear();
+            while(hasRight && rightKey == key){
+                group.push_back(rightRow);
+                hasRight = right.next(rightKey, rightRow);
+            }
+            while(hasLeft && leftKey == key){
+                for(row_t row: group){
+                    if(!callback(leftRow, row)) return false;
+                }
+                hasLeft = left.next(leftKey, leftRow);
+            }
+        }
+    }
+    return true;
+}
+
+template <typename key_t>
+bool sortMergeJoin(Table* left, int32_t leftColumn, Table* right, int32_t rightColumn, JoinBatch& output){
+    std::function<bool(row_t, row_t)> emit = [&](row_t leftRow, row_t rightRow)->bool{
+        return output.push(leftRow, rightRow);
+    };
+
+    if constexpr(!std::is_same<key_t, std::string>::value){
+        auto leftTree = left->indexed[leftColumn] ? dynamic_cast<BPTree<key_t>*>(left->trees[leftColumn].get()) : nullptr;
+        auto rightTree = right->indexed[rightColumn] ? dynamic_cast<BPTree<key_t>*>(right->trees[rightColumn].get()) : nullptr;
+
+        if(leftTree != nullptr && rightTree != nullptr){
+            return leftTree->naturalJoinBothIndex(*rightTree, emit);
+        }
+        if(leftTree != nullptr){
+            SortedRun<key_t> rightRun;
+            if(!rightRun.build(right, rightColumn)) return false;
+            return leftTree->naturalJoinOneIndex(rightRun, emit);
+        }
+        if(rightTree != nullptr){
+            SortedRun<key_t> leftRun;
+            if(!leftRun.build(left, leftColumn)) return false;
+            return rightTree->naturalJoinOneIndex(leftRun, [&](row_t rowOfCurrent, row_t rowOfOther)->bool{
+                return emit(rowOfOther, rowOfCurrent);
+            });
+        }
+    }
+
+    SortedRun<key_t> leftRun, rightRun;
+    if(!leftRun.build(left, leftColumn) || !rightRun.build(right, rightColumn)) return false;
+    return mergeRuns<key_t>(leftRun, rightRun, emit);
+}
+
+bool sortMergeJoin(Table* left, int32_t leftColumn, Table* right, int32_t rightColumn, JoinBatch& output){
+    bool res = false;
+    switch(left->columnTypes[leftColumn]){
+        case DataType::Int:
+            res = sortMergeJoin<int32_t>(left, leftColumn, right, rightColumn, output);
+            break;
+        case DataType::Float:
+            res = sortMergeJoin<float>(left, leftColumn, right, rightColumn, output);
+            break;
+        case DataType::Char:
+            res = sortMergeJoin<char>(left, leftColumn, right, rightColumn, output);
+            break;
+        case DataType::Bool:
+            res = sortMergeJoin<bool>(left, leftColumn, right, rightColumn, output);
+            break;
+        case DataType::String:
+            // String B+ trees are not usable yet so both sides are sorted
+            res = sortMergeJoin<std::string>(left, leftColumn, right, rightColumn, output);
+            break;
+    }
+    return res && output.flush();
+}
+
+// =============================================
+//              JOIN HASH TABLE
+// =============================================
+
+// Slot is chosen from low bits after dropping the always set bit 0
+// High bits are left for radix partitioning
+
+template <typename key_t>
+JoinHashTable<key_t>::JoinHashTable(size_t rows){
+    size_t capacity = 16;
+    while(capacity < 2 * rows) capacity <<= 1;
+    slots.resize(capacity);
+    for(auto& slot: slots) slot.hash = 0;
+    entries.reserve(rows);
+    mask = capacity - 1;
+    count = 0;
+}
+
+template <typename key_t>
+void JoinHashTable<key_t>::insert(const key_t& key, uint32_t hash, row_t row){
+    uint32_t entry = entries.size();
+    entries.push_back(Entry{row, NO_ENTRY});
+    uint32_t index = (hash >> 1) & mask;
+    while(slots[index].hash != 0){
+        if(slots[index].hash == hash && slots[index].key == key){
+            entries[slots[index].last].next = entry;
+            slots[index].last = entry;
+            return;
+        }
+        index = (index + 1) & mask;
+    }
+    slots[index].hash = hash;
+    slots[index].first = entry;
+    slots[index].last = entry;
+    slots[index].key = key;
+    if(2 * (++count) > slots.size()) grow();
+}
+
+template <typename key_t>
+bool JoinHashTable<key_t>::probe(const key_t& key, uint32_t hash, const std::function<bool(row_t row)>& callback) const{
+    uint32_t index = (hash >> 1) & mask;
+    while(slots[index].hash != 0){
+        if(slots[index].hash == hash && slots[index].key == key){
+            for(uint32_t entry = slots[index].first; entry != NO_ENTRY; entry = entries[entry].next){
+                if(!callback(entries[entry].row)) return false;
+            }
+            return true;
+        }
+        index = (index + 1) & mask;
+    }
+    return true;
+}
+
+/// Chains stay in entries, only slots move
+template <typename key_t>
+void JoinHashTable<key_t>::grow(){
+    std::vector<Slot> old = std::move(slots);
+    slots.clear();
+    slots.resize(2 * old.size());
+    for(auto& slot: slots) slot.hash = 0;
+    mask = slots.size() - 1;
+    for(auto& slot: old){
+        if(slot.hash == 0) continue;
+        uint32_t index = (slot.hash >> 1) & mask;
+        while(slots[index].hash != 0) index = (index + 1) & mask;
+        slots[index] = slot;
+    }
+}
+
+// =============================================
+//              PARTITION WRITER
+// =============================================
+
+PartitionWriter::PartitionWriter(const std::string& prefix, int32_t radixBits, int32_t width_){
+    width = width_;
+    entrySize = width + sizeof(row_t);
+    shift = 32 - radixBits;
+
+    int32_t partitions = 1 << radixBits;
+    int64_t bufferSize = JOIN_SPILL_BUFFER / entrySize * entrySize;
+    for(int32_t i = 0; i < partitions; ++i){
+        fileNames.push_back(prefix + "_" + std::to_string(i) + ".part");
+        fileDescriptors.push_back(::open(fileNames.back().c_str(), O_CREAT | O_TRUNC | O_WRONLY, S_IWUSR | S_IRUSR));
+        buffers.push_back(std::make_unique<char[]>(bufferSize));
+        used.push_back(0);
+    }
+}
+
+PartitionWriter::~PartitionWriter(){
+    for(int fd: fileDescriptors){
+        if(fd != -1) ::close(fd);
+    }
+}
+
+bool PartitionWriter::append(uint32_t hash, const char* cell, row_t row){
+    int32_t partition = hash >> shift;
+    char* buffer = buffers[partition].get() + used[partition];
+    memcpy(buffer, cell, width);
+    memcpy(buffer + width, &row, sizeof(row_t));
+    used[partition] += entrySize;
+    if(used[partition] + entrySize > JOIN_SPILL_BUFFER) return flush(partition);
+    return true;
+}
+
+bool PartitionWriter::flush(int32_t partition){
+    if(fileDescriptors[partition] == -1) return false;
+    if(used[partition] == 0) return true;
+    ssize_t bytesWritten = ::write(fileDescriptors[partition], buffers[partition].get(), used[partition]);
+    if(bytesWritten != used[partition]) return false;
+    used[partition] = 0;
+    return true;
+}
+
+bool PartitionWriter::finish(){
+    bool res = true;
+    for(int32_t i = 0; i < fileDescriptors.size(); ++i){
+        res = flush(i) && res;
+        if(fileDescriptors[i] != -1) ::close(fileDescriptors[i]);
+        fileDescriptors[i] = -1;
+        buffers[i].reset();
+    }
+    return res;
+}
+
+void PartitionWriter::remove(const std::vector<std::string>& fileNames){
+    for(auto& fileName: fileNames) std::filesystem::remove(fileName);
+}
+
+// =============================================
+//              PARTITION READER
+// =============================================
+
+PartitionReader::PartitionReader(const std::string& fileName, int32_t entrySize_){
+    entrySize = entrySize_;
+    blockSize = JOIN_SPILL_READ / entrySize * entrySize;
+    primaryBuffer = std::make_unique<char[]>(blockSize);
+    secondaryBuffer = std::make_unique<char[]>(blockSize);
+    primarySize = 0;
+    secondarySize = 0;
+    offset = 0;
+    fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+    if(fileDescriptor != -1) fetchFromStorage();
+}
+
+PartitionReader::~PartitionReader(){
+    if(readThread.joinable()) readThread.join();
+    if(fileDescriptor != -1) ::close(fileDescriptor);
+}
+
+void PartitionReader::fetchFromStorage(){
+    secondarySize = ::read(fileDescriptor, secondaryBuffer.get(), blockSize);
+    if(secondarySize < 0) secondarySize = 0;
+}
+
+#ifdef JOIN_SPILL_READ_ASYNC
+void PartitionReader::fetchInput(){
+    if(readThread.joinable()) readThread.join();
+    std::swap(primaryBuffer, secondaryBuffer);
+    primarySize = secondarySize;
+    offset = 0;
+    if(primarySize > 0) readThread = std::thread(&PartitionReader::fetchFromStorage, this);
+}
+#else
+void PartitionReader::fetchInput(){
+    std::swap(primaryBuffer, secondaryBuffer);
+    primarySize = secondarySize;
+    offset = 0;
+    if(primarySize > 0) fetchFromStorage();
+}
+#endif
+
+const char* PartitionReader::next(){
+    if(fileDescriptor == -1) return nullptr;
+    if(offset == primarySize){
+        fetchInput();
+        if(primarySize == 0) return nullptr;
+    }
+    const char* entry = primaryBuffer.get() + offset;
+    offset += entrySize;
+    return entry;
+}
+
+// =============================================
+//                 HASH JOIN
+// =============================================
+
+template <typename key_t>
+bool buildAndProbe(Table* build, int32_t buildColumn, Table* probe, int32_t probeColumn, const std::function<bool(row_t, row_t)>& emit){
+    int32_t buildWidth = build->columnSizes[buildColumn];
+    int32_t probeWidth = probe->columnSizes[probeColumn];
+
+    JoinHashTable<key_t> table(build->getRowCount());
+    bool res = scanCells(build, buildColumn, [&](const char* cell, row_t row)->bool{
+        key_t key = readKey<key_t>(cell, buildWidth);
+        table.insert(key, hashKey(key), row);
+        return true;
+    });
+    if(!res) return false;
+
+    return scanCells(probe, probeColumn, [&](const char* cell, row_t probeRow)->bool{
+        key_t key = readKey<key_t>(cell, probeWidth);
+        return table.probe(key, hashKey(key), [&](row_t buildRow)->bool{
+            return emit(buildRow, probeRow);
+        });
+    });
+}
+
+template <typename key_t>
+bool partitionTable(Table* table, int32_t column, PartitionWriter& writer){
+    int32_t width = table->columnSizes[column];
+    bool res = scanCells(table, column, [&](const char* cell, row_t row)->bool{
+        return writer.append(hashKey(readKey<key_t>(cell, width)), cell, row);
+    });
+    return writer.finish() && res;
+}
+
+template <typename key_t>
+bool joinPartition(const std::string& buildFile, int32_t buildWidth, const std::string& probeFile, int32_t probeWidth,
+                   const std::function<bool(row_t, row_t)>& emit){
+    int32_t buildEntrySize = buildWidth + sizeof(row_t);
+    auto buildBytes = std::filesystem::file_size(buildFile);
+    if(buildBytes == 0) return true;
+
+    JoinHashTable<key_t> table(buildBytes / buildEntrySize);
+    PartitionReader buildReader(buildFile, buildEntrySize);
+    const char* entry;
+    row_t row;
+    while((entry = buildReader.next()) != nullptr){
+        key_t key = readKey<key_t>(entry, buildWidth);
+        memcpy(&row, entry + buildWidth, sizeof(row_t));
+        table.insert(key, hashKey(key), row);
+    }
+
+    PartitionReader probeReader(probeFile, probeWidth + sizeof(row_t));
+    while((entry = probeReader.next()) != nullptr){
+        key_t key = readKey<key_t>(entry, probeWidth);
+        memcpy(&row, entry + probeWidth, sizeof(row_t));
+        bool res = table.probe(key, hashKey(key), [&](row_t buildRow)->bool{
+            return emit(buildRow, row);
+        });
+        if(!res) return false;
+    }
+    return true;
+}
+
+// Numbers partition files of each Grace hash join, so that joins spilling at once never share a file
+static std::atomic<uint64_t> spillCount(0);
+
+template <typename key_t>
+bool graceHashJoin(Table* build, int32_t buildColumn, Table* probe, int32_t probeColumn, const std::function<bool(row_t, row_t)>& emit){
+    // Enough partitions for build side of one partition to fit budget
+    int64_t buildBytes = build->getRowCount() * JoinHashTable<key_t>::entrySize;
+    int32_t radixBits = 1;
+    while(radixBits < JOIN_MAX_RADIX_BITS && (buildBytes >> radixBits) > JOIN_MEMORY_BUDGET) ++radixBits;
+
+    std::filesystem::path path(build->getFileName());
+    std::string directory = path.parent_path().string() + "/joinTemp";
+    std::filesystem::create_directories(directory);
+
+    int32_t buildWidth = build->columnSizes[buildColumn];
+    int32_t probeWidth = probe->columnSizes[probeColumn];
+    std::string spill = std::to_string(spillCount++);
+    PartitionWriter buildWriter(directory + "/build_" + spill, radixBits, buildWidth);
+    PartitionWriter probeWriter(directory + "/probe_" + spill, radixBits, probeWidth);
+
+    bool res = partitionTable<key_t>(build, buildColumn, buildWriter) &&
+               partitionTable<key_t>(probe, probeColumn, probeWriter);
+    for(int32_t i = 0; res && i < buildWriter.fileNames.size(); ++i){
+        res = joinPartition<key_t>(buildWriter.fileNames[i], buildWidth, probeWriter.fileNames[i], probeWidth, emit);
+    }
+
+    PartitionWriter::remove(buildWriter.fileNames);
+    PartitionWriter::remove(probeWriter.fileNames);
+    return res;
+}
+
+template <typename key_t>
+bool hashJoin(Table* left, int32_t leftColumn, Table* right, int32_t rightColumn, JoinBatch& output){
+    // Smaller side is built. Pairs are handed over as (left row, right row) either way
+    bool buildLeft = left->getRowCount() <= right->getRowCount();
+    Table* build       = buildLeft ? left : right;
+    Table* probe       = buildLeft ? right : left;
+    int32_t buildColumn = buildLeft ? leftColumn : rightColumn;
+    int32_t probeColumn = buildLeft ? rightColumn : leftColumn;
+
+    std::function<bool(row_t, row_t)> emit = [&](row_t buildRow, row_t probeRow)->bool{
+        return buildLeft ? output.push(buildRow, probeRow) : output.push(probeRow, buildRow);
+    };
+
+    if(build->getRowCount() * JoinHashTable<key_t>::entrySize <= JOIN_MEMORY_BUDGET){
+        return buildAndProbe<key_t>(build, buildColumn, probe, probeColumn, emit);
+    }
+    return graceHashJoin<key_t>(build, buildColumn, probe, probeColumn, emit);
+}
+
+bool hashJoin(Table* left, int32_t leftColumn, Table* right, int32_t rightColumn, JoinBatch& output){
+    bool res = false;
+    switch(left->columnTypes[leftColumn]){
+        case DataType::Int:
+            res = hashJoin<int32_t>(left, leftColumn, right, rightColumn, output);
+            break;
+        case DataType::Float:
+            res = hashJoin<float>(left, leftColumn, right, rightColumn, output);
+            break;
+        case DataType::Char:
+            res = hashJoin<char>(left, leftColumn, right, rightColumn, output);
+            break;
+        case DataType::Bool:
+            res = hashJoin<bool>(left, leftColumn, right, rightColumn, output);
+            break;
+        case DataType::String:
+            res = hashJoin<std::string>(left, leftColumn, right, rightColumn, output);
+            break;
+    }
+    return res && output.flush();
+}
+
+// =============================================
+//           INDEX NESTED LOOP JOIN
+// =============================================
+
+template <typename key_t>
+bool indexNestedLoopJoin(Table* outer, int32_t outerColumn, Table* inner, int32_t innerColumn, bool innerIsLeft, JoinBatch& output){
+    auto tree = dynamic_cast<BPTree<key_t>*>(inner->trees[innerColumn].get());
+    if(tree == nullptr) return false;
+    int32_t width = outer->columnSizes[outerColumn];
+
+    std::vector<std::pair<key_t, row_t>> probes;
+    std::vector<std::pair<row_t, row_t>> matches;           // (inner row, outer row)
+    probes.reserve(JOIN_PROBE_BATCH);
+
+    auto probeBatch = [&]()->bool{
+        std::sort(probes.begin(), probes.end(), [](const auto& a, const auto& b){
+            return a.first < b.first;
+        });
+        matches.clear();
+        bool res = tree->probeSorted(probes, [&](row_t innerRow, row_t outerRow)->bool{
+            matches.emplace_back(innerRow, outerRow);
+            return true;
+        });
+        probes.clear();
+        if(!res) return false;
+
+        std::sort(matches.begin(), matches.end());
+        for(auto& match: matches){
+            res = innerIsLeft ? output.push(match.first, match.second) : output.push(match.second, match.first);
+            if(!res) return false;
+        }
+        return true;
+    };
+
+    bool res = scanCells(outer, outerColumn, [&](const char* cell, row_t row)->bool{
+        probes.emplace_back(readKey<key_t>(cell, width), row);
+        if(probes.size() == JOIN_PROBE_BATCH) return probeBatch();
+        return true;
+    });
+    return res && probeBatch();
+}
+
+bool indexNestedLoopJoin(Table* left, int32_t leftColumn, Table* right, int32_t rightColumn, JoinBatch& output){
+    // Larger indexed side is probed
+    bool innerIsLeft = left->indexed[leftColumn];
+    if(left->indexed[leftColumn] && right->indexed[rightColumn]) innerIsLeft = left->getRowCount() >= right->getRowCount();
+
+    Table* outer        = innerIsLeft ? right : left;
+    Table* inner        = innerIsLeft ? left : right;
+    int32_t outerColumn = innerIsLeft ? rightColumn : leftColumn;
+    int32_t innerColumn = innerIsLeft ? leftColumn : rightColumn;
+    if(!inner->indexed[innerColumn]) return false;
+
+    bool res = false;
+    switch(left->columnTypes[leftColumn]){
+        case DataType::Int:
+            res = indexNestedLoopJoin<int32_t>(outer, outerColumn, inner, innerColumn, innerIsLeft, output);
+            break;
+        case DataType::Float:
+            res = indexNestedLoopJoin<float>(outer, outerColumn, inner, innerColumn, innerIsLeft, output);
+            break;
+        case DataType::Char:
+            res = indexNestedLoopJoin<char>(outer, outerColumn, inner, innerColumn, innerIsLeft, output);
+            break;
+        case DataType::Bool:
+            res = indexNestedLoopJoin<bool>(outer, outerColumn, inner, innerColumn, innerIsLeft, output);
+            break;
+        case DataType::String:
+            // String B+ trees are not usable yet
+            break;
+    }
+    return res && output.flush();
+}
+
+// =============================================
+//               CHOOSING METHOD
+// =============================================
+
+static double heapPages(Table* table){
+    return std::ceil(static_cast<double>(table->getRowSlots()) / table->getRowsPerPage());
+}
+
+static double leafPages(Table* table, int32_t column){
+    return std::ceil(table->getRowCount() / static_cast<double>(std::max(1, table->trees[column]->fanout())));
+}
+
+static double sortedSideCost(Table* table, int32_t column){
+    double rows = table->getRowCount();
+    if(table->indexed[column]){
+        return (table->trees[column]->height() + leafPages(table, column)) * RANDOM_PAGE_COST + rows * CPU_ROW_COST;
+    }
+    return heapPages(table) * SEQ_PAGE_COST + rows * std::max(1.0, std::log2(rows)) * CPU_ROW_COST;
+}
+
+static double indexNestedLoopCost(Table* outer, Table* inner, int32_t innerColumn){
+    double rows = outer->getRowCount();
+    double probes = std::max(1.0, std::log2(std::min<double>(std::max(rows, 1.0), JOIN_PROBE_BATCH)));
+    return heapPages(outer) * SEQ_PAGE_COST
+         + rows * (probes + inner->trees[innerColumn]->height()) * CPU_ROW_COST
+         + std::min(rows, leafPages(inner, innerColumn)) * RANDOM_PAGE_COST;
+}
+
+JoinMethod chooseJoinMethod(Table* left, int32_t leftColumn, Table* right, int32_t rightColumn){
+    bool leftIndexed = left->indexed[leftColumn], rightIndexed = right->indexed[rightColumn];
+    if(left->columnTypes[leftColumn] == DataType::String || (!leftIndexed && !rightIndexed)) return JoinMethod::hash;
+
+    double sortMerge = sortedSideCost(left, leftColumn) + sortedSideCost(right, rightColumn);
+
+    // Same inner side as indexNestedLoopJoin picks
+    bool innerIsLeft = leftIndexed;
+    if(leftIndexed && rightIndexed) innerIsLeft = left->getRowCount() >= right->getRowCount();
+    double nestedLoop = innerIsLeft ? indexNestedLoopCost(right, left, leftColumn)
+                                    : indexNestedLoopCost(left, right, rightColumn);
+    return nestedLoop < sortMerge ? JoinMethod::indexNestedLoop : JoinMethod::sortMerge;
+}
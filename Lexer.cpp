@@ -0,0 +1,129 @@
+#include "HeaderFiles/Lexer.h"
+#include <array>
+
+namespace {
+    enum CharClass: unsigned char{
+        wordChar,
+        spaceChar,
+        symbolChar
+    };
+
+    struct CharTable{
+        std::array<unsigned char, 256> word{};      // Class of char when reading a word
+        std::array<bool, 256> valueEnd{};           // Char ends an unquoted value
+
+        CharTable(){
+            word.fill(wordChar);
+            for(unsigned char c: std::string_view(" \t\n\r\v\f")) word[c] = spaceChar;
+            for(unsigned char c: std::string_view("{}(),:=<>!&|\"'")) word[c] = symbolChar;
+            for(unsigned char c: std::string_view(",&|}) \t\n\r")) valueEnd[c] = true;
+        }
+    };
+
+    const CharTable chars;
+
+    inline unsigned char charClass(char c){
+        return chars.word[static_cast<unsigned char>(c)];
+    }
+}
+
+Lexer::Lexer(std::string_view input_){
+    this->input = input_;
+    this->position = 0;
+}
+
+void Lexer::skipSpaces(){
+    while(position < input.size() && charClass(input[position]) == spaceChar) ++position;
+}
+
+Token Lexer::quoted(TokenType type, char quote){
+    Token token;
+    token.offset = position;
+    size_t close = input.find(quote, position + 1);
+    if(close == std::string_view::npos){
+        token.type = TokenType::error;
+        token.text = input.substr(position);
+        position = input.size();
+        return token;
+    }
+    token.type = type;
+    token.text = input.substr(position + 1, close - position - 1);
+    position = close + 1;
+    return token;
+}
+
+Token Lexer::next(){
+    skipSpaces();
+    Token token;
+    token.offset = position;
+    if(position >= input.size()) return token;
+
+    char c = input[position];
+    if(charClass(c) == wordChar){
+        size_t end = position + 1;
+        while(end < input.size() && charClass(input[end]) == wordChar) ++end;
+        token.type = TokenType::word;
+        token.text = input.substr(position, end - position);
+        position = end;
+        return token;
+    }
+    if(c == '"') return quoted(TokenType::string, '"');
+    if(c == '\'') return quoted(TokenType::file, '\'');
+
+    // Comparison symbols take a second = < or > so that <> or => come out whole and can be rejected
+    char following = (position + 1 < input.size()) ? input[position + 1] : '\0';
+    size_t length = 1;
+    token.type = TokenType::symbol;
+    switch(c){
+        case '=': case '!': case '<': case '>':
+            if(following == '=' || following == '<' || following == '>') length = 2;
+            break;
+        case '&': case '|':
+            if(following == c) length = 2;
+            else token.type = TokenType::error;
+            break;
+        default:
+            break;
+    }
+    token.text = input.substr(position, length);
+    position += length;
+    return token;
+}
+
+Token Lexer::peek(){
+    size_t saved = position;
+    Token token = next();
+    position = saved;
+    return token;
+}
+
+bool Lexer::accept(std::string_view text){
+    size_t saved = position;
+    if(next().is(text)) return true;
+    position = saved;
+    return false;
+}
+
+Token Lexer::value(){
+    skipSpaces();
+    if(position < input.size() && input[position] == '"') return quoted(TokenType::string, '"');
+
+    Token token;
+    token.type = TokenType::word;
+    token.offset = position;
+    size_t end = position;
+    while(end < input.size() && !chars.valueEnd[static_cast<unsigned char>(input[end])]) ++end;
+    token.text = input.substr(position, end - position);
+    position = end;
+    return token;
+}
+
+bool Lexer::atEnd(){
+    skipSpaces();
+    return position >= input.size();
+}
+
+std::string_view Lexer::rest(){
+    skipSpaces();
+    return input.substr(position);
+}
@@ -0,0 +1,441 @@
+#include "HeaderFiles/Loader.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+// =============================================
+//                 CHUNK READER
+// =============================================
+
+ChunkReader::ChunkReader(const std::string& fileName, LoadFormat format_, int32_t recordSize_){
+    this->fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+    this->format = format_;
+    this->recordSize = recordSize_;
+    this->nextLine = 1;
+    this->endOfFile = false;
+}
+
+ChunkReader::~ChunkReader(){
+    if(fileDescriptor != -1) ::close(fileDescriptor);
+}
+
+bool ChunkReader::isOpen() const{
+    return fileDescriptor != -1;
+}
+
+bool ChunkReader::next(LoadChunk& chunk, bool& failed){
+    failed = false;
+    std::vector<char>& data = chunk.data;
+    data.swap(carry);
+    carry.clear();
+
+    // CSV chunk ends after last newline outside quotes. Chunk grows when it holds no such newline
+    bool quoted = false;
+    int64_t scanned = 0;
+    int64_t newlines = 0;
+    int64_t cut = 0;
+    int64_t records = 0;
+    while(true){
+        if(!endOfFile){
+            size_t size = data.size();
+            data.resize(size + LOAD_CHUNK_SIZE);
+            ssize_t bytesRead = ::read(fileDescriptor, data.data() + size, LOAD_CHUNK_SIZE);
+            if(bytesRead == -1){
+                printf("Error reading file: %d\n", errno);
+                failed = true;
+                return false;
+            }
+            if(bytesRead == 0) endOfFile = true;
+            data.resize(size + bytesRead);
+        }
+
+        if(format == LoadFormat::binary){
+            // Partial row at end of file is left to parser which reports it
+            cut = endOfFile ? data.size() : data.size() / recordSize * recordSize;
+            records = cut / recordSize;
+            if(cut > 0 || endOfFile) break;
+            continue;
+        }
+
+        for(; scanned < data.size(); ++scanned){
+            char c = data[scanned];
+            if(c == '"') quoted = !quoted;
+            else if(c == '\n'){
+                ++newlines;
+                if(!quoted){
+                    cut = scanned + 1;
+                    records = newlines;
+                }
+            }
+        }
+        if(endOfFile){
+            cut = data.size();
+            records = newlines;
+            break;
+        }
+        if(cut > 0) break;
+    }
+
+    carry.assign(data.begin() + cut, data.end());
+    data.resize(cut);
+    chunk.firstLine = nextLine;
+    nextLine += records;
+    return !data.empty();
+}
+
+// =============================================
+//                   PARSERS
+// =============================================
+
+/// Splits record [current, last) into fields in place. false when it is malformed
+static bool splitRecord(char* current, char* last, std::vector<const char*>& fields, std::vector<int32_t>& lengths){
+    fields.clear();
+    lengths.clear();
+    while(true){
+        char* field = current;
+        char* out = current;
+        if(current < last && *current == '"'){
+            // Unescaped text is written over quoted text in place
+            ++current;
+            while(true){
+                if(current == last) return false;
+                if(*current == '"'){
+                    if(current + 1 < last && current[1] == '"'){
+                        *out++ = '"';
+                        current += 2;
+                        continue;
+                    }
+                    ++current;
+                    break;
+                }
+                *out++ = *current++;
+            }
+            if(current < last && *current != ',') return false;
+        }
+        else{
+            auto comma = static_cast<char*>(memchr(current, ',', last - current));
+            current = (comma == nullptr) ? last : comma;
+            out = current;
+        }
+
+        fields.push_back(field);
+        lengths.push_back(out - field);
+        *out = '\0';
+        if(current == last) return true;
+        ++current;
+    }
+}
+
+static void parseCsv(const RowCodec& codec, bool skipFirst, LoadChunk& chunk){
+    int32_t columnCount = codec.columnCount();
+    int32_t rowSize = codec.rowSize;
+
+    // Spare byte terminates last field of file
+    chunk.data.push_back('\0');
+    char* data = chunk.data.data();
+    int64_t size = chunk.data.size() - 1;
+    chunk.rows.assign((size / (2 * columnCount) + 1) * rowSize, '\0');
+
+    std::vector<const char*> fields;
+    std::vector<int32_t> lengths;
+    Value value;
+    int64_t line = chunk.firstLine;
+    int64_t position = 0;
+    while(position < size){
+        // Record ends at first newline outside quotes
+        bool quoted = false;
+        int64_t newlines = 0;
+        int64_t end = position;
+        for(; end < size; ++end){
+            char c = data[end];
+            if(c == '"') quoted = !quoted;
+            else if(c == '\n'){
+                if(!quoted) break;
+                ++newlines;
+            }
+        }
+        int64_t recordLine = line;
+        line += newlines + 1;
+        int64_t next = end + 1;
+        if(end > position && data[end - 1] == '\r') --end;
+        if(end == position || skipFirst){
+            skipFirst = skipFirst && end == position;
+            position = next;
+            continue;
+        }
+
+        chunk.errorLine = recordLine;
+        if(quoted || !splitRecord(data + position, data + end, fields, lengths)){
+            chunk.result = LoadResult::malformed;
+            return;
+        }
+        if(fields.size() != columnCount){
+            chunk.result = LoadResult::columnCountMismatch;
+            chunk.fieldCount = fields.size();
+            return;
+        }
+        if((chunk.count + 1) * static_cast<int64_t>(rowSize) > chunk.rows.size()){
+            chunk.rows.resize(2 * chunk.rows.size(), '\0');
+        }
+        char* row = chunk.rows.data() + chunk.count * static_cast<int64_t>(rowSize);
+        for(int32_t col = 0; col < columnCount; ++col){
+            chunk.codecResult = codec.parse(col, fields[col], lengths[col], value);
+            if(chunk.codecResult != CodecResult::success){
+                chunk.result = LoadResult::invalidValue;
+                return;
+            }
+            codec.set(row, col, value);
+        }
+        ++chunk.count;
+        position = next;
+    }
+}
+
+static void parseBinary(const RowCodec& codec, LoadChunk& chunk){
+    int32_t columnCount = codec.columnCount();
+    int32_t rowSize = codec.rowSize;
+    int32_t recordSize = codec.pkeyOffset;
+    int64_t records = chunk.data.size() / recordSize;
+    chunk.rows.assign(records * rowSize, '\0');
+    for(int64_t r = 0; r < records; ++r){
+        const char* record = chunk.data.data() + r * recordSize;
+        for(int32_t col = 0; col < columnCount; ++col){
+            if(codec.types[col] == DataType::Bool && static_cast<unsigned char>(record[codec.offsets[col]]) > 1){
+                chunk.result = LoadResult::invalidValue;
+                chunk.codecResult = CodecResult::typeMismatch;
+                chunk.errorLine = chunk.firstLine + r;
+                return;
+            }
+        }
+        memcpy(chunk.rows.data() + r * rowSize, record, recordSize);
+        ++chunk.count;
+    }
+    if(records * recordSize != chunk.data.size()){
+        chunk.result = LoadResult::malformed;
+        chunk.errorLine = chunk.firstLine + records;
+    }
+}
+
+// =============================================
+//                 BULK LOADER
+// =============================================
+
+BulkLoader::BulkLoader(Table* table_){
+    this->table = table_;
+    this->rowsPerPage = table->getRowsPerPage();
+    this->rowSize = table->getRowSize();
+    this->freeRows = table->getRowSlots() - table->getRowCount();
+    this->endSlot = table->getRowSlots();
+    this->nextPKey = table->nextPKey;
+    this->count = 0;
+    this->page = nullptr;
+    this->firstNewPage = (endSlot + rowsPerPage - 1) / rowsPerPage + 1;
+    this->runStart = 0;
+    this->runPages = 0;
+    this->entries.resize(table->indexed.size());
+}
+
+bool BulkLoader::append(const char* row){
+    row_t slot;
+    if(freeRows > 0){
+        --freeRows;
+        slot = table->nextFreeRowLocation();
+        if(slot == -1) return false;
+    }
+    else{
+        slot = endSlot++;
+    }
+
+    // Rows go to consecutive slots so page changes only once every rowsPerPage rows
+    int32_t pageNum = slot / rowsPerPage + 1;
+    char* pageBuffer;
+    if(pageNum >= firstNewPage){
+        if(run == nullptr){
+            run = std::make_unique<char[]>(LOAD_WRITE_PAGES * PAGE_SIZE);
+            memset(run.get(), 0, LOAD_WRITE_PAGES * PAGE_SIZE);
+            runStart = pageNum;
+        }
+        if(pageNum - runStart == LOAD_WRITE_PAGES){
+            if(!flushRun()) return false;
+            runStart = pageNum;
+        }
+        runPages = pageNum - runStart + 1;
+        pageBuffer = run.get() + (pageNum - runStart) * PAGE_SIZE;
+    }
+    else{
+        if(page == nullptr || page->pageNum != pageNum){
+            page = table->pager->read(pageNum);
+            if(page == nullptr) return false;
+        }
+        page->hasUncommitedChanges = true;
+        pageBuffer = page->buffer.get();
+    }
+    char* buffer = pageBuffer + (slot % rowsPerPage) * rowSize;
+    memcpy(buffer, row, rowSize);
+    pkey_t pkey = nextPKey + count;
+    table->codec.setPKey(buffer, pkey);
+    ++count;
+
+    int32_t entrySize = sizeof(pkey_t) + sizeof(row_t);
+    for(int32_t i = 0; i < table->indexed.size(); ++i){
+        if(!table->indexed[i]) continue;
+        auto& runs = entries[i];
+        int64_t width = table->columnSizes[i] + entrySize;
+        if(runs.empty() || runs.back().size() >= LOAD_RUN_ROWS * width){
+            runs.emplace_back();
+            runs.back().reserve(LOAD_RUN_ROWS * width);
+        }
+        const char* cell = table->codec.cell(buffer, i);
+        auto& entry = runs.back();
+        entry.insert(entry.end(), cell, cell + table->columnSizes[i]);
+        entry.insert(entry.end(), (const char*)&pkey, (const char*)&pkey + sizeof(pkey_t));
+        entry.insert(entry.end(), (const char*)&slot, (const char*)&slot + sizeof(row_t));
+    }
+    table->stats.recordInsert(table->codec, buffer);
+    return true;
+}
+
+bool BulkLoader::flushRun(){
+    if(runPages == 0) return true;
+    if(!table->pager->writeRun(runStart, run.get(), runPages)) return false;
+    memset(run.get(), 0, runPages * PAGE_SIZE);
+    runPages = 0;
+    return true;
+}
+
+bool BulkLoader::finish(){
+    bool res = flushRun();
+    if(count > 0) table->increaseRowCount(count);
+    for(int32_t i = 0; i < table->indexed.size(); ++i){
+        if(!table->indexed[i] || entries[i].empty()) continue;
+        if(!table->trees[i]->insertCells(entries[i])) res = false;
+        entries[i].clear();
+    }
+    return res;
+}
+
+row_t BulkLoader::rowCount() const{
+    return count;
+}
+
+// =============================================
+//               PARALLEL LOADER
+// =============================================
+
+ParallelLoader::ParallelLoader(Table* table_){
+    this->table = table_;
+    this->count = 0;
+    this->errorLine = 0;
+    this->fieldCount = 0;
+    this->codecResult = CodecResult::success;
+}
+
+LoadResult ParallelLoader::run(const std::string& fileName, LoadFormat format, bool header){
+    const RowCodec& codec = table->codec;
+    ChunkReader reader(fileName, format, codec.pkeyOffset);
+    if(!reader.isOpen()) return LoadResult::cannotOpen;
+
+    int32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    int64_t window = static_cast<int64_t>(threadCount) * LOAD_CHUNKS_PER_THREAD;
+
+    // readMutex guards reader and nextSequence. Rest is guarded by doneMutex
+    std::mutex readMutex;
+    std::mutex doneMutex;
+    std::condition_variable doneChanged;
+    int64_t nextSequence = 0;
+    int64_t written = 0;
+    int64_t total = -1;                 // Number of chunks once reader is exhausted
+    bool stop = false;
+    std::map<int64_t, std::unique_ptr<LoadChunk>> done;
+
+    auto worker = [&](){
+        while(true){
+            auto chunk = std::make_unique<LoadChunk>();
+            {
+                std::lock_guard<std::mutex> readLock(readMutex);
+                {
+                    std::unique_lock<std::mutex> lock(doneMutex);
+                    doneChanged.wait(lock, [&]{ return stop || total != -1 || nextSequence < written + window; });
+                    if(stop || total != -1) return;
+                }
+                bool failed;
+                bool more = reader.next(*chunk, failed);
+                if(!more && !failed){
+                    std::lock_guard<std::mutex> lock(doneMutex);
+                    total = nextSequence;
+                    doneChanged.notify_all();
+                    return;
+                }
+                chunk->sequence = nextSequence++;
+                if(failed){
+                    chunk->result = LoadResult::readError;
+                    chunk->errorLine = chunk->firstLine;
+                    std::lock_guard<std::mutex> lock(doneMutex);
+                    total = nextSequence;
+                    done[chunk->sequence] = std::move(chunk);
+                    doneChanged.notify_all();
+                    return;
+                }
+            }
+
+            if(format == LoadFormat::csv) parseCsv(codec, header && chunk->sequence == 0, *chunk);
+            else parseBinary(codec, *chunk);
+            std::vector<char>().swap(chunk->data);
+
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if(stop) return;
+            int64_t sequence = chunk->sequence;
+            done[sequence] = std::move(chunk);
+            doneChanged.notify_all();
+        }
+    };
+    std::vector<std::thread> threads;
+    for(int32_t i = 0; i < threadCount; ++i) threads.emplace_back(worker);
+
+    // Chunks are written in file order on calling thread
+    BulkLoader loader(table);
+    LoadResult res = LoadResult::success;
+    int32_t rowSize = codec.rowSize;
+    while(res == LoadResult::success){
+        std::unique_ptr<LoadChunk> chunk;
+        {
+            std::unique_lock<std::mutex> lock(doneMutex);
+            doneChanged.wait(lock, [&]{ return done.count(written) > 0 || written == total; });
+            if(written == total) break;
+            chunk = std::move(done[written]);
+            done.erase(written);
+        }
+        for(int32_t r = 0; r < chunk->count; ++r){
+            if(!loader.append(chunk->rows.data() + static_cast<int64_t>(r) * rowSize)){
+                res = LoadResult::writeError;
+                break;
+            }
+        }
+        if(res == LoadResult::success && chunk->result != LoadResult::success){
+            res = chunk->result;
+            errorLine = chunk->errorLine;
+            fieldCount = chunk->fieldCount;
+            codecResult = chunk->codecResult;
+        }
+        std::lock_guard<std::mutex> lock(doneMutex);
+        ++written;
+        doneChanged.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        stop = true;
+        doneChanged.notify_all();
+    }
+    for(auto& thread: threads) thread.join();
+
+    if(!loader.finish() && res == LoadResult::success) res = LoadResult::writeError;
+    count = loader.rowCount();
+    return res;
+}
+
+row_t ParallelLoader::rowCount() const{
+    return count;
+}
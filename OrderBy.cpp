@@ -0,0 +1,169 @@
+#include "HeaderFiles/OrderBy.h"
+
+// =============================================
+//                  ORDER PLAN
+// =============================================
+
+OrderPlan::OrderPlan(){
+    strategy = OrderStrategy::sort;
+    cost = 0;
+}
+
+std::string OrderPlan::describe(Table* table, int32_t column, bool descending, int64_t limit) const{
+    const char* name = "Sort";
+    if(strategy == OrderStrategy::indexOrder) name = "Index Order";
+    else if(strategy == OrderStrategy::topN) name = "Top-N Sort";
+
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s on %s %s (limit=%lld cost=%.2f)", name,
+             table->columnNames[column].c_str(), descending ? "desc" : "asc", static_cast<long long>(limit), cost);
+    return buffer;
+}
+
+// =============================================
+//                    TOP K
+// =============================================
+
+TopK::TopK(int64_t k_, bool descending_){
+    this->k = k_;
+    this->descending = descending_;
+}
+
+bool TopK::before(const std::pair<OwnedValue, row_t>& a, const std::pair<OwnedValue, row_t>& b) const{
+    int res = a.first.get().compare(b.first.get());
+    return descending ? res > 0 : res < 0;
+}
+
+void TopK::push(const Value& value, row_t row){
+    if(k <= 0) return;
+    auto comparator = [this](const auto& a, const auto& b){ return before(a, b); };
+    if(heap.size() < k){
+        heap.emplace_back();
+        heap.back().first.set(value);
+        heap.back().second = row;
+        std::push_heap(heap.begin(), heap.end(), comparator);
+        return;
+    }
+
+    // Only rows printed before current last one get in
+    int res = value.compare(heap.front().first.get());
+    if(descending ? res <= 0 : res >= 0) return;
+    std::pop_heap(heap.begin(), heap.end(), comparator);
+    heap.back().first.set(value);
+    heap.back().second = row;
+    std::push_heap(heap.begin(), heap.end(), comparator);
+}
+
+std::vector<row_t> TopK::sorted(){
+    std::sort_heap(heap.begin(), heap.end(), [this](const auto& a, const auto& b){ return before(a, b); });
+    std::vector<row_t> rows;
+    rows.reserve(heap.size());
+    for(auto& entry: heap) rows.push_back(entry.second);
+    heap.clear();
+    return rows;
+}
+
+// =============================================
+//                   ORDER BY
+// =============================================
+
+OrderPlan OrderBy::choose(Table* table, int32_t column, int64_t limit, const std::vector<Plan>& plans){
+    const Plan& best = plans.front();
+    double rows = table->getRowCount();
+    double slots = table->getRowSlots();
+    double heapPages = std::ceil(slots / table->getRowsPerPage());
+    double matches = best.rows;
+    double output = (limit >= 0) ? std::min<double>(limit, matches) : matches;
+
+    OrderPlan res;
+    res.strategy = OrderStrategy::sort;
+    res.scan.path = AccessPath::heapScan;
+    bool external = rows * (table->columnSizes[column] + sizeof(row_t)) > JOIN_MEMORY_BUDGET;
+    double fetchedPages = (heapPages <= DEFAULT_PAGE_LIMIT) ? std::min(output, heapPages) : output;
+    res.cost = heapPages * SEQ_PAGE_COST * (external ? 3 : 1)
+             + rows * std::max(1.0, std::log2(rows)) * CPU_ROW_COST
+             + fetchedPages * RANDOM_PAGE_COST;
+
+    if(limit >= 0 && limit < rows){
+        double cost = best.cost + matches * std::max(1.0, std::log2(limit + 1.0)) * CPU_ROW_COST
+                    + std::min(output, heapPages) * RANDOM_PAGE_COST;
+        if(cost < res.cost){
+            res.strategy = OrderStrategy::topN;
+            res.scan = best;
+            res.cost = cost;
+        }
+    }
+
+    // String B+ trees are not usable yet
+    if(table->indexed[column] && table->columnTypes[column] != DataType::String){
+        for(auto& plan: plans){
+            if(plan.path != AccessPath::indexScan || plan.index != column) continue;
+            // Scan stops once limit rows have passed predicates
+            double fraction = (limit >= 0) ? std::min(1.0, limit / std::max(1.0, plan.rows)) : 1.0;
+            double cost = plan.cost * fraction;
+            if(cost <= res.cost){
+                res.strategy = OrderStrategy::indexOrder;
+                res.scan = plan;
+                res.cost = cost;
+            }
+        }
+    }
+    return res;
+}
+
+template <typename key_t>
+bool sortedRows(Table* table, int32_t column, bool descending, const std::function<bool(row_t row)>& callback){
+    SortedRun<key_t> run;
+    if(!run.build(table, column, descending)) return false;
+    key_t key;
+    row_t row;
+    while(run.next(key, row)){
+        if(!callback(row)) return false;
+    }
+    return true;
+}
+
+bool OrderBy::execute(Table* table, int32_t column, bool descending, int64_t limit, const OrderPlan& plan,
+                      const std::vector<int32_t>& columns, int32_t position,
+                      const Filter& filter, const std::function<bool(row_t row)>& callback){
+    switch(plan.strategy){
+        case OrderStrategy::indexOrder:
+            return Planner::execute(table, plan.scan, filter, callback, descending);
+
+        case OrderStrategy::topN: {
+            TopK top(limit, descending);
+            bool applyFilter = (plan.scan.path != AccessPath::heapScan);
+            BatchScanner scanner(table, columns, [&](RowBatch& batch)->bool{
+                if(applyFilter) filter.apply(batch);
+                for(int32_t s = 0; s < batch.selected; ++s){
+                    int32_t i = batch.selection[s];
+                    top.push(batch.columns[position].get(i), batch.rows[i]);
+                }
+                return true;
+            });
+            bool res = Planner::execute(table, plan.scan, filter, [&](row_t row)->bool{
+                return scanner.push(row);
+            });
+            if(!res || !scanner.flush()) return false;
+            for(row_t row: top.sorted()){
+                if(!callback(row)) return false;
+            }
+            return true;
+        }
+
+        case OrderStrategy::sort:
+            switch(table->columnTypes[column]){
+                case DataType::Int:
+                    return sortedRows<int32_t>(table, column, descending, callback);
+                case DataType::Float:
+                    return sortedRows<float>(table, column, descending, callback);
+                case DataType::Char:
+                    return sortedRows<char>(table, column, descending, callback);
+                case DataType::Bool:
+                    return sortedRows<bool>(table, column, descending, callback);
+                case DataType::String:
+                    return sortedRows<std::string>(table, column, descending, callback);
+            }
+    }
+    return false;
+}
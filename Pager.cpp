@@ -5,14 +5,18 @@ Pager<page_t>::Pager(int pageLimit_): pageLimit(pageLimit_){
     this->fileDescriptor = -1;
     this->fileLength = 0;
     this->maxPages = 0;
+    this->log = nullptr;
+    this->logFile = 0;
 }
 
 template <typename page_t>
-Pager<page_t>::Pager(const char* fileName, int pageLimit_): pageLimit(pageLimit_){
+Pager<page_t>::Pager(const char* fileName, WriteAheadLog* log_, int64_t logOwner, int pageLimit_): pageLimit(pageLimit_){
     this->fileDescriptor = -1;
     this->fileLength = 0;
     this->maxPages = 0;
-    if(!this->open(fileName)){
+    this->log = nullptr;
+    this->logFile = 0;
+    if(!this->open(fileName, log_, logOwner)){
         throw std::runtime_error("Unable to Open Table");
     }
     this->getHeader();
@@ -31,7 +35,12 @@ int64_t Pager<page_t>::getFileLength(){
 };
 
 template <typename page_t>
-bool Pager<page_t>::open(const char* fileName){
+uint32_t Pager<page_t>::getLogFile() const{
+    return this->logFile;
+}
+
+template <typename page_t>
+bool Pager<page_t>::open(const char* fileName, WriteAheadLog* log_, int64_t logOwner){
     int openFlags = O_RDWR | O_CREAT;
     mode_t filePerms = S_IWUSR | S_IRUSR;
     int fd = ::open(fileName, openFlags, filePerms);
@@ -41,9 +50,35 @@ bool Pager<page_t>::open(const char* fileName){
     off_t fileLength_ = lseek(fd, 0, SEEK_END);
     this->fileDescriptor = fd;
     this->fileLength = static_cast<int64_t>(fileLength_);
+    this->log = log_;
+    if(log != nullptr) this->logFile = log->attach(fileName, logOwner);
     return true;
 }
 
+template <typename page_t>
+int32_t Pager<page_t>::pageCount(){
+    off_t fileLength_ = lseek(fileDescriptor, 0, SEEK_END);
+    this->maxPages = (fileLength_ + PAGE_SIZE - 1) / PAGE_SIZE;
+    if(log != nullptr) this->maxPages = log->pageCount(logFile, maxPages);
+    this->fileLength = static_cast<int64_t>(maxPages) * PAGE_SIZE;
+    return this->maxPages;
+}
+
+template <typename page_t>
+bool Pager<page_t>::readPage(int32_t pageNum, char* buffer){
+    if(log != nullptr && log->readPage(logFile, pageNum, buffer)) return true;
+    ssize_t bytesRead = pread(fileDescriptor, buffer, PAGE_SIZE, static_cast<off_t>(pageNum) * PAGE_SIZE);
+    return bytesRead != -1;
+}
+
+template <typename page_t>
+bool Pager<page_t>::writePage(int32_t pageNum, const char* buffer){
+    if(this->fileDescriptor == -1) return false;
+    if(log != nullptr) return log->writePage(logFile, pageNum, buffer);
+    ssize_t bytesWritten = pwrite(fileDescriptor, buffer, PAGE_SIZE, static_cast<off_t>(pageNum) * PAGE_SIZE);
+    return bytesWritten == PAGE_SIZE;
+}
+
 template <typename page_t>
 bool Pager<page_t>::close(){
     if(this->fileDescriptor == -1) return false;
@@ -61,12 +96,8 @@ bool Pager<page_t>::close(){
 template <typename page_t>
 bool Pager<page_t>::getHeader(){
     header = std::make_unique<page_t>();
-    this->fileLength = static_cast<uint32_t>(lseek(fileDescriptor, 0, SEEK_END));
-    this->maxPages = (this->fileLength + PAGE_SIZE - 1) / PAGE_SIZE;
-    if(maxPages > 0){
-        lseek(fileDescriptor, 0, SEEK_SET);
-        ssize_t bytesRead = ::read(fileDescriptor, header->buffer.get(), PAGE_SIZE);
-        if(bytesRead == -1){
+    if(pageCount() > 0){
+        if(!readPage(0, header->buffer.get())){
             printf("Error reading Header: %d\n", errno);
             return false;
         }
@@ -84,14 +115,10 @@ page_t* Pager<page_t>::read(uint32_t pageNum, std::function<void(page_t*)> callb
         // Cache miss. Allocate memory and load from file.
         page = std::make_unique<page_t>();
         page->pageNum = pageNum;
-        this->fileLength = static_cast<uint32_t>(lseek(fileDescriptor, 0, SEEK_END));
-        this->maxPages = (this->fileLength + PAGE_SIZE - 1) / PAGE_SIZE;
 
-        if(pageNum < maxPages){
+        if(pageNum < pageCount()){
             // This page reside in memory so read it
-            lseek(fileDescriptor, pageNum * PAGE_SIZE, SEEK_SET);
-            ssize_t bytesRead = ::read(fileDescriptor, page->buffer.get(), PAGE_SIZE);
-            if(bytesRead == -1){
+            if(!readPage(pageNum, page->buffer.get())){
                 printf("Error reading file: %d\n", errno);
                 return nullptr;
             }
@@ -100,12 +127,7 @@ page_t* Pager<page_t>::read(uint32_t pageNum, std::function<void(page_t*)> callb
 
         // Handle Page Queue
         if (pageQueue.size() >= pageLimit) {
-            auto it = std::move(pageQueue.back());
-            if(it->hasUncommitedChanges){
-                this->flushPage(it.get());
-            }
-            pageQueue.pop_back();
-            pageMap.erase(it->pageNum);
+            evictPage();
         }
     }
     else{
@@ -117,6 +139,26 @@ page_t* Pager<page_t>::read(uint32_t pageNum, std::function<void(page_t*)> callb
     return pageQueue.begin()->get();
 }
 
+/// This removes least recently used page from cache
+/// Pinned pages and pages for which canEvict() returns false get one more trip through the queue
+template <typename page_t>
+void Pager<page_t>::evictPage(){
+    while(pageQueue.back()->pinCount > 0 || !this->canEvict(pageQueue.back().get())){
+        pageQueue.splice(pageQueue.begin(), pageQueue, std::prev(pageQueue.end()));
+    }
+    auto it = std::move(pageQueue.back());
+    if(it->hasUncommitedChanges){
+        this->flushPage(it.get());
+    }
+    pageQueue.pop_back();
+    pageMap.erase(it->pageNum);
+}
+
+template <typename page_t>
+bool Pager<page_t>::canEvict(page_t* page){
+    return true;
+}
+
 /// This flushes the given page to storage if it is open
 template <typename page_t>
 bool Pager<page_t>::flush(uint32_t pageNum){
@@ -147,12 +189,73 @@ bool Pager<page_t>::flushAll(){
     return true;
 }
 
+template <typename page_t>
+bool Pager<page_t>::flushChanges(){
+    if(this->fileDescriptor == -1) return false;
+    if(header != nullptr && header->hasUncommitedChanges && !flushPage(header.get())) return false;
+    for(auto& it: pageQueue){
+        if(it->hasUncommitedChanges && !flushPage(it.get())) return false;
+    }
+    return true;
+}
+
+template <typename page_t>
+bool Pager<page_t>::writeBack(){
+    if(this->fileDescriptor == -1) return false;
+    if(log == nullptr) return true;
+    return log->writeBack(logFile, fileDescriptor);
+}
+
+template <typename page_t>
+bool Pager<page_t>::truncate(int32_t pages){
+    if(this->fileDescriptor == -1) return false;
+    pageQueue.clear();
+    pageMap.clear();
+    if(log != nullptr){
+        if(!log->truncate(logFile, pages)) return false;
+    }
+    else if(ftruncate(fileDescriptor, static_cast<off_t>(pages) * PAGE_SIZE) == -1) return false;
+    this->fileLength = static_cast<int64_t>(pages) * PAGE_SIZE;
+    this->maxPages = pages;
+    return true;
+}
+
+template <typename page_t>
+bool Pager<page_t>::writeRun(int32_t firstPage, const char* data, int32_t pages){
+    if(this->fileDescriptor == -1) return false;
+    for(int32_t pageNum = firstPage; pageNum < firstPage + pages; ++pageNum){
+        auto itr = pageMap.find(pageNum);
+        if(itr == pageMap.end()) continue;
+        pageQueue.erase(itr->second);
+        pageMap.erase(itr);
+    }
+    if(log != nullptr){
+        for(int32_t i = 0; i < pages; ++i){
+            if(!log->writePage(logFile, firstPage + i, data + static_cast<int64_t>(i) * PAGE_SIZE)) return false;
+        }
+    }
+    else{
+        off_t offset = lseek(fileDescriptor, static_cast<off_t>(firstPage) * PAGE_SIZE, SEEK_SET);
+        if(offset == -1) return false;
+        int64_t remaining = static_cast<int64_t>(pages) * PAGE_SIZE;
+        while(remaining > 0){
+            ssize_t bytesWritten = write(fileDescriptor, data, remaining);
+            if(bytesWritten == -1) return false;
+            data += bytesWritten;
+            remaining -= bytesWritten;
+        }
+    }
+    int64_t end = static_cast<int64_t>(firstPage + pages) * PAGE_SIZE;
+    if(end > fileLength){
+        this->fileLength = end;
+        this->maxPages = firstPage + pages;
+    }
+    return true;
+}
+
 template <typename page_t>
 bool Pager<page_t>::flushPage(page_t* page){
-    off_t offset = lseek(fileDescriptor, ((page->pageNum) * PAGE_SIZE), SEEK_SET);
-    if (offset == -1) return false;
-    ssize_t bytesWritten = write(fileDescriptor, page->buffer.get(), PAGE_SIZE);
-    if (bytesWritten == -1) return false;
+    if(!writePage(page->pageNum, page->buffer.get())) return false;
     page->hasUncommitedChanges = false;
     return true;
 }
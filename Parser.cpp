@@ -1,14 +1,24 @@
 #include <cstdio>
+#include <cctype>
 #include <cstring>
 #include <cstdlib>
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <vector>
+#include <algorithm>
+#include <list>
+#include <unordered_map>
 #include "HeaderFiles/Constants.h"
 #include "HeaderFiles/DataTypes.h"
 #include "HeaderFiles/TableManager.h"
+#include "HeaderFiles/RowBatch.h"
+#include "HeaderFiles/Planner.h"
+#include "HeaderFiles/Aggregate.h"
+#include "HeaderFiles/Loader.h"
+#include "HeaderFiles/Lexer.h"
 #include "Interface.cpp"
 
-#define MAX_FIELD_SIZE 512
 #define MAX_TABLE_NAME_LEN 50
 
 enum class StatementType{
@@ -18,7 +28,13 @@ enum class StatementType{
     remove,
     create,
     index,
-    drop
+    drop,
+    analyze,
+    join,
+    load,
+    prepare,
+    execute,
+    deallocate
 };
 
 enum class PrepareResult{
@@ -35,7 +51,8 @@ enum class PrepareResult{
     noTableName,
     noInsertData,
     noUpdateData,
-    noCondition
+    noCondition,
+    cannotPrepare
 };
 
 /*
@@ -43,13 +60,32 @@ enum class PrepareResult{
  *  create table <table-name>{<col-1>:<DATATYPE>, <col-2>:<DATATYPE>, ...}
  *  index on {<col-1>, <col-2>} in table
  *  insert into <table-name>{<col-1-data>, <col-1-data>, ...}
+ *  insert into <table-name>{<col-1-data>, ...}, {<col-1-data>, ...}, ...
+ *  load csv '<file-name>' into <table-name> [with header]
+ *  load binary '<file-name>' into <table-name>
  *  update <table-name> set {<col-1> = <data-1>, <col-1> = <data-1>, ...}
  *  update <table-name> set {<col-1> = <data-1>, <col-1> = <data-1>, ...} where <CONDITION>
  *  delete from <table-name> where <CONDITION>
  *  delete table <table-name>
  *  drop table <table-name>
- *  select (<col-1>, <col-2>, ...) from <table-name> where <CONDITION>
+ *  select {<col-1>, <col-2>, ...} from <table-name> where <CONDITION>
  *  select * from <table-name> where <CONDITION>
+ *  select {<aggregate-1>, <col-1>, ...} from <table-name> where <CONDITION> group by <col-1>
+ *  select * from <table-name> where <CONDITION> order by <col-1> [asc|desc] limit <n>
+ *  explain <select-statement>
+ *  analyze <table-name>
+ *  join <table-1>, <table-2> on <col-1> == <col-2>
+ *  prepare <name> as <insert|select|update|delete statement>
+ *  execute <name> [using <data-1>, <data-2>, ...]
+ *  deallocate <name>
+ *
+ *  ------------------------ DATA ------------------------
+ *  "<text>" or text without quotes. Data holding spaces or any of , & | } ) must be quoted
+ *  Fields are not limited in length here. Strings longer than their column are rejected on insert
+ *
+ *  --------------------- PARAMETERS ---------------------
+ *  Unquoted ? in place of a value of a prepared statement is a parameter
+ *  Parameters get data of execute in order in which they appear
  *
  *  --------------------- DATA TYPES ---------------------
  *  1. string(<length>)
@@ -67,54 +103,193 @@ enum class PrepareResult{
  *  <col-1> <= <data-1>
  *  <col-1> >= <data-1>
  *  <CONDITION> && <CONDITION>
+ *  <CONDITION> || <CONDITION>
+ *  !<CONDITION>
+ *  (<CONDITION>)
+ *  ! binds tightest, then && and then ||
+ *
+ *  --------------------- AGGREGATE ---------------------
+ *  count(*), count(<col>), sum(<col>), min(<col>), max(<col>), avg(<col>)
+ *
+ *  --------------------- META COMMANDS ---------------------
+ *  .exit
+ *  .flush
+ *  .mode <pretty|csv|tsv|binary>
+ *  .output [<file-name>]                 Result rows go to file. No file sends them back to stdout
+ *  .synchronous [off|normal|full]        How long statements wait for write-ahead log to reach disk
+ *                                        full waits for every commit, normal only for checkpoints, off never
+ *
+ *  --------------------- BATCH MODE ---------------------
+ *  DBMS --batch [<script-file>]          Runs script with one statement or meta command per line
+ *                                        Script is read from stdin when no file is given
+ *  Blank lines and lines starting with -- are skipped
+ *  Synchronous level starts at normal and tables are checkpointed at the end
+ *
+ *  --------------------- SERVER MODE ---------------------
+ *  DBMS --server <address> [--workers <n>] [--synchronous <level>]
+ *                                        Serves clients over protocol of HeaderFiles/Protocol.h
+ *                                        Address is unix:<path> or a port on 127.0.0.1
  *
  */
 
-enum class ComparisonType{
-    equal,
-    notEqual,
-    lessThan,
-    greaterThan,
-    lessThanOrEqual,
-    greaterThanOrEqual,
-    error
-};
+/// Message of statement which could not be parsed
+const char* prepareMessage(PrepareResult result){
+    switch(result){
+        case PrepareResult::success:
+            break;
+        case PrepareResult::unrecognized:
+            return "Unrecognized keyword at start of statement.";
+        case PrepareResult::syntaxError:
+            return "Syntax Error. Could not parse statement";
+        case PrepareResult::stringTooLong :
+            return "String is too long.";
+        case PrepareResult::negativeID:
+            return "ID must be positive.";
+        case PrepareResult::invalidType:
+            return "Invalid Data Type.";
+        case PrepareResult::noSizeForString:
+            return "No size provided for string.";
+        case PrepareResult::invalidOperator:
+            return "Invalid Operator";
+        case PrepareResult::comparisonOnDifferentRows:
+            return "Comparison on different rows is not allowed";
+        case PrepareResult::cannotCreateEmptyTable:
+            return "Cannot Create Empty Table. Please add some columns";
+        case PrepareResult::noTableName:
+            return "Please provide Table Name";
+        case PrepareResult::noInsertData:
+            return "No Data Provided to Insert";
+        case PrepareResult::noUpdateData:
+            return "No Data Provided to Update";
+        case PrepareResult::noCondition:
+            return "Provide Condition To Delete Selected Table using `where` clause.\n"
+                   "To delete all entries use `delete table` instead";
+        case PrepareResult::cannotPrepare:
+            return "Only insert, select, update and delete can be prepared";
+    }
+    return "";
+}
 
-ComparisonType findComparisonType(const char* op){
-    if(strcmp(op, "==") == 0){
+ComparisonType findComparisonType(std::string_view op){
+    if(op == "=="){
         return ComparisonType::equal;
     }
-    else if(strcmp(op, "!=") == 0){
+    else if(op == "!="){
         return ComparisonType::notEqual;
     }
-    else if(strcmp(op, ">") == 0){
+    else if(op == ">"){
         return ComparisonType::greaterThan;
     }
-    else if(strcmp(op, "<") == 0){
+    else if(op == "<"){
         return ComparisonType::lessThan;
     }
-    else if(strcmp(op, ">=") == 0){
+    else if(op == ">="){
         return ComparisonType::greaterThanOrEqual;
     }
-    else if(strcmp(op, "<=") == 0){
+    else if(op == "<="){
         return ComparisonType::lessThanOrEqual;
     }
     return ComparisonType::error;
 }
 
+const char* comparisonSymbol(ComparisonType type){
+    switch(type){
+        case ComparisonType::equal:
+            return "==";
+        case ComparisonType::notEqual:
+            return "!=";
+        case ComparisonType::greaterThan:
+            return ">";
+        case ComparisonType::lessThan:
+            return "<";
+        case ComparisonType::greaterThanOrEqual:
+            return ">=";
+        case ComparisonType::lessThanOrEqual:
+            return "<=";
+        case ComparisonType::error:
+            break;
+    }
+    return "?";
+}
+
+/// Comparison which holds exactly when type doesn't
+ComparisonType negateComparison(ComparisonType type){
+    switch(type){
+        case ComparisonType::equal:
+            return ComparisonType::notEqual;
+        case ComparisonType::notEqual:
+            return ComparisonType::equal;
+        case ComparisonType::greaterThan:
+            return ComparisonType::lessThanOrEqual;
+        case ComparisonType::lessThan:
+            return ComparisonType::greaterThanOrEqual;
+        case ComparisonType::greaterThanOrEqual:
+            return ComparisonType::lessThan;
+        case ComparisonType::lessThanOrEqual:
+            return ComparisonType::greaterThan;
+        case ComparisonType::error:
+            break;
+    }
+    return ComparisonType::error;
+}
+
+enum class ConditionType{
+    comparison,
+    conjunction,                        // &&
+    disjunction,                        // ||
+    negation                            // !
+};
+
+/// Node of where clause. Comparisons are leaves and other nodes combine their children
 struct Condition{
-    bool isCompound{};
+    ConditionType type{};
     std::string col;
-    std::string data1;
-    std::string data2;
-    ComparisonType compType1{};
-    ComparisonType compType2{};
+    std::string data;
+    ComparisonType compType{};
+    std::vector<Condition> children;
+    bool parameter{};                   // data is bound by execute
 };
 
+/// data of every parameter of cond in order of appearance
+void conditionParameters(Condition& cond, std::vector<std::string*>& out){
+    if(cond.type == ConditionType::comparison){
+        if(cond.parameter) out.push_back(&cond.data);
+        return;
+    }
+    for(auto& child: cond.children) conditionParameters(child, out);
+}
+
+/// Text form of condition used by explain
+std::string conditionText(const Condition& cond){
+    std::string res;
+    switch(cond.type){
+        case ConditionType::comparison:
+            res = cond.col + " " + comparisonSymbol(cond.compType) + " " + cond.data;
+            break;
+        case ConditionType::negation:
+            res = "!(" + conditionText(cond.children[0]) + ")";
+            break;
+        case ConditionType::conjunction:
+        case ConditionType::disjunction:
+            for(int32_t i = 0; i < cond.children.size(); ++i){
+                auto& child = cond.children[i];
+                if(i > 0) res += (cond.type == ConditionType::conjunction) ? " && " : " || ";
+                // || inside && needs parentheses to keep its meaning
+                bool parenthesise = (cond.type == ConditionType::conjunction && child.type == ConditionType::disjunction);
+                res += parenthesise ? "(" + conditionText(child) + ")" : conditionText(child);
+            }
+            break;
+    }
+    return res;
+}
+
 struct QueryStatement{
     std::string tableName;
     Table* table{};
     virtual ~QueryStatement() = default;
+
+    /// Values written as ? in order of appearance
+    virtual void parameters(std::vector<std::string*>&){}
 };
 
 struct CreateStatement: public QueryStatement{
@@ -124,7 +299,18 @@ struct CreateStatement: public QueryStatement{
 };
 
 struct InsertStatement: public QueryStatement{
-    std::vector<std::string> data;
+    std::vector<std::vector<std::string>> rows;
+    std::vector<std::pair<int32_t, int32_t>> parameterCells;    // (row, column) of every parameter
+
+    void parameters(std::vector<std::string*>& out) override{
+        for(auto& cell: parameterCells) out.push_back(&rows[cell.first][cell.second]);
+    }
+};
+
+struct LoadStatement: public QueryStatement{
+    std::string fileName;
+    LoadFormat format{};
+    bool header{};                      // First line holds column names and is skipped
 };
 
 struct IndexStatement: public QueryStatement{
@@ -133,27 +319,80 @@ struct IndexStatement: public QueryStatement{
 
 struct SelectStatement: public QueryStatement{
     std::vector<std::string> colNames;
+    std::vector<AggregateFunction> functions;   // One per column. none for plain columns
+    std::string groupBy;
+    std::string orderBy;
+    bool descending{};
+    int64_t limit{-1};                  // -1 => no limit
     Condition condition;
     bool selectAllRows{};
     bool selectAllCols{};
+    bool isAggregate{};
+    bool explain{};                     // Chosen plan is returned as rows instead of running it
+
+    void parameters(std::vector<std::string*>& out) override{
+        conditionParameters(condition, out);
+    }
 };
 
 struct UpdateStatement: public QueryStatement{
     std::vector<std::string> colNames;
     std::vector<std::string> colValues;
+    std::vector<int32_t> parameterValues;       // Positions in colValues of parameters
     Condition condition;
     bool updateAll{};
+
+    void parameters(std::vector<std::string*>& out) override{
+        for(int32_t i: parameterValues) out.push_back(&colValues[i]);
+        conditionParameters(condition, out);
+    }
 };
 
 struct DeleteStatement: public QueryStatement{
     Condition condition;
     bool deleteAll{};
+
+    void parameters(std::vector<std::string*>& out) override{
+        conditionParameters(condition, out);
+    }
 };
 
 struct DropStatement:   public QueryStatement{
 
 };
 
+struct AnalyzeStatement: public QueryStatement{
+
+};
+
+struct JoinStatement: public QueryStatement{
+    std::string otherTableName;
+    std::string column;
+    std::string otherColumn;
+};
+
+/// Statement parsed once and executed again with new parameter values
+struct PreparedStatement{
+    StatementType type{};
+    std::unique_ptr<QueryStatement> statement;
+    std::vector<std::string*> parameters;
+};
+
+struct PrepareStatement: public QueryStatement{
+    std::string name;
+    std::string text;                   // Statement without `prepare <name> as`
+    PreparedStatement prepared;
+};
+
+struct ExecuteStatement: public QueryStatement{
+    std::string name;
+    std::vector<std::string> values;
+};
+
+struct DeallocateStatement: public QueryStatement{
+    std::string name;
+};
+
 void release(std::vector<void*>& data, std::vector<DataType>& type, std::vector<uint32_t>& size){
     for(int i = 0; i < data.size(); ++i){
         if(data[i] == nullptr) return;
@@ -171,7 +410,6 @@ void release(std::vector<void*>& data, std::vector<DataType>& type, std::vector<
                 delete (bool*)data[i];
                 break;
             case DataType::String:
-                uint32_t len = size[i] + 1;
                 delete[] static_cast<char*>(data[i]);
                 break;
         }
@@ -179,7 +417,7 @@ void release(std::vector<void*>& data, std::vector<DataType>& type, std::vector<
 }
 
 class Parser{
-    char tableName[MAX_TABLE_NAME_LEN]{};
+    friend class StatementCache;
 
 public:
     StatementType type;
@@ -188,388 +426,345 @@ public:
     Parser() = default;
 
     PrepareResult parse(InputBuffer &inputBuffer){
-        PrepareResult res;
-        if(strncmp(inputBuffer.buffer.c_str(), "insert into", 11) == 0) {
-            res = parseInsert(inputBuffer);
-        }
-        else if(strncmp(inputBuffer.buffer.c_str(), "select", 6) == 0) {
-            res = parseSelect(inputBuffer);
-        }
-        else if(strncmp(inputBuffer.buffer.c_str(), "create table", 12) == 0){
-            res = parseCreate(inputBuffer);
-        }
-        else if(strncmp(inputBuffer.buffer.c_str(), "index on", 8) == 0){
-            res = parseIndex(inputBuffer);
-        }
-        else if(strncmp(inputBuffer.buffer.c_str(), "update", 6) == 0){
-            res = parseUpdate(inputBuffer);
-        }
-        else if(strncmp(inputBuffer.buffer.c_str(), "delete from", 11) == 0){
-            res = parseDelete(inputBuffer);
-        }
-        else if(strncmp(inputBuffer.buffer.c_str(), "delete table", 12) == 0){
-            res = parseDeleteAll(inputBuffer);
-        }
-        else if(strncmp(inputBuffer.buffer.c_str(), "drop table", 10) == 0){
-            res = parseDrop(inputBuffer);
-        }
-        else{
-            res = PrepareResult::unrecognized;
-        }
-        if(res == PrepareResult::success) statement->tableName = tableName;
-        return res;
+        return parse(std::string_view(inputBuffer.buffer));
     }
 
-private:
-    bool getTableName(const char** ptr, const std::string& prefix){
-        int n = 0;
-        std::string formatString = prefix + " %255[^ \t\n{] %n";
-        if(sscanf(*ptr, formatString.c_str(), tableName, &n) != 1){
-            return false;
+    PrepareResult parse(std::string_view text){
+        Lexer lexer(text);
+        Token keyword = lexer.next();
+        if(keyword.type != TokenType::word) return PrepareResult::unrecognized;
+
+        if(keyword.text == "insert") return parseInsert(lexer);
+        if(keyword.text == "select") return parseSelect(lexer);
+        if(keyword.text == "create") return parseCreate(lexer);
+        if(keyword.text == "index") return parseIndex(lexer);
+        if(keyword.text == "update") return parseUpdate(lexer);
+        if(keyword.text == "delete") return parseDelete(lexer);
+        if(keyword.text == "drop") return parseDrop(lexer);
+        if(keyword.text == "explain") return parseExplain(lexer);
+        if(keyword.text == "analyze") return parseAnalyze(lexer);
+        if(keyword.text == "join") return parseJoin(lexer);
+        if(keyword.text == "load") return parseLoad(lexer);
+        if(keyword.text == "prepare") return parsePrepare(lexer);
+        if(keyword.text == "execute") return parseExecute(lexer);
+        if(keyword.text == "deallocate") return parseDeallocate(lexer);
+        return PrepareResult::unrecognized;
+    }
+
+    /// Parses text of a statement that may hold parameters
+    static PrepareResult prepare(const std::string& text, PreparedStatement& prepared){
+        Parser parser;
+        auto res = parser.parse(std::string_view(text));
+        if(res != PrepareResult::success) return res;
+        switch(parser.type){
+            case StatementType::insert:
+            case StatementType::select:
+            case StatementType::update:
+            case StatementType::remove:
+                break;
+            default:
+                return PrepareResult::cannotPrepare;
         }
-        (*ptr) += n;
-        return true;
+        prepared.type = parser.type;
+        prepared.statement = std::move(parser.statement);
+        prepared.parameters.clear();
+        prepared.statement->parameters(prepared.parameters);
+        return PrepareResult::success;
     }
 
+private:
     // HELPER FUNCTIONS
-    static inline bool checkOpeningBrace(const char** ptr){
-        int n = 0;
-        char val[2];
-        if(sscanf(*ptr, " %1[{] %n", val, &n) != 1){
-            return false;
-        }
-        (*ptr) += n;
-        return true;
+    static PrepareResult getTableName(Lexer& lexer, std::string& name){
+        Token token = lexer.next();
+        if(token.type != TokenType::word) return PrepareResult::noTableName;
+        if(token.text.size() >= MAX_TABLE_NAME_LEN) return PrepareResult::stringTooLong;
+        name.assign(token.text);
+        return PrepareResult::success;
     }
-    static inline bool parseFormatString(const char** ptr, char* field, const char* formatString){
-        int n = 0;
-        if(sscanf(*ptr, formatString, field, &n) != 1) return false;
-        (*ptr) += n;
+
+    static inline bool getWord(Lexer& lexer, std::string_view& word){
+        Token token = lexer.next();
+        if(token.type != TokenType::word) return false;
+        word = token.text;
         return true;
     }
-    static inline bool getNextValue(const char** ptr, char* field){
-        int n = 0;
-        char val[2];
-        // Get Opening quote
-        if(sscanf(*ptr, " %1[\"]%n", val, &n) != 1){
-            // Value without opening brace
-            sscanf(*ptr, "%255[^,&}) \t\n]s%n", field, &n);
-            (*ptr) += n;
-            return true;
-        };
-        (*ptr) += n;
-
-        // Get String
-        sscanf(*ptr, "%255[^\"]%n", field, &n);
-        (*ptr) += n;
-
-        // Get Closing quote
-        if(sscanf(*ptr, "%1[\"]%n ", val, &n) != 1) return false;
-        (*ptr) += n;
 
+    /// placeholder is set when value is an unquoted ?
+    static inline bool getNextValue(Lexer& lexer, std::string& field, bool* placeholder = nullptr){
+        Token token = lexer.value();
+        if(token.type == TokenType::error) return false;
+        if(token.type == TokenType::word && token.text.empty()) return false;
+        if(placeholder != nullptr) *placeholder = (token.type == TokenType::word && token.text == "?");
+        field.assign(token.text);
         return true;
     }
-    static inline bool getSeperator(const char** ptr, char* val){
-        int n = 0;
-        if(sscanf(*ptr, " %1s %n", val, &n) != 1) return false;
-        (*ptr) += n;
-        return true;
+
+    static inline bool toInteger(std::string_view text, int64_t& value){
+        auto res = std::from_chars(text.data(), text.data() + text.size(), value);
+        return res.ec == std::errc() && res.ptr == text.data() + text.size();
     }
 
-    PrepareResult parseCreate(InputBuffer& inputBuffer){
+    PrepareResult parseCreate(Lexer& lexer){
         // SYNTAX:- create table <table-name>{<col-1>:<DATATYPE>, <col-2>:<DATATYPE>, ...}
         this->type = StatementType::create;
-        const char *ptr = inputBuffer.str();
-        std::vector<std::string> colNames;
-        std::vector<DataType> colTypes;
-        std::vector<uint32_t> colSize;
-        char name[50], type[20];
-        int n;
-        if(sscanf(ptr, "create table %50[^ \n\t{] { %n", tableName, &n) != 1){
-            return PrepareResult::noTableName;
-        }
-        ptr += n;
-        int col = 0;
-        while(sscanf(ptr, " %255[^: \t\n] %n", name, &n) == 1){
-            ptr += n;
-            ++col;
-            if(*ptr != ':'){
-                return PrepareResult::syntaxError;
-            }
-            ptr++;
-            if(sscanf(ptr, " %19[^, }] %n", type, &n) != 1){
-                return PrepareResult::syntaxError;
-            }
-
-            colNames.push_back(name);
-            if(strcmp(type, "int") == 0){
-                colTypes.push_back(DataType::Int);
-                colSize.push_back(4);
+        if(!lexer.accept("table")) return PrepareResult::syntaxError;
+        auto createStatement = std::make_unique<CreateStatement>();
+        auto res = getTableName(lexer, createStatement->tableName);
+        if(res != PrepareResult::success) return res;
+        if(!lexer.accept("{")) return PrepareResult::syntaxError;
+        if(lexer.accept("}")) return PrepareResult::cannotCreateEmptyTable;
+
+        do{
+            std::string_view name, type;
+            if(!getWord(lexer, name)) return PrepareResult::syntaxError;
+            if(name.size() > MAX_COLUMN_SIZE) return PrepareResult::stringTooLong;
+            if(!lexer.accept(":")) return PrepareResult::syntaxError;
+            if(!getWord(lexer, type)) return PrepareResult::syntaxError;
+
+            createStatement->colNames.emplace_back(name);
+            if(type == "int"){
+                createStatement->colTypes.push_back(DataType::Int);
+                createStatement->colSize.push_back(4);
             }
-            else if(strcmp(type, "float") == 0){
-                colTypes.push_back(DataType::Float);
-                colSize.push_back(4);
+            else if(type == "float"){
+                createStatement->colTypes.push_back(DataType::Float);
+                createStatement->colSize.push_back(4);
             }
-            else if(strcmp(type, "bool") == 0){
-                colTypes.push_back(DataType::Bool);
-                colSize.push_back(1);
+            else if(type == "bool"){
+                createStatement->colTypes.push_back(DataType::Bool);
+                createStatement->colSize.push_back(1);
             }
-            else if(strcmp(type, "char") == 0){
-                colTypes.push_back(DataType::Char);
-                colSize.push_back(1);
+            else if(type == "char"){
+                createStatement->colTypes.push_back(DataType::Char);
+                createStatement->colSize.push_back(1);
             }
-            else if(strncmp(type, "string", 6) == 0){
-                int end;
-                int len;
-                if(sscanf(type, " string( %d %n", &len, &end) != 1){
-                    return PrepareResult::syntaxError;
-                }
-                if(*(type + end) != ')'){
-                    return PrepareResult::syntaxError;
-                }
-                colTypes.push_back(DataType::String);
-                colSize.push_back(len);
+            else if(type == "string"){
+                // string(<length>)
+                std::string_view size;
+                int64_t len;
+                if(!lexer.accept("(")) return PrepareResult::noSizeForString;
+                if(!getWord(lexer, size) || !toInteger(size, len) || len <= 0) return PrepareResult::syntaxError;
+                if(len > PAGE_SIZE) return PrepareResult::stringTooLong;
+                if(!lexer.accept(")")) return PrepareResult::syntaxError;
+                createStatement->colTypes.push_back(DataType::String);
+                createStatement->colSize.push_back(len);
             }
             else{
                 return PrepareResult::invalidType;
             }
-            ptr += n;
-            if(*ptr == '}'){
-                break;
-            }
-            ++ptr;
-        }
-        if(col == 0){
-            return PrepareResult::cannotCreateEmptyTable;
-        }
-        auto createStatement = std::make_unique<CreateStatement>();
-        createStatement->colNames = std::move(colNames);
-        createStatement->colTypes = std::move(colTypes);
-        createStatement->colSize  = std::move(colSize);
+        }while(lexer.accept(","));
+        if(!lexer.accept("}") || !lexer.atEnd()) return PrepareResult::syntaxError;
+
         this->statement = std::move(createStatement);
         return PrepareResult::success;
     }
 
-    PrepareResult parseIndex(InputBuffer& inputBuffer){
+    PrepareResult parseIndex(Lexer& lexer){
         // SYNTAX:- index on {<col-1>, <col-2>} in table;
         this->type = StatementType::index;
-        const char *ptr = inputBuffer.str() + 8;
-        std::vector<std::string> colNames;
-        char colName[MAX_COLUMN_SIZE];
-        char seperator[3];
-        if(!checkOpeningBrace(&ptr)) return PrepareResult::syntaxError;
-        int n = 0;
-        while(true){
-            // Get String
-            if(sscanf(ptr, "%255[^ \t\n,}]%n", colName, &n) != 1) return PrepareResult::syntaxError;
-            ptr += n;
-            printw("Indexing On: %s\n", colName);
-            colNames.emplace_back(colName);
-            if(!getSeperator(&ptr, seperator)) return PrepareResult::syntaxError;
-            if(seperator[0] == ',') continue;
-            if(seperator[0] == '}') break;
-            else return PrepareResult::syntaxError;
-        }
-        if(!getTableName(&ptr, "in")) return PrepareResult::noTableName;
-
         auto indexStatement = std::make_unique<IndexStatement>();
-        indexStatement->colNames = std::move(colNames);
+        if(!lexer.accept("on") || !lexer.accept("{")) return PrepareResult::syntaxError;
+        do{
+            std::string_view colName;
+            if(!getWord(lexer, colName)) return PrepareResult::syntaxError;
+            indexStatement->colNames.emplace_back(colName);
+        }while(lexer.accept(","));
+        if(!lexer.accept("}")) return PrepareResult::syntaxError;
+
+        if(!lexer.accept("in")) return PrepareResult::noTableName;
+        auto res = getTableName(lexer, indexStatement->tableName);
+        if(res != PrepareResult::success) return res;
+        if(!lexer.atEnd()) return PrepareResult::syntaxError;
+
         this->statement = std::move(indexStatement);
         return PrepareResult::success;
     }
 
-    PrepareResult parseInsert(InputBuffer& inputBuffer){
-        // SYNTAX :- insert into <table-name>{<col-1-data>, <col-1-data>, ...}
+    PrepareResult parseInsert(Lexer& lexer){
+        // SYNTAX :- insert into <table-name>{<col-1-data>, <col-1-data>, ...}, {<col-1-data>, ...}, ...
         this->type = StatementType::insert;
-        const char *ptr = inputBuffer.str();
-        char field[MAX_FIELD_SIZE + 1];
-        char seperator[2];
-        std::vector<std::string> data;
-
-        if(!getTableName(&ptr, "insert into")) return PrepareResult::noTableName;
-        if(!Parser::checkOpeningBrace(&ptr)) return PrepareResult::syntaxError;
-
-        while(true){
-            if(!getNextValue(&ptr, field)){
-                if(data.empty()) return PrepareResult::noInsertData;
-                return PrepareResult::syntaxError;
-            }
-            printw("Parsed Field : \"%s\"\n", field);
-
-            data.emplace_back(field);
+        if(!lexer.accept("into")) return PrepareResult::syntaxError;
+        auto insertStatement = std::make_unique<InsertStatement>();
+        auto res = getTableName(lexer, insertStatement->tableName);
+        if(res != PrepareResult::success) return res;
+
+        auto& rows = insertStatement->rows;
+        bool placeholder;
+        do{
+            if(!lexer.accept("{")) return PrepareResult::syntaxError;
+            std::vector<std::string> data;
+            do{
+                data.emplace_back();
+                if(!getNextValue(lexer, data.back(), &placeholder)){
+                    if(data.size() == 1) return PrepareResult::noInsertData;
+                    return PrepareResult::syntaxError;
+                }
+                if(placeholder) insertStatement->parameterCells.emplace_back(rows.size(), data.size() - 1);
+            }while(lexer.accept(","));
+            if(!lexer.accept("}")) return PrepareResult::syntaxError;
+            rows.emplace_back(std::move(data));
 
-            if(!getSeperator(&ptr, seperator)) return PrepareResult::syntaxError;
-            if(seperator[0] == ',') continue;
-            if(seperator[0] == '}') break;
-            else return PrepareResult::syntaxError;
-        }
+            // Another row follows a comma
+        }while(lexer.accept(","));
+        if(!lexer.atEnd()) return PrepareResult::syntaxError;
 
-        auto insertStatement = std::make_unique<InsertStatement>();
-        insertStatement->data = std::move(data);
         this->statement = std::move(insertStatement);
+        return PrepareResult::success;
+    }
 
+    PrepareResult parseLoad(Lexer& lexer){
+        // SYNTAX :- load csv '<file-name>' into <table-name> [with header]
+        //           load binary '<file-name>' into <table-name>
+        this->type = StatementType::load;
+        auto loadStatement = std::make_unique<LoadStatement>();
+        if(lexer.accept("csv")) loadStatement->format = LoadFormat::csv;
+        else if(lexer.accept("binary")) loadStatement->format = LoadFormat::binary;
+        else return PrepareResult::syntaxError;
+
+        Token fileName = lexer.next();
+        if(fileName.type != TokenType::file || fileName.text.empty()) return PrepareResult::syntaxError;
+        loadStatement->fileName.assign(fileName.text);
+
+        if(!lexer.accept("into")) return PrepareResult::noTableName;
+        auto res = getTableName(lexer, loadStatement->tableName);
+        if(res != PrepareResult::success) return res;
+
+        if(loadStatement->format == LoadFormat::csv && lexer.accept("with")){
+            if(!lexer.accept("header")) return PrepareResult::syntaxError;
+            loadStatement->header = true;
+        }
+        if(!lexer.atEnd()) return PrepareResult::syntaxError;
+        this->statement = std::move(loadStatement);
         return PrepareResult::success;
     }
 
-    PrepareResult parseUpdate(InputBuffer& inputBuffer){
-        // SYNTAX:- update <table-name> {<col-1> = <data-1>, <col-1> = <data-1>, ...}
-        //          update <table-name> {<col-1> = <data-1>, <col-1> = <data-1>, ...} where <CONDITION>
+    PrepareResult parseUpdate(Lexer& lexer){
+        // SYNTAX:- update <table-name> [set] {<col-1> = <data-1>, <col-1> = <data-1>, ...}
+        //          update <table-name> [set] {<col-1> = <data-1>, <col-1> = <data-1>, ...} where <CONDITION>
         this->type = StatementType::update;
-
-        const char *ptr = inputBuffer.str();
-        std::vector<std::string> colNames;
-        std::vector<std::string> colValues;
-        char colName[MAX_FIELD_SIZE + 1];
-        char colValue[MAX_FIELD_SIZE + 1];
-        char seperator[20];
-        char colFormatStr[] = " %255[^=} \t\n] %n";
-        int col = 0;
-
-        if(!getTableName(&ptr, "update")) return PrepareResult::noTableName;
-        if(!Parser::checkOpeningBrace(&ptr)) return PrepareResult::syntaxError;
-
-        while(true) {
+        auto updateStatement = std::make_unique<UpdateStatement>();
+        auto res = getTableName(lexer, updateStatement->tableName);
+        if(res != PrepareResult::success) return res;
+        lexer.accept("set");
+        if(!lexer.accept("{")) return PrepareResult::syntaxError;
+        if(lexer.accept("}")) return PrepareResult::noUpdateData;
+
+        bool placeholder;
+        do{
             // Get Column Name
-            if(!parseFormatString(&ptr, colName, colFormatStr)){
-                if(col == 0){return PrepareResult::noUpdateData;}
-                return PrepareResult::syntaxError;
-            }
-
-            // Get '=' seperator
-            if(!getSeperator(&ptr, seperator)) return PrepareResult::syntaxError;
-            if(seperator[0] != '=') return PrepareResult::syntaxError;
+            std::string_view colName;
+            if(!getWord(lexer, colName)) return PrepareResult::syntaxError;
+            if(!lexer.accept("=")) return PrepareResult::syntaxError;
 
             // Get Column Value
-            if(!getNextValue(&ptr, colValue)) return PrepareResult::syntaxError;
-
-            ++col;
-            colNames.emplace_back(colName);
-            colValues.emplace_back(colValue);
-            printw("Parsed Column: \"%s\" | Value: \"%s\"\n", colName, colValue);
-
-            // Get Column Seperator ',' or '}'
-            if(!getSeperator(&ptr, seperator)) return PrepareResult::syntaxError;
-            if(seperator[0] == ',') continue;
-            if(seperator[0] == '}') break;
-            else return PrepareResult::syntaxError;
-        }
-
-        auto updateStatement = std::make_unique<UpdateStatement>();
-        updateStatement->colNames = std::move(colNames);
-        updateStatement->colValues = std::move(colValues);
-
-        if(!parseFormatString(&ptr, seperator, " %20s %n")){
-            updateStatement->updateAll = true;
-        }
-        else if(strcmp(seperator, "where") == 0){
-            updateStatement->updateAll = false;
-            auto res = Parser::parseCondition(ptr, updateStatement->condition);
+            updateStatement->colValues.emplace_back();
+            if(!getNextValue(lexer, updateStatement->colValues.back(), &placeholder)) return PrepareResult::syntaxError;
+            if(placeholder) updateStatement->parameterValues.push_back(updateStatement->colNames.size());
+            updateStatement->colNames.emplace_back(colName);
+        }while(lexer.accept(","));
+        if(!lexer.accept("}")) return PrepareResult::syntaxError;
+
+        updateStatement->updateAll = !lexer.accept("where");
+        if(!updateStatement->updateAll){
+            res = parseCondition(lexer, updateStatement->condition);
             if(res != PrepareResult::success) return res;
         }
-        else{
-            return PrepareResult::syntaxError;
-        }
+        if(!lexer.atEnd()) return PrepareResult::syntaxError;
 
         this->statement = std::move(updateStatement);
         return PrepareResult::success;
     }
 
-    PrepareResult parseDelete(InputBuffer& inputBuffer){
+    PrepareResult parseDelete(Lexer& lexer){
         // SYNTAX:- delete from <table-name> where <CONDITION>
+        //          delete table <table-name>
         this->type = StatementType::remove;
-        const char *ptr = inputBuffer.str();
-        char keyword[20];
-        int n;
-
-        if(!getTableName(&ptr, "delete from")) return PrepareResult::noTableName;
         auto deleteStatement = std::make_unique<DeleteStatement>();
+        bool all = lexer.accept("table");
+        if(!all && !lexer.accept("from")) return PrepareResult::syntaxError;
+        auto res = getTableName(lexer, deleteStatement->tableName);
+        if(res != PrepareResult::success) return res;
 
-        if(!parseFormatString(&ptr, keyword, " %20s %n")) return PrepareResult::noCondition;
-        if(strcmp(keyword, "where") == 0){
-            deleteStatement->deleteAll = false;
-            auto res = Parser::parseCondition(ptr, deleteStatement->condition);
-            if(res != PrepareResult::success) return res;
+        if(all){
+            deleteStatement->deleteAll = true;
         }
         else{
-            return PrepareResult::syntaxError;
+            if(lexer.atEnd()) return PrepareResult::noCondition;
+            if(!lexer.accept("where")) return PrepareResult::syntaxError;
+            res = parseCondition(lexer, deleteStatement->condition);
+            if(res != PrepareResult::success) return res;
         }
+        if(!lexer.atEnd()) return PrepareResult::syntaxError;
 
         this->statement = std::move(deleteStatement);
         return PrepareResult::success;
     }
 
-    PrepareResult parseDeleteAll(InputBuffer& inputBuffer){
-        this->type = StatementType::remove;
-        const char *ptr = inputBuffer.str();
-        if(!getTableName(&ptr, "delete table")) return PrepareResult::noTableName;
-        auto deleteStatement = std::make_unique<DeleteStatement>();
-        deleteStatement->deleteAll = true;
-        this->statement = std::move(deleteStatement);
-        return PrepareResult::success;
-    }
-
-    PrepareResult parseDrop(InputBuffer& inputBuffer){
+    PrepareResult parseDrop(Lexer& lexer){
         // SYNTAX:- drop table <table-name>
         this->type = StatementType::drop;
-        const char *ptr = inputBuffer.str();
-        if(!getTableName(&ptr, "drop table")) return PrepareResult::noTableName;
+        if(!lexer.accept("table")) return PrepareResult::syntaxError;
         auto dropStatement = std::make_unique<DropStatement>();
+        auto res = getTableName(lexer, dropStatement->tableName);
+        if(res != PrepareResult::success) return res;
+        if(!lexer.atEnd()) return PrepareResult::syntaxError;
         this->statement = std::move(dropStatement);
         return PrepareResult::success;
     }
 
-    PrepareResult parseSelect(InputBuffer& inputBuffer){
+    PrepareResult parseSelect(Lexer& lexer){
         // SYNTAX:- select {<col-1>, <col-2>, ...} from <table-name> where <CONDITION>
         //          select * from <table-name> where <CONDITION>
         //          select {*} from <table-name> where <CONDITION>
+        //          select {<aggregate-1>, <col-1>, ...} from <table-name> where <CONDITION> group by <col-1>
+        //          select * from <table-name> where <CONDITION> order by <col-1> [asc|desc] limit <n>
         this->type = StatementType::select;
-        const char *ptr = inputBuffer.str();
-        char keyword[20];
-        int n = 0;
         auto selectStatement = std::make_unique<SelectStatement>();
 
-        sscanf(ptr, "select %n", &n);
-        ptr += n;
-
-        if( (sscanf(ptr, " %1[*] %n", keyword, &n) == 1) ||
-            (sscanf(ptr, " { %1[*] } %n", keyword, &n) == 1)){
-            ptr += n;
+        if(lexer.accept("*")){
             selectStatement->selectAllCols = true;
         }
         else{
-            if(!checkOpeningBrace(&ptr)) return PrepareResult::syntaxError;
-            selectStatement->selectAllCols = false;
-            std::vector<std::string> colNames;
-            char colName[MAX_FIELD_SIZE + 1];
-            char colFormatStr[] = " %255[^,} \t\n] %n";
-            while(true){
+            if(!lexer.accept("{")) return PrepareResult::syntaxError;
+            selectStatement->selectAllCols = lexer.accept("*");
+            while(!selectStatement->selectAllCols){
                 // Get Column Name
-                if (!parseFormatString(&ptr, colName, colFormatStr)){
-                    return PrepareResult::syntaxError;
+                std::string_view colName;
+                if(!getWord(lexer, colName)) return PrepareResult::syntaxError;
+
+                // <function>(<col>)
+                if(lexer.accept("(")){
+                    auto aggregate = findAggregateFunction(std::string(colName).c_str());
+                    if(aggregate == AggregateFunction::error) return PrepareResult::syntaxError;
+                    if(!getWord(lexer, colName) || !lexer.accept(")")) return PrepareResult::syntaxError;
+                    if(colName == "*" && aggregate != AggregateFunction::count) return PrepareResult::syntaxError;
+                    selectStatement->functions.push_back(aggregate);
+                    selectStatement->isAggregate = true;
                 }
+                else{
+                    selectStatement->functions.push_back(AggregateFunction::none);
+                }
+                selectStatement->colNames.emplace_back(colName);
 
-                colNames.emplace_back(colName);
-                printw("Parsed Column: \"%s\"\n", colName);
-
-                // Get Column Seperator ',' or '}'
-                if (!getSeperator(&ptr, keyword)) return PrepareResult::syntaxError;
-                if (keyword[0] == ',') continue;
-                if (keyword[0] == '}') break;
-                else return PrepareResult::syntaxError;
+                if(!lexer.accept(",")) break;
             }
-            selectStatement->colNames = std::move(colNames);
+            if(!lexer.accept("}")) return PrepareResult::syntaxError;
         }
 
-        if(!getTableName(&ptr, " from ")) return PrepareResult::noTableName;
-        if(!parseFormatString(&ptr, keyword, " %20s %n")){
-            selectStatement->selectAllRows = true;
-        }
-        else if(strcmp(keyword, "where") == 0){
-            selectStatement->selectAllRows = false;
-            auto res = parseCondition(ptr, selectStatement->condition);
+        if(!lexer.accept("from")) return PrepareResult::noTableName;
+        auto res = getTableName(lexer, selectStatement->tableName);
+        if(res != PrepareResult::success) return res;
+
+        selectStatement->selectAllRows = !lexer.accept("where");
+        if(!selectStatement->selectAllRows){
+            res = parseCondition(lexer, selectStatement->condition);
             if(res != PrepareResult::success) return res;
         }
-        else{
+        res = parseTrailingClauses(lexer, *selectStatement);
+        if(res != PrepareResult::success) return res;
+
+        // Groups are already printed in group order
+        if(selectStatement->isAggregate && (!selectStatement->orderBy.empty() || selectStatement->limit != -1)){
             return PrepareResult::syntaxError;
         }
 
@@ -577,79 +772,227 @@ private:
         return PrepareResult::success;
     }
 
-    static PrepareResult parseCondition(const char* ptr, Condition& cond){
-        char col1[255], col2[255];
-        char val1[255], val2[255];
-        char op1[3], op2[3];
-        char combineOperator[3];
-        int n;
-//        int count = sscanf(ptr, "%[^><=!& ] %2[><=!] \"%[^&]\" %2[&] %[^><=!& ] %2[><=!] \"%[^&\n]\" ", col1, op1, val1, combineOperator,col2, op2, val2);
-        int count = sscanf(ptr, "%[^><=!& \t\n] %2[><=!]%n", col1, op1, &n);
-        if(count < 2) return PrepareResult::syntaxError;
-        ptr += n;
-        getNextValue(&ptr, val1);
-        count = sscanf(ptr, " %2[&] %[^><=!& \t\n] %2[><=!]%n", combineOperator, col2, op2, &n);
-        if(count == 3){
-            ptr += n;
-            getNextValue(&ptr, val2);
-            cond.isCompound = true;
-            if(strcmp(col1, col2) != 0){
-                return PrepareResult::comparisonOnDifferentRows;
-            }
-            if(strcmp(combineOperator, "&&") != 0){
-                return PrepareResult::syntaxError;
-            }
-            cond.col = col1;
-            cond.data1 = val1;
-            cond.data2 = val2;
-            cond.compType1 = findComparisonType(op1);
-            cond.compType2 = findComparisonType(op2);
-            if(cond.compType1 == ComparisonType::error || cond.compType2 == ComparisonType::error){
-                return PrepareResult::invalidOperator;
-            }
-        }
-        else if(count <= 0){
-            cond.isCompound = false;
-            cond.col = col1;
-            cond.data1 = val1;
-            cond.compType1 = findComparisonType(op1);
-            if(cond.compType1 == ComparisonType::error){
-                return PrepareResult::invalidOperator;
-            }
-        }
-        else{
+    static PrepareResult parseTrailingClauses(Lexer& lexer, SelectStatement& statement){
+        // SYNTAX:- [group by <col>] [order by <col> [asc|desc]] [limit <n>]
+        std::string_view field;
+        if(lexer.accept("group")){
+            if(!lexer.accept("by") || !getWord(lexer, field)) return PrepareResult::syntaxError;
+            statement.groupBy.assign(field);
+            statement.isAggregate = true;
+        }
+        if(lexer.accept("order")){
+            if(!lexer.accept("by") || !getWord(lexer, field)) return PrepareResult::syntaxError;
+            statement.orderBy.assign(field);
+            if(lexer.accept("desc")) statement.descending = true;
+            else lexer.accept("asc");
+        }
+        if(lexer.accept("limit")){
+            int64_t limit;
+            if(!getWord(lexer, field) || !toInteger(field, limit) || limit < 0) return PrepareResult::syntaxError;
+            statement.limit = limit;
+        }
+        if(!lexer.atEnd()) return PrepareResult::syntaxError;
+        return PrepareResult::success;
+    }
+
+    PrepareResult parseAnalyze(Lexer& lexer){
+        // SYNTAX:- analyze <table-name>
+        this->type = StatementType::analyze;
+        auto analyzeStatement = std::make_unique<AnalyzeStatement>();
+        auto res = getTableName(lexer, analyzeStatement->tableName);
+        if(res != PrepareResult::success) return res;
+        if(!lexer.atEnd()) return PrepareResult::syntaxError;
+        this->statement = std::move(analyzeStatement);
+        return PrepareResult::success;
+    }
+
+    PrepareResult parseJoin(Lexer& lexer){
+        // SYNTAX:- join <table-1>, <table-2> on <col-1> == <col-2>
+        this->type = StatementType::join;
+        auto joinStatement = std::make_unique<JoinStatement>();
+        std::string_view col1, col2;
+        if(getTableName(lexer, joinStatement->tableName) != PrepareResult::success ||
+           !lexer.accept(",") ||
+           getTableName(lexer, joinStatement->otherTableName) != PrepareResult::success ||
+           !lexer.accept("on") || !getWord(lexer, col1) ||
+           !lexer.accept("==") || !getWord(lexer, col2) ||
+           !lexer.atEnd()){
             return PrepareResult::syntaxError;
         }
+        joinStatement->column.assign(col1);
+        joinStatement->otherColumn.assign(col2);
+        this->statement = std::move(joinStatement);
         return PrepareResult::success;
-        if(count == 3){
-            cond.isCompound = false;
-            cond.col = col1;
-            cond.data1 = val1;
-            cond.compType1 = findComparisonType(op1);
-            if(cond.compType1 == ComparisonType::error){
-                return PrepareResult::invalidOperator;
-            }
-        }
-        else if(count == 7){
-            cond.isCompound = true;
-            if(strcmp(col1, col2) != 0){
-                return PrepareResult::comparisonOnDifferentRows;
-            }
-            if(strcmp(combineOperator, "&&") != 0){
-                return PrepareResult::syntaxError;
-            }
-            cond.col = col1;
-            cond.data1 = val1;
-            cond.data2 = val2;
-            cond.compType1 = findComparisonType(op1);
-            cond.compType2 = findComparisonType(op2);
-            if(cond.compType1 == ComparisonType::error || cond.compType2 == ComparisonType::error){
-                return PrepareResult::invalidOperator;
-            }
-        }
-        else{
-            return PrepareResult::syntaxError;
+    }
+
+    PrepareResult parsePrepare(Lexer& lexer){
+        // SYNTAX:- prepare <name> as <insert|select|update|delete statement>
+        this->type = StatementType::prepare;
+        std::string_view name;
+        if(!getWord(lexer, name) || !lexer.accept("as") || lexer.atEnd()) return PrepareResult::syntaxError;
+
+        auto prepareStatement = std::make_unique<PrepareStatement>();
+        prepareStatement->name.assign(name);
+        prepareStatement->text.assign(lexer.rest());
+        auto res = prepare(prepareStatement->text, prepareStatement->prepared);
+        if(res != PrepareResult::success) return res;
+        this->statement = std::move(prepareStatement);
+        return PrepareResult::success;
+    }
+
+    PrepareResult parseExecute(Lexer& lexer){
+        // SYNTAX:- execute <name> [using <data-1>, <data-2>, ...]
+        this->type = StatementType::execute;
+        std::string_view name;
+        if(!getWord(lexer, name)) return PrepareResult::syntaxError;
+
+        auto executeStatement = std::make_unique<ExecuteStatement>();
+        executeStatement->name.assign(name);
+        if(lexer.accept("using")){
+            do{
+                executeStatement->values.emplace_back();
+                if(!getNextValue(lexer, executeStatement->values.back())) return PrepareResult::syntaxError;
+            }while(lexer.accept(","));
+        }
+        if(!lexer.atEnd()) return PrepareResult::syntaxError;
+        this->statement = std::move(executeStatement);
+        return PrepareResult::success;
+    }
+
+    PrepareResult parseDeallocate(Lexer& lexer){
+        // SYNTAX:- deallocate <name>
+        this->type = StatementType::deallocate;
+        std::string_view name;
+        if(!getWord(lexer, name) || !lexer.atEnd()) return PrepareResult::syntaxError;
+
+        auto deallocateStatement = std::make_unique<DeallocateStatement>();
+        deallocateStatement->name.assign(name);
+        this->statement = std::move(deallocateStatement);
+        return PrepareResult::success;
+    }
+
+    PrepareResult parseExplain(Lexer& lexer){
+        // SYNTAX:- explain <select-statement>
+        if(!lexer.accept("select")) return PrepareResult::syntaxError;
+        auto res = parseSelect(lexer);
+        if(res != PrepareResult::success) return res;
+        static_cast<SelectStatement*>(statement.get())->explain = true;
+        return PrepareResult::success;
+    }
+
+    /// Condition ends at first token which cannot continue it
+    static PrepareResult parseCondition(Lexer& lexer, Condition& cond){
+        return parseDisjunction(lexer, cond);
+    }
+
+    /// Condition joined by || or && from operands parsed by parseOperand
+    template <typename parse_t>
+    static PrepareResult parseChain(Lexer& lexer, Condition& cond, ConditionType type, const char* symbol, const parse_t& parseOperand){
+        Condition first;
+        auto res = parseOperand(lexer, first);
+        if(res != PrepareResult::success) return res;
+        if(!lexer.accept(symbol)){
+            cond = std::move(first);
+            return PrepareResult::success;
+        }
+
+        cond.type = type;
+        cond.children.push_back(std::move(first));
+        do{
+            cond.children.emplace_back();
+            res = parseOperand(lexer, cond.children.back());
+            if(res != PrepareResult::success) return res;
+        }while(lexer.accept(symbol));
+        return PrepareResult::success;
+    }
+
+    static PrepareResult parseDisjunction(Lexer& lexer, Condition& cond){
+        return parseChain(lexer, cond, ConditionType::disjunction, "||", parseConjunction);
+    }
+
+    static PrepareResult parseConjunction(Lexer& lexer, Condition& cond){
+        return parseChain(lexer, cond, ConditionType::conjunction, "&&", parseFactor);
+    }
+
+    static PrepareResult parseFactor(Lexer& lexer, Condition& cond){
+        // SYNTAX:- !<factor> | (<CONDITION>) | <col> <op> <value>
+        if(lexer.accept("!")){
+            cond.type = ConditionType::negation;
+            cond.children.emplace_back();
+            return parseFactor(lexer, cond.children.back());
         }
+        if(lexer.accept("(")){
+            auto res = parseDisjunction(lexer, cond);
+            if(res != PrepareResult::success) return res;
+            if(!lexer.accept(")")) return PrepareResult::syntaxError;
+            return PrepareResult::success;
+        }
+
+        std::string_view col;
+        if(!getWord(lexer, col)) return PrepareResult::syntaxError;
+        Token op = lexer.next();
+        if(op.type != TokenType::symbol) return PrepareResult::syntaxError;
+        cond.type = ConditionType::comparison;
+        cond.compType = findComparisonType(op.text);
+        if(cond.compType == ComparisonType::error) return PrepareResult::invalidOperator;
+        cond.col.assign(col);
+        if(!getNextValue(lexer, cond.data, &cond.parameter)) return PrepareResult::syntaxError;
         return PrepareResult::success;
     }
-};
\ No newline at end of file
+};
+const int32_t STATEMENT_CACHE_SIZE = 128;
+
+/// Prepared statements parsed from their text at most once while they stay cached
+/// Entries are keyed by text so names prepared with same text share one parse
+/// Least recently executed entry is dropped when cache is full and parsed again on next use
+class StatementCache{
+    using entry_t = std::pair<std::string, PreparedStatement>;
+    using list_t  = std::list<entry_t>;
+    list_t entries;                                             // Most recently used first
+    std::unordered_map<std::string, list_t::iterator> entryMap;
+    std::unordered_map<std::string, std::string> names;        // Name => text
+
+public:
+    int64_t hits = 0;
+    int64_t misses = 0;
+
+    /// Names text. prepared is its parse
+    void put(const std::string& name, const std::string& text, PreparedStatement&& prepared){
+        names[name] = text;
+        auto itr = entryMap.find(text);
+        if(itr != entryMap.end()){
+            entries.splice(entries.begin(), entries, itr->second);
+            return;
+        }
+        if(entries.size() >= STATEMENT_CACHE_SIZE){
+            entryMap.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(text, std::move(prepared));
+        entryMap[text] = entries.begin();
+    }
+
+    /// Parsed statement prepared as name. nullptr when there is none
+    PreparedStatement* get(const std::string& name){
+        auto nameItr = names.find(name);
+        if(nameItr == names.end()) return nullptr;
+        const std::string& text = nameItr->second;
+        auto itr = entryMap.find(text);
+        if(itr != entryMap.end()){
+            ++hits;
+            entries.splice(entries.begin(), entries, itr->second);
+            return &entries.front().second;
+        }
+
+        // Text parsed when it was prepared so it parses again
+        ++misses;
+        PreparedStatement prepared;
+        if(Parser::prepare(text, prepared) != PrepareResult::success) return nullptr;
+        put(name, text, std::move(prepared));
+        return &entries.front().second;
+    }
+
+    bool remove(const std::string& name){
+        return names.erase(name) > 0;
+    }
+};
@@ -0,0 +1,43 @@
+#include "Parser.cpp"
+#include <chrono>
+
+const int64_t PARSE_ROUNDS = 1000000;
+
+/// Statements of every kind parsed by each round
+const char* statements[] = {
+    "insert into users {42, \"Jane Doe\", 31.5, true}",
+    "insert into users {1, \"a\", 1.0, false}, {2, \"b\", 2.0, true}, {3, \"c\", 3.0, false}",
+    "select * from users where id == 42",
+    "select {id, name} from users where age >= 18 && (name != \"root\" || !(id < 10)) order by age desc limit 20",
+    "select {count(*), avg(age)} from users where active == true group by name",
+    "update users set {name = \"John\", age = 32} where id == 42",
+    "delete from users where age < 18",
+    "create table users {id: int, name: string(32), age: float, active: bool}",
+    "execute byId using 42",
+};
+
+int main(){
+    const int32_t count = sizeof(statements) / sizeof(statements[0]);
+    std::vector<std::string> texts(statements, statements + count);
+    Parser parser;
+
+    int64_t total = 0;
+    double totalSeconds = 0;
+    for(auto& text: texts){
+        if(parser.parse(std::string_view(text)) != PrepareResult::success){
+            printf("Could not parse '%s'\n", text.c_str());
+            return 1;
+        }
+
+        auto t1 = std::chrono::steady_clock::now();
+        for(int64_t i = 0; i < PARSE_ROUNDS; ++i) parser.parse(std::string_view(text));
+        auto t2 = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(t2 - t1).count();
+        printf("%10.0f statements/s  %.40s\n", PARSE_ROUNDS / seconds, text.c_str());
+        total += PARSE_ROUNDS;
+        totalSeconds += seconds;
+    }
+    printf("%10.0f statements/s  overall\n", total / totalSeconds);
+    return 0;
+}
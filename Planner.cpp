@@ -0,0 +1,352 @@
+#include "HeaderFiles/Planner.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+// =============================================
+//                  BITMAP PLAN
+// =============================================
+
+BitmapPlan::BitmapPlan(){
+    op = BitmapOp::indexScan;
+    index = -1;
+    low = -1;
+    high = -1;
+    rows = 0;
+    cost = 0;
+}
+
+void BitmapPlan::describe(Table* table, int32_t depth, std::string& out) const{
+    char buffer[256];
+    if(op == BitmapOp::indexScan){
+        snprintf(buffer, sizeof(buffer), "Bitmap Index Scan using %s (cost=%.2f rows=%.0f)",
+                 table->columnNames[index].c_str(), cost, rows);
+    }
+    else{
+        snprintf(buffer, sizeof(buffer), "%s (cost=%.2f rows=%.0f)",
+                 op == BitmapOp::intersect ? "BitmapAnd" : "BitmapOr", cost, rows);
+    }
+    out.push_back('\n');
+    out.append(depth * 2, ' ');
+    out.append("-> ");
+    out.append(buffer);
+    for(auto& child: children) child.describe(table, depth + 1, out);
+}
+
+// =============================================
+//                     PLAN
+// =============================================
+
+Plan::Plan(){
+    path = AccessPath::heapScan;
+    index = -1;
+    low = -1;
+    high = -1;
+    rows = 0;
+    cost = 0;
+}
+
+std::string Plan::describe(Table* table) const{
+    char buffer[256];
+    if(path == AccessPath::heapScan){
+        snprintf(buffer, sizeof(buffer), "Heap Scan on %s (cost=%.2f rows=%.0f)",
+                 table->getTableName().c_str(), cost, rows);
+    }
+    else if(path == AccessPath::bitmapScan){
+        snprintf(buffer, sizeof(buffer), "Bitmap Heap Scan on %s (cost=%.2f rows=%.0f)",
+                 table->getTableName().c_str(), cost, rows);
+        std::string res = buffer;
+        bitmap.describe(table, 1, res);
+        return res;
+    }
+    else{
+        snprintf(buffer, sizeof(buffer), "Index Scan using %s on %s (cost=%.2f rows=%.0f)",
+                 table->columnNames[index].c_str(), table->getTableName().c_str(), cost, rows);
+    }
+    return buffer;
+}
+
+// =============================================
+//                    PLANNER
+// =============================================
+
+double Planner::selectivity(Table* table, const std::vector<ColumnPredicate>& predicates){
+    double res = 1;
+    std::map<int32_t, std::pair<double, double>> ranges;      // Column => (lower bound, upper bound). -1 when open
+    for(auto& predicate: predicates){
+        double sel;
+        const ColumnStats* stats = nullptr;
+        if(predicate.column < table->stats.columns.size()) stats = &table->stats.columns[predicate.column];
+        if(stats != nullptr && stats->count > 0){
+            sel = stats->selectivity(predicate.op, predicate.cell);
+        }
+        else{
+            bool equality = (predicate.op == ComparisonType::equal);
+            sel = equality ? DEFAULT_EQUAL_SELECTIVITY : DEFAULT_RANGE_SELECTIVITY;
+        }
+
+        switch(predicate.op){
+            case ComparisonType::greaterThan:
+            case ComparisonType::greaterThanOrEqual:
+                ranges.emplace(predicate.column, std::make_pair(-1.0, -1.0)).first->second.first = sel;
+                break;
+            case ComparisonType::lessThan:
+            case ComparisonType::lessThanOrEqual:
+                ranges.emplace(predicate.column, std::make_pair(-1.0, -1.0)).first->second.second = sel;
+                break;
+            default:
+                res *= sel;
+                break;
+        }
+    }
+
+    // Both sides of a range on same column overlap instead of being independent
+    for(auto& range: ranges){
+        double lowerBound = range.second.first, upperBound = range.second.second;
+        if(lowerBound >= 0 && upperBound >= 0) res *= std::max(0.0, lowerBound + upperBound - 1);
+        else if(lowerBound >= 0) res *= lowerBound;
+        else if(upperBound >= 0) res *= upperBound;
+    }
+    return res;
+}
+
+double Planner::selectivity(Table* table, const FilterNode& node){
+    switch(node.type){
+        case FilterType::predicate:
+            return selectivity(table, {node.predicate});
+        case FilterType::conjunction: {
+            double res = 1;
+            std::vector<ColumnPredicate> leaves;
+            for(auto& child: node.children){
+                if(child.type == FilterType::predicate) leaves.push_back(child.predicate);
+                else res *= selectivity(table, child);
+            }
+            return res * selectivity(table, leaves);
+        }
+        case FilterType::disjunction: {
+            // Branches are taken as independent
+            double res = 0;
+            for(auto& child: node.children){
+                double sel = selectivity(table, child);
+                res = res + sel - res * sel;
+            }
+            return res;
+        }
+    }
+    return 1;
+}
+
+void Planner::bounds(const std::vector<ColumnPredicate>& predicates, int32_t column, int32_t& low, int32_t& high){
+    low = high = -1;
+    for(int32_t p = 0; p < predicates.size(); ++p){
+        if(predicates[p].column != column) continue;
+        switch(predicates[p].op){
+            case ComparisonType::equal:
+                low = high = p;
+                break;
+            case ComparisonType::greaterThan:
+            case ComparisonType::greaterThanOrEqual:
+                if(low == -1) low = p;
+                break;
+            case ComparisonType::lessThan:
+            case ComparisonType::lessThanOrEqual:
+                if(high == -1) high = p;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+bool Planner::bitmapIndexScan(Table* table, const std::vector<ColumnPredicate>& predicates, int32_t column, BitmapPlan& plan){
+    if(!table->indexed[column]) return false;
+    plan = BitmapPlan();
+    plan.op = BitmapOp::indexScan;
+    plan.index = column;
+    for(auto& predicate: predicates){
+        if(predicate.column == column && predicate.op != ComparisonType::notEqual) plan.bounds.push_back(predicate);
+    }
+    bounds(plan.bounds, column, plan.low, plan.high);
+    if(plan.low == -1 && plan.high == -1) return false;
+
+    plan.rows = std::ceil(table->getRowCount() * selectivity(table, plan.bounds));
+    int32_t fanout = std::max(1, table->trees[column]->fanout());
+    plan.cost = (table->trees[column]->height() + std::ceil(plan.rows / fanout)) * RANDOM_PAGE_COST
+              + plan.rows * CPU_ROW_COST;
+    return true;
+}
+
+bool Planner::bitmapPlan(Table* table, const FilterNode& node, BitmapPlan& plan){
+    double rows = std::max<double>(1, table->getRowCount());
+    switch(node.type){
+        case FilterType::predicate:
+            return bitmapIndexScan(table, {node.predicate}, node.predicate.column, plan);
+
+        case FilterType::disjunction: {
+            BitmapPlan res;
+            res.op = BitmapOp::unite;
+            double fraction = 0;
+            for(auto& child: node.children){
+                BitmapPlan input;
+                if(!bitmapPlan(table, child, input)) return false;
+                double sel = std::min(1.0, input.rows / rows);
+                fraction = fraction + sel - fraction * sel;
+                res.cost += input.cost + input.rows * CPU_ROW_COST;
+                res.children.push_back(std::move(input));
+            }
+            res.rows = std::ceil(rows * fraction);
+            plan = std::move(res);
+            return true;
+        }
+
+        case FilterType::conjunction: {
+            // Predicates on same column become one range scan of its tree
+            std::vector<ColumnPredicate> leaves;
+            for(auto& child: node.children){
+                if(child.type == FilterType::predicate) leaves.push_back(child.predicate);
+            }
+            std::vector<BitmapPlan> inputs;
+            std::vector<int32_t> scanned;
+            for(auto& leaf: leaves){
+                if(std::find(scanned.begin(), scanned.end(), leaf.column) != scanned.end()) continue;
+                scanned.push_back(leaf.column);
+                BitmapPlan input;
+                if(bitmapIndexScan(table, leaves, leaf.column, input)) inputs.push_back(std::move(input));
+            }
+            for(auto& child: node.children){
+                BitmapPlan input;
+                if(child.type != FilterType::predicate && bitmapPlan(table, child, input)) inputs.push_back(std::move(input));
+            }
+            if(inputs.empty()) return false;
+
+            // Most selective input first. Others only join while heap reads they save outweigh them
+            std::sort(inputs.begin(), inputs.end(), [](const BitmapPlan& a, const BitmapPlan& b){
+                return a.rows < b.rows;
+            });
+            double heapPages = std::ceil(static_cast<double>(table->getRowSlots()) / table->getRowsPerPage());
+            BitmapPlan res;
+            res.op = BitmapOp::intersect;
+            res.rows = inputs[0].rows;
+            res.cost = inputs[0].cost + inputs[0].rows * CPU_ROW_COST;
+            res.children.push_back(std::move(inputs[0]));
+            for(int32_t i = 1; i < inputs.size(); ++i){
+                double narrowed = std::ceil(res.rows * std::min(1.0, inputs[i].rows / rows));
+                double saved = (std::min(res.rows, heapPages) - std::min(narrowed, heapPages)) * RANDOM_PAGE_COST;
+                double cost = inputs[i].cost + inputs[i].rows * CPU_ROW_COST;
+                if(saved <= cost) continue;
+                res.rows = narrowed;
+                res.cost += cost;
+                res.children.push_back(std::move(inputs[i]));
+            }
+            if(res.children.size() == 1) plan = std::move(res.children[0]);
+            else plan = std::move(res);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Planner::buildBitmap(Table* table, const BitmapPlan& plan, RowBitmap& bitmap){
+    if(plan.op == BitmapOp::indexScan){
+        std::vector<row_t> rows;
+        const char* low = (plan.low == -1) ? nullptr : plan.bounds[plan.low].cell.data();
+        const char* high = (plan.high == -1) ? nullptr : plan.bounds[plan.high].cell.data();
+        bool res = table->trees[plan.index]->traverseCellRange(low, high, false, [&](row_t row)->bool{
+            rows.push_back(row);
+            return true;
+        });
+        if(!res) return false;
+        bitmap = RowBitmap(std::move(rows));
+        return true;
+    }
+
+    for(int32_t i = 0; i < plan.children.size(); ++i){
+        RowBitmap input;
+        if(!buildBitmap(table, plan.children[i], input)) return false;
+        if(i == 0) bitmap = std::move(input);
+        else if(plan.op == BitmapOp::intersect) bitmap = bitmap.intersect(input);
+        else bitmap = bitmap.unite(input);
+
+        // Nothing joins an empty intersection
+        if(plan.op == BitmapOp::intersect && bitmap.empty()) break;
+    }
+    return true;
+}
+
+std::vector<Plan> Planner::enumerate(Table* table, const Filter& filter){
+    if(table->stats.isStale()){
+        if(table->stats.collect(table)) table->stats.save();
+    }
+
+    double slots = table->getRowSlots();
+    double rows = table->getRowCount();
+    double heapPages = std::ceil(slots / table->getRowsPerPage());
+    FilterNode root = filter.root();
+    double matches = std::ceil(rows * selectivity(table, root));
+
+    std::vector<Plan> plans;
+    Plan heap;
+    heap.path = AccessPath::heapScan;
+    heap.rows = matches;
+    heap.cost = heapPages * SEQ_PAGE_COST + slots * CPU_ROW_COST;
+    plans.push_back(heap);
+
+    for(int32_t i = 0; i < table->indexed.size(); ++i){
+        if(!table->indexed[i]) continue;
+        Plan plan;
+        plan.path = AccessPath::indexScan;
+        plan.index = i;
+        plan.rows = matches;
+        bounds(filter.predicates, i, plan.low, plan.high);
+
+        // Only predicates on column of this tree can bound the scan
+        std::vector<ColumnPredicate> bounding;
+        for(auto& predicate: filter.predicates){
+            if(predicate.column == i && predicate.op != ComparisonType::notEqual) bounding.push_back(predicate);
+        }
+
+        double scanned = std::ceil(rows * selectivity(table, bounding));
+        int32_t fanout = std::max(1, table->trees[i]->fanout());
+        double leafPages = std::ceil(scanned / fanout);
+        double fetchedPages = scanned;
+        if(heapPages <= DEFAULT_PAGE_LIMIT) fetchedPages = std::min(scanned, heapPages);
+        plan.cost = (table->trees[i]->height() + leafPages) * RANDOM_PAGE_COST
+                  + fetchedPages * RANDOM_PAGE_COST + scanned * CPU_ROW_COST;
+        plans.push_back(plan);
+    }
+
+    // A single index scan is already costed above
+    BitmapPlan bitmap;
+    if(bitmapPlan(table, root, bitmap) && bitmap.op != BitmapOp::indexScan){
+        Plan plan;
+        plan.path = AccessPath::bitmapScan;
+        plan.rows = matches;
+        plan.cost = bitmap.cost + std::min(bitmap.rows, heapPages) * RANDOM_PAGE_COST + bitmap.rows * CPU_ROW_COST;
+        plan.bitmap = std::move(bitmap);
+        plans.push_back(plan);
+    }
+
+    std::stable_sort(plans.begin(), plans.end(), [](const Plan& a, const Plan& b){
+        return a.cost < b.cost;
+    });
+    return plans;
+}
+
+Plan Planner::choose(Table* table, const Filter& filter){
+    return enumerate(table, filter).front();
+}
+
+bool Planner::execute(Table* table, const Plan& plan, const Filter& filter, const std::function<bool(row_t row)>& callback, bool descending){
+    if(plan.path == AccessPath::heapScan){
+        HeapScanner heap(table);
+        return heap.scan(filter, callback);
+    }
+    if(plan.path == AccessPath::bitmapScan){
+        RowBitmap bitmap;
+        if(!buildBitmap(table, plan.bitmap, bitmap)) return false;
+        return bitmap.forEach(callback);
+    }
+    const char* low = (plan.low == -1) ? nullptr : filter.predicates[plan.low].cell.data();
+    const char* high = (plan.high == -1) ? nullptr : filter.predicates[plan.high].cell.data();
+    return table->trees[plan.index]->traverseCellRange(low, high, descending, callback);
+}
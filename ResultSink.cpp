@@ -0,0 +1,286 @@
+#include "HeaderFiles/ResultSink.h"
+#include <cstring>
+
+bool findOutputFormat(const std::string& name, OutputFormat& format){
+    if(name == "pretty") format = OutputFormat::pretty;
+    else if(name == "csv") format = OutputFormat::csv;
+    else if(name == "tsv") format = OutputFormat::tsv;
+    else if(name == "binary") format = OutputFormat::binary;
+    else return false;
+    return true;
+}
+
+ResultSink::ResultSink(){
+    this->format = OutputFormat::pretty;
+    this->file = stdout;
+    this->rowStart = 0;
+    this->cells = 0;
+    this->failed = false;
+    this->deferred = false;
+    this->batchSize = RESULT_BUFFER_SIZE;
+    buffer.reserve(RESULT_BUFFER_SIZE + BATCH_SIZE * 64);
+}
+
+ResultSink::~ResultSink(){
+    flush();
+    if(file != stdout) fclose(file);
+}
+
+OutputFormat ResultSink::getFormat() const{
+    return format;
+}
+
+void ResultSink::setFormat(OutputFormat format_){
+    this->format = format_;
+}
+
+void ResultSink::setDeferred(bool deferred_){
+    this->deferred = deferred_;
+}
+
+bool ResultSink::open(const std::string& fileName){
+    flush();
+    FILE* next = stdout;
+    if(!fileName.empty()){
+        next = fopen(fileName.c_str(), "wb");
+        if(next == nullptr) return false;
+    }
+    if(file != stdout) fclose(file);
+    file = next;
+    return true;
+}
+
+void ResultSink::capture(std::function<bool(const char* data, size_t length)> consumer_, size_t batchSize_){
+    flush();
+    this->consumer = std::move(consumer_);
+    this->batchSize = consumer ? batchSize_ : RESULT_BUFFER_SIZE;
+    columns.clear();
+}
+
+const std::vector<std::string>& ResultSink::columnNames() const{
+    return columns;
+}
+
+void ResultSink::begin(const std::vector<std::string>& names){
+    failed = false;
+    if(consumer) columns = names;
+    if(format != OutputFormat::csv && format != OutputFormat::tsv) return;
+    beginRow();
+    for(auto& name: names){
+        separator();
+        appendText(name.data(), name.size());
+    }
+    endRow();
+}
+
+// =============================================
+//                    CELLS
+// =============================================
+
+void ResultSink::separator(){
+    if(format == OutputFormat::csv && cells > 0) buffer.push_back(',');
+    else if(format == OutputFormat::tsv && cells > 0) buffer.push_back('\t');
+    ++cells;
+}
+
+void ResultSink::appendText(const char* text, size_t length){
+    switch(format){
+        case OutputFormat::pretty:
+        case OutputFormat::binary:
+            buffer.append(text, length);
+            break;
+        case OutputFormat::csv: {
+            bool quote = false;
+            for(size_t i = 0; i < length && !quote; ++i){
+                quote = (text[i] == ',' || text[i] == '"' || text[i] == '\n' || text[i] == '\r');
+            }
+            if(!quote){
+                buffer.append(text, length);
+                break;
+            }
+            buffer.push_back('"');
+            for(size_t i = 0; i < length; ++i){
+                if(text[i] == '"') buffer.push_back('"');
+                buffer.push_back(text[i]);
+            }
+            buffer.push_back('"');
+            break;
+        }
+        case OutputFormat::tsv:
+            for(size_t i = 0; i < length; ++i){
+                switch(text[i]){
+                    case '\t': buffer.append("\\t"); break;
+                    case '\n': buffer.append("\\n"); break;
+                    case '\r': buffer.append("\\r"); break;
+                    case '\\': buffer.append("\\\\"); break;
+                    default: buffer.push_back(text[i]);
+                }
+            }
+            break;
+    }
+}
+
+void ResultSink::appendTag(CellTag tag, const void* data, size_t length){
+    buffer.push_back(static_cast<char>(tag));
+    buffer.append(static_cast<const char*>(data), length);
+}
+
+void ResultSink::value(const Value& value){
+    if(format == OutputFormat::pretty){
+        value.appendText(buffer);
+        buffer.append(" | ");
+        return;
+    }
+    if(format == OutputFormat::binary){
+        switch(value.type){
+            case DataType::Int:
+                appendTag(CellTag::int32, &value.intValue, sizeof(int32_t));
+                break;
+            case DataType::Float:
+                appendTag(CellTag::float32, &value.floatValue, sizeof(float));
+                break;
+            case DataType::Char:
+                appendTag(CellTag::character, &value.charValue, sizeof(char));
+                break;
+            case DataType::Bool: {
+                char bit = value.boolValue ? 1 : 0;
+                appendTag(CellTag::boolean, &bit, sizeof(char));
+                break;
+            }
+            case DataType::String: {
+                auto length = static_cast<uint32_t>(value.stringSize);
+                appendTag(CellTag::string, &length, sizeof(uint32_t));
+                buffer.append(value.stringValue, value.stringSize);
+                break;
+            }
+        }
+        return;
+    }
+
+    separator();
+    switch(value.type){
+        case DataType::Float: {
+            char text[32];
+            int len = snprintf(text, sizeof(text), "%.9g", value.floatValue);
+            buffer.append(text, len);
+            break;
+        }
+        case DataType::Char:
+            appendText(&value.charValue, 1);
+            break;
+        case DataType::String:
+            appendText(value.stringValue, value.stringSize);
+            break;
+        default:
+            value.appendText(buffer);
+            break;
+    }
+}
+
+void ResultSink::text(const std::string& value){
+    if(format == OutputFormat::binary){
+        auto length = static_cast<uint32_t>(value.size());
+        appendTag(CellTag::string, &length, sizeof(uint32_t));
+        buffer.append(value);
+        return;
+    }
+    separator();
+    appendText(value.data(), value.size());
+    if(format == OutputFormat::pretty) buffer.append(" | ");
+}
+
+void ResultSink::integer(int64_t value){
+    if(format == OutputFormat::binary){
+        appendTag(CellTag::int64, &value, sizeof(int64_t));
+        return;
+    }
+    separator();
+    char text[32];
+    int len = snprintf(text, sizeof(text), "%lld", static_cast<long long>(value));
+    buffer.append(text, len);
+    if(format == OutputFormat::pretty) buffer.append(" | ");
+}
+
+void ResultSink::real(double value){
+    if(format == OutputFormat::binary){
+        appendTag(CellTag::float64, &value, sizeof(double));
+        return;
+    }
+    separator();
+    char text[32];
+    int len = snprintf(text, sizeof(text), (format == OutputFormat::pretty) ? "%f" : "%.17g", value);
+    buffer.append(text, len);
+    if(format == OutputFormat::pretty) buffer.append(" | ");
+}
+
+void ResultSink::null(){
+    switch(format){
+        case OutputFormat::pretty:
+            buffer.append("null | ");
+            break;
+        case OutputFormat::csv:
+            separator();
+            break;
+        case OutputFormat::tsv:
+            separator();
+            buffer.append("\\N");
+            break;
+        case OutputFormat::binary:
+            appendTag(CellTag::null, nullptr, 0);
+            break;
+    }
+}
+
+void ResultSink::endRow(){
+    if(format == OutputFormat::binary){
+        auto length = static_cast<uint32_t>(buffer.size() - rowStart - sizeof(uint32_t));
+        memcpy(&buffer[rowStart], &length, sizeof(uint32_t));
+    }
+    else{
+        buffer.push_back('\n');
+    }
+    if(buffer.size() < batchSize) return;
+    writeOut();
+}
+
+// =============================================
+//                    ROWS
+// =============================================
+
+void ResultSink::write(const RowBatch& batch, const std::vector<int32_t>& positions){
+    for(int32_t s = 0; s < batch.selected; ++s){
+        int32_t i = batch.selection[s];
+        beginRow();
+        if(format == OutputFormat::pretty){
+            // Text straight from column vectors without building a Value
+            for(int32_t position: positions){
+                batch.columns[position].appendText(i, buffer);
+                buffer.append(" | ");
+            }
+        }
+        else{
+            for(int32_t position: positions) value(batch.columns[position].get(i));
+        }
+        endRow();
+    }
+}
+
+void ResultSink::values(const RowCodec& codec, const char* row){
+    for(int32_t col = 0; col < codec.columnCount(); ++col) value(codec.get(row, col));
+}
+
+void ResultSink::writeOut(){
+    if(consumer){
+        if(!consumer(buffer.data(), buffer.size())) failed = true;
+    }
+    else if(fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) failed = true;
+    buffer.clear();
+}
+
+bool ResultSink::flush(){
+    if(!buffer.empty()) writeOut();
+    if(!consumer && !deferred && fflush(file) != 0) failed = true;
+    bool res = !failed;
+    failed = false;
+    return res;
+}
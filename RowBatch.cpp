@@ -0,0 +1,501 @@
+#include "HeaderFiles/RowBatch.h"
+
+// =============================================
+//                COLUMN VECTOR
+// =============================================
+
+ColumnVector::ColumnVector(DataType type_, int32_t column_, int32_t width_){
+    this->type = type_;
+    this->column = column_;
+    this->width = width_;
+    switch(type){
+        case DataType::Int:
+            ints.reserve(BATCH_SIZE);
+            break;
+        case DataType::Float:
+            floats.reserve(BATCH_SIZE);
+            break;
+        case DataType::Char:
+        case DataType::Bool:
+            chars.reserve(BATCH_SIZE);
+            break;
+        case DataType::String:
+            offsets.reserve(BATCH_SIZE + 1);
+            data.reserve(BATCH_SIZE * width);
+            offsets.push_back(0);
+            break;
+    }
+}
+
+void ColumnVector::clear(){
+    ints.clear();
+    floats.clear();
+    chars.clear();
+    data.clear();
+    offsets.clear();
+    if(type == DataType::String) offsets.push_back(0);
+}
+
+void ColumnVector::append(const char* cell){
+    int32_t dataInt;
+    float dataFloat;
+    switch(type){
+        case DataType::Int:
+            memcpy(&dataInt, cell, sizeof(int32_t));
+            ints.push_back(dataInt);
+            break;
+        case DataType::Float:
+            memcpy(&dataFloat, cell, sizeof(float));
+            floats.push_back(dataFloat);
+            break;
+        case DataType::Char:
+        case DataType::Bool:
+            chars.push_back(*cell);
+            break;
+        case DataType::String:
+            // Strings are not null terminated if they occupy whole column
+            data.insert(data.end(), cell, cell + strnlen(cell, width));
+            offsets.push_back(data.size());
+            break;
+    }
+}
+
+void ColumnVector::appendText(int32_t i, std::string& out) const{
+    char buffer[32];
+    int len;
+    switch(type){
+        case DataType::Int:
+            len = snprintf(buffer, sizeof(buffer), "%d", ints[i]);
+            out.append(buffer, len);
+            break;
+        case DataType::Float:
+            len = snprintf(buffer, sizeof(buffer), "%f", floats[i]);
+            out.append(buffer, len);
+            break;
+        case DataType::Char:
+            out.push_back(chars[i]);
+            break;
+        case DataType::Bool:
+            out.append(chars[i] ? "true" : "false");
+            break;
+        case DataType::String:
+            out.append(data.data() + offsets[i], offsets[i + 1] - offsets[i]);
+            break;
+    }
+}
+
+Value ColumnVector::get(int32_t i) const{
+    Value value;
+    value.type = type;
+    switch(type){
+        case DataType::Int:
+            value.intValue = ints[i];
+            break;
+        case DataType::Float:
+            value.floatValue = floats[i];
+            break;
+        case DataType::Char:
+            value.charValue = chars[i];
+            break;
+        case DataType::Bool:
+            value.boolValue = chars[i];
+            break;
+        case DataType::String:
+            value.stringValue = data.data() + offsets[i];
+            value.stringSize = offsets[i + 1] - offsets[i];
+            break;
+    }
+    return value;
+}
+
+// =============================================
+//                  ROW BATCH
+// =============================================
+
+RowBatch::RowBatch(Table* table, const std::vector<int32_t>& columns_){
+    columns.reserve(columns_.size());
+    for(int32_t col: columns_){
+        columns.emplace_back(table->columnTypes[col], col, table->columnSizes[col]);
+    }
+    size = 0;
+    selected = 0;
+}
+
+void RowBatch::clear(){
+    for(auto& column: columns) column.clear();
+    size = 0;
+    selected = 0;
+}
+
+// =============================================
+//               COLUMN PREDICATE
+// =============================================
+
+CodecResult ColumnPredicate::compile(Table* table, int32_t column_, ComparisonType op_, const std::string& value){
+    this->column = column_;
+    this->position = -1;
+    this->op = op_;
+    this->type = table->columnTypes[column];
+    this->width = table->columnSizes[column];
+
+    Value constant;
+    auto res = table->codec.parse(column, value, constant);
+    if(res != CodecResult::success) return res;
+    cell.assign(width, '\0');
+    constant.write(&cell[0], width);
+    switch(type){
+        case DataType::Int:
+            intValue = constant.intValue;
+            break;
+        case DataType::Float:
+            floatValue = constant.floatValue;
+            break;
+        case DataType::Char:
+            charValue = constant.charValue;
+            break;
+        case DataType::Bool:
+            charValue = constant.boolValue;
+            break;
+        case DataType::String:
+            stringValue = value;
+            break;
+    }
+    return CodecResult::success;
+}
+
+/// Writes back positions which satisfy comparison and returns their count
+/// Selection is compacted without branches so that compiler can vectorise this loop
+template <typename T, typename compare_t>
+static int32_t filterValues(const T* values, const T& constant, int32_t* selection, int32_t selected, const compare_t& compare){
+    int32_t count = 0;
+    for(int32_t i = 0; i < selected; ++i){
+        int32_t pos = selection[i];
+        selection[count] = pos;
+        count += compare(values[pos], constant);
+    }
+    return count;
+}
+
+template <typename T>
+static int32_t filterValues(ComparisonType op, const T* values, const T& constant, int32_t* selection, int32_t selected){
+    switch(op){
+        case ComparisonType::equal:
+            return filterValues(values, constant, selection, selected, std::equal_to<T>());
+        case ComparisonType::notEqual:
+            return filterValues(values, constant, selection, selected, std::not_equal_to<T>());
+        case ComparisonType::lessThan:
+            return filterValues(values, constant, selection, selected, std::less<T>());
+        case ComparisonType::greaterThan:
+            return filterValues(values, constant, selection, selected, std::greater<T>());
+        case ComparisonType::lessThanOrEqual:
+            return filterValues(values, constant, selection, selected, std::less_equal<T>());
+        case ComparisonType::greaterThanOrEqual:
+            return filterValues(values, constant, selection, selected, std::greater_equal<T>());
+        case ComparisonType::error:
+            break;
+    }
+    return selected;
+}
+
+void ColumnPredicate::apply(RowBatch& batch) const{
+    const ColumnVector& vec = batch.columns[position];
+    switch(type){
+        case DataType::Int:
+            batch.selected = filterValues(op, vec.ints.data(), intValue, batch.selection, batch.selected);
+            break;
+        case DataType::Float:
+            batch.selected = filterValues(op, vec.floats.data(), floatValue, batch.selection, batch.selected);
+            break;
+        case DataType::Char:
+        case DataType::Bool:
+            batch.selected = filterValues(op, vec.chars.data(), charValue, batch.selection, batch.selected);
+            break;
+        case DataType::String: {
+            // Compare every string once and then filter on sign of the result
+            int32_t order[BATCH_SIZE];
+            const char* constant = stringValue.c_str();
+            int32_t constantLen = stringValue.size();
+            for(int32_t i = 0; i < batch.size; ++i){
+                int32_t len = vec.offsets[i + 1] - vec.offsets[i];
+                int res = memcmp(vec.data.data() + vec.offsets[i], constant, std::min(len, constantLen));
+                order[i] = (res != 0) ? res : (len - constantLen);
+            }
+            batch.selected = filterValues(op, order, int32_t(0), batch.selection, batch.selected);
+            break;
+        }
+    }
+}
+
+int32_t ColumnPredicate::applyPage(const char* page, int32_t count, int32_t rowSize, int32_t offset, int32_t* selection, int32_t selected) const{
+    // Column is strided in page. It is gathered in a dense array first
+    // so that filter runs over same loop as batches
+    const char* cell = page + offset;
+    switch(type){
+        case DataType::Int: {
+            int32_t values[BATCH_SIZE];
+            for(int32_t i = 0; i < count; ++i) memcpy(&values[i], cell + i * rowSize, sizeof(int32_t));
+            return filterValues(op, values, intValue, selection, selected);
+        }
+        case DataType::Float: {
+            float values[BATCH_SIZE];
+            for(int32_t i = 0; i < count; ++i) memcpy(&values[i], cell + i * rowSize, sizeof(float));
+            return filterValues(op, values, floatValue, selection, selected);
+        }
+        case DataType::Char:
+        case DataType::Bool: {
+            char values[BATCH_SIZE];
+            for(int32_t i = 0; i < count; ++i) values[i] = cell[i * rowSize];
+            return filterValues(op, values, charValue, selection, selected);
+        }
+        case DataType::String: {
+            int32_t order[BATCH_SIZE];
+            const char* constant = stringValue.c_str();
+            int32_t constantLen = stringValue.size();
+            for(int32_t i = 0; i < count; ++i){
+                const char* str = cell + i * rowSize;
+                int32_t len = strnlen(str, width);
+                int res = memcmp(str, constant, std::min(len, constantLen));
+                order[i] = (res != 0) ? res : (len - constantLen);
+            }
+            return filterValues(op, order, int32_t(0), selection, selected);
+        }
+    }
+    return selected;
+}
+
+// =============================================
+//                    FILTER
+// =============================================
+
+/// Keeps positions of selection which pass any of count children
+/// evaluate(c, selection, selected) narrows selection down by child c and returns how many are left
+/// Every child only sees positions which no earlier child has passed
+template <typename evaluate_t>
+static int32_t selectAny(int32_t* selection, int32_t selected, int32_t count, const evaluate_t& evaluate){
+    int32_t original[BATCH_SIZE];
+    int32_t remaining[BATCH_SIZE];
+    bool passed[BATCH_SIZE] = {};
+    memcpy(original, selection, selected * sizeof(int32_t));
+    memcpy(remaining, selection, selected * sizeof(int32_t));
+    int32_t remainingCount = selected;
+
+    for(int32_t c = 0; c < count && remainingCount > 0; ++c){
+        memcpy(selection, remaining, remainingCount * sizeof(int32_t));
+        int32_t kept = evaluate(c, selection, remainingCount);
+        for(int32_t i = 0; i < kept; ++i) passed[selection[i]] = true;
+
+        int32_t left = 0;
+        for(int32_t i = 0; i < remainingCount; ++i){
+            remaining[left] = remaining[i];
+            left += !passed[remaining[i]];
+        }
+        remainingCount = left;
+    }
+
+    // Positions keep their original order
+    int32_t res = 0;
+    for(int32_t i = 0; i < selected; ++i){
+        selection[res] = original[i];
+        res += passed[original[i]];
+    }
+    return res;
+}
+
+FilterNode::FilterNode(){
+    type = FilterType::predicate;
+}
+
+void FilterNode::apply(RowBatch& batch) const{
+    switch(type){
+        case FilterType::predicate:
+            predicate.apply(batch);
+            break;
+        case FilterType::conjunction:
+            for(auto& child: children){
+                if(batch.selected == 0) break;
+                child.apply(batch);
+            }
+            break;
+        case FilterType::disjunction:
+            batch.selected = selectAny(batch.selection, batch.selected, children.size(), [&](int32_t c, int32_t* selection, int32_t selected){
+                batch.selected = selected;
+                children[c].apply(batch);
+                return batch.selected;
+            });
+            break;
+    }
+}
+
+int32_t FilterNode::applyPage(const char* page, int32_t count, int32_t rowSize, const RowCodec& codec, int32_t* selection, int32_t selected) const{
+    switch(type){
+        case FilterType::predicate:
+            return predicate.applyPage(page, count, rowSize, codec.offsets[predicate.column], selection, selected);
+        case FilterType::conjunction:
+            for(auto& child: children){
+                if(selected == 0) break;
+                selected = child.applyPage(page, count, rowSize, codec, selection, selected);
+            }
+            return selected;
+        case FilterType::disjunction:
+            return selectAny(selection, selected, children.size(), [&](int32_t c, int32_t* childSelection, int32_t childSelected){
+                return children[c].applyPage(page, count, rowSize, codec, childSelection, childSelected);
+            });
+    }
+    return selected;
+}
+
+void FilterNode::bind(std::vector<int32_t>& columns){
+    if(type == FilterType::predicate) predicate.position = addColumn(columns, predicate.column);
+    for(auto& child: children) child.bind(columns);
+}
+
+void Filter::add(FilterNode node){
+    switch(node.type){
+        case FilterType::predicate:
+            predicates.push_back(std::move(node.predicate));
+            break;
+        case FilterType::conjunction:
+            for(auto& child: node.children) add(std::move(child));
+            break;
+        case FilterType::disjunction:
+            residual.push_back(std::move(node));
+            break;
+    }
+}
+
+bool Filter::empty() const{
+    return predicates.empty() && residual.empty();
+}
+
+FilterNode Filter::root() const{
+    FilterNode node;
+    node.type = FilterType::conjunction;
+    for(auto& predicate: predicates){
+        node.children.emplace_back();
+        node.children.back().predicate = predicate;
+    }
+    node.children.insert(node.children.end(), residual.begin(), residual.end());
+    return node;
+}
+
+void Filter::bind(std::vector<int32_t>& columns){
+    for(auto& predicate: predicates) predicate.position = addColumn(columns, predicate.column);
+    for(auto& node: residual) node.bind(columns);
+}
+
+void Filter::apply(RowBatch& batch) const{
+    for(auto& predicate: predicates) predicate.apply(batch);
+    for(auto& node: residual){
+        if(batch.selected == 0) break;
+        node.apply(batch);
+    }
+}
+
+int32_t Filter::applyPage(const char* page, int32_t count, int32_t rowSize, const RowCodec& codec, int32_t* selection, int32_t selected) const{
+    for(auto& predicate: predicates){
+        selected = predicate.applyPage(page, count, rowSize, codec.offsets[predicate.column], selection, selected);
+    }
+    for(auto& node: residual){
+        if(selected == 0) break;
+        selected = node.applyPage(page, count, rowSize, codec, selection, selected);
+    }
+    return selected;
+}
+
+int32_t addColumn(std::vector<int32_t>& columns, int32_t column){
+    for(int32_t i = 0; i < columns.size(); ++i){
+        if(columns[i] == column) return i;
+    }
+    columns.push_back(column);
+    return columns.size() - 1;
+}
+
+// =============================================
+//                BATCH SCANNER
+// =============================================
+
+BatchScanner::BatchScanner(Table* table_, const std::vector<int32_t>& columns, std::function<bool(RowBatch&)> consumer_)
+:table(table_), batch(table_, columns), consumer(std::move(consumer_)){
+    this->page = nullptr;
+    this->pageNum = -1;
+
+    for(int32_t col: columns){
+        columnOffsets.push_back(table->codec.offsets[col]);
+    }
+}
+
+bool BatchScanner::push(row_t row){
+    int32_t rowsPerPage = table->getRowsPerPage();
+    int32_t rowPage = row / rowsPerPage + 1;
+
+    // Consecutive rows usually share the page
+    if(page == nullptr || rowPage != pageNum){
+        page = table->pager->read(rowPage);
+        pageNum = rowPage;
+        if(page == nullptr) return false;
+    }
+
+    const char* buffer = page->buffer.get() + (row % rowsPerPage) * table->getRowSize();
+    for(int32_t i = 0; i < batch.columns.size(); ++i){
+        batch.columns[i].append(buffer + columnOffsets[i]);
+    }
+    batch.rows[batch.size++] = row;
+
+    if(batch.size == BATCH_SIZE) return flush();
+    return true;
+}
+
+bool BatchScanner::flush(){
+    // Consumer may read other pages of this table
+    page = nullptr;
+    if(batch.size == 0) return true;
+
+    for(int32_t i = 0; i < batch.size; ++i) batch.selection[i] = i;
+    batch.selected = batch.size;
+    bool res = consumer(batch);
+    batch.clear();
+    return res;
+}
+
+// =============================================
+//                HEAP SCANNER
+// =============================================
+
+HeapScanner::HeapScanner(Table* table_){
+    this->table = table_;
+}
+
+bool HeapScanner::scan(const Filter& filter, const std::function<bool(row_t row)>& callback){
+    int32_t rowsPerPage = table->getRowsPerPage();
+    int32_t rowSize = table->getRowSize();
+    row_t rowSlots = table->getRowSlots();
+    std::vector<row_t> freeRows;
+    if(!table->getFreeRows(freeRows)) return false;
+    auto freeItr = freeRows.begin();
+
+    int32_t selection[BATCH_SIZE];
+    for(row_t first = 0; first < rowSlots; first += rowsPerPage){
+        int32_t count = std::min<row_t>(rowsPerPage, rowSlots - first);
+
+        // Deleted rows are sorted so they are skipped in single pass along with pages
+        int32_t selected = 0;
+        for(int32_t i = 0; i < count; ++i){
+            if(freeItr != freeRows.end() && *freeItr == first + i){
+                ++freeItr;
+                continue;
+            }
+            selection[selected++] = i;
+        }
+        if(selected == 0) continue;
+
+        Page* page = table->pager->read(first / rowsPerPage + 1);
+        if(page == nullptr) return false;
+        selected = filter.applyPage(page->buffer.get(), count, rowSize, table->codec, selection, selected);
+
+        // Callback may read other pages and page can get evicted
+        for(int32_t i = 0; i < selected; ++i){
+            if(!callback(first + selection[i])) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,164 @@
+#include "HeaderFiles/RowBitmap.h"
+#include <algorithm>
+#include <iterator>
+
+RowBitmap::RowBitmap(std::vector<row_t> rows){
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    for(row_t row: rows){
+        uint16_t key = static_cast<uint32_t>(row) >> 16;
+        if(containers.empty() || containers.back().key != key){
+            if(!containers.empty() && containers.back().cardinality > BITMAP_ARRAY_LIMIT) toBitset(containers.back());
+            containers.emplace_back();
+            containers.back().key = key;
+            containers.back().cardinality = 0;
+        }
+        containers.back().values.push_back(static_cast<uint16_t>(row & 0xFFFF));
+        ++containers.back().cardinality;
+    }
+    if(!containers.empty() && containers.back().cardinality > BITMAP_ARRAY_LIMIT) toBitset(containers.back());
+}
+
+RowBitmap RowBitmap::intersect(const RowBitmap& other) const{
+    RowBitmap res;
+    auto a = containers.begin(), b = other.containers.begin();
+    while(a != containers.end() && b != other.containers.end()){
+        if(a->key < b->key) ++a;
+        else if(b->key < a->key) ++b;
+        else{
+            Container container = intersect(*a, *b);
+            if(container.cardinality > 0) res.containers.push_back(std::move(container));
+            ++a;
+            ++b;
+        }
+    }
+    return res;
+}
+
+RowBitmap RowBitmap::unite(const RowBitmap& other) const{
+    RowBitmap res;
+    auto a = containers.begin(), b = other.containers.begin();
+    while(a != containers.end() || b != other.containers.end()){
+        if(b == other.containers.end() || (a != containers.end() && a->key < b->key)){
+            res.containers.push_back(*a++);
+        }
+        else if(a == containers.end() || b->key < a->key){
+            res.containers.push_back(*b++);
+        }
+        else{
+            res.containers.push_back(unite(*a, *b));
+            ++a;
+            ++b;
+        }
+    }
+    return res;
+}
+
+int64_t RowBitmap::cardinality() const{
+    int64_t res = 0;
+    for(auto& container: containers) res += container.cardinality;
+    return res;
+}
+
+bool RowBitmap::empty() const{
+    return containers.empty();
+}
+
+bool RowBitmap::forEach(const std::function<bool(row_t row)>& callback) const{
+    for(auto& container: containers){
+        row_t high = static_cast<row_t>(container.key) << 16;
+        if(!container.isBitset()){
+            for(uint16_t value: container.values){
+                if(!callback(high | value)) return false;
+            }
+            continue;
+        }
+        for(int32_t w = 0; w < BITMAP_WORDS; ++w){
+            uint64_t word = container.bits[w];
+            while(word != 0){
+                int32_t bit = __builtin_ctzll(word);
+                if(!callback(high | (w * 64 + bit))) return false;
+                word &= word - 1;
+            }
+        }
+    }
+    return true;
+}
+
+// =============================================
+//                  CONTAINERS
+// =============================================
+
+RowBitmap::Container RowBitmap::intersect(const Container& a, const Container& b){
+    Container res;
+    res.key = a.key;
+    if(!a.isBitset() && !b.isBitset()){
+        std::set_intersection(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                              std::back_inserter(res.values));
+        res.cardinality = res.values.size();
+    }
+    else if(!a.isBitset() || !b.isBitset()){
+        // Result is never larger than the array so it stays an array
+        const Container& array = a.isBitset() ? b : a;
+        const Container& bitset = a.isBitset() ? a : b;
+        for(uint16_t value: array.values){
+            if(bitset.bits[value >> 6] & (1ULL << (value & 63))) res.values.push_back(value);
+        }
+        res.cardinality = res.values.size();
+    }
+    else{
+        res.bits.resize(BITMAP_WORDS);
+        res.cardinality = 0;
+        for(int32_t w = 0; w < BITMAP_WORDS; ++w){
+            res.bits[w] = a.bits[w] & b.bits[w];
+            res.cardinality += __builtin_popcountll(res.bits[w]);
+        }
+        if(res.cardinality <= BITMAP_ARRAY_LIMIT) toArray(res);
+    }
+    return res;
+}
+
+RowBitmap::Container RowBitmap::unite(const Container& a, const Container& b){
+    Container res;
+    res.key = a.key;
+    if(!a.isBitset() && !b.isBitset()){
+        std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                       std::back_inserter(res.values));
+        res.cardinality = res.values.size();
+        if(res.cardinality > BITMAP_ARRAY_LIMIT) toBitset(res);
+        return res;
+    }
+
+    res = a.isBitset() ? a : b;
+    const Container& other = a.isBitset() ? b : a;
+    if(other.isBitset()){
+        for(int32_t w = 0; w < BITMAP_WORDS; ++w) res.bits[w] |= other.bits[w];
+    }
+    else{
+        for(uint16_t value: other.values) res.bits[value >> 6] |= 1ULL << (value & 63);
+    }
+    res.cardinality = 0;
+    for(uint64_t word: res.bits) res.cardinality += __builtin_popcountll(word);
+    return res;
+}
+
+void RowBitmap::toBitset(Container& container){
+    container.bits.assign(BITMAP_WORDS, 0);
+    for(uint16_t value: container.values) container.bits[value >> 6] |= 1ULL << (value & 63);
+    container.values.clear();
+    container.values.shrink_to_fit();
+}
+
+void RowBitmap::toArray(Container& container){
+    container.values.clear();
+    container.values.reserve(container.cardinality);
+    for(int32_t w = 0; w < BITMAP_WORDS; ++w){
+        uint64_t word = container.bits[w];
+        while(word != 0){
+            container.values.push_back(w * 64 + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+    container.bits.clear();
+    container.bits.shrink_to_fit();
+}
@@ -0,0 +1,190 @@
+#include "HeaderFiles/RowCodec.h"
+
+// =============================================
+//                    VALUE
+// =============================================
+
+Value::Value(){
+    type = DataType::Int;
+    intValue = 0;
+    stringValue = nullptr;
+    stringSize = 0;
+}
+
+Value Value::read(DataType type, const char* cell, int32_t width){
+    Value value;
+    value.type = type;
+    switch(type){
+        case DataType::Int:
+            memcpy(&value.intValue, cell, sizeof(int32_t));
+            break;
+        case DataType::Float:
+            memcpy(&value.floatValue, cell, sizeof(float));
+            break;
+        case DataType::Char:
+            value.charValue = *cell;
+            break;
+        case DataType::Bool:
+            memcpy(&value.boolValue, cell, sizeof(bool));
+            break;
+        case DataType::String:
+            value.stringValue = cell;
+            value.stringSize = strnlen(cell, width);
+            break;
+    }
+    return value;
+}
+
+void Value::write(char* cell, int32_t width) const{
+    switch(type){
+        case DataType::Int:
+            memcpy(cell, &intValue, sizeof(int32_t));
+            break;
+        case DataType::Float:
+            memcpy(cell, &floatValue, sizeof(float));
+            break;
+        case DataType::Char:
+            *cell = charValue;
+            break;
+        case DataType::Bool:
+            memcpy(cell, &boolValue, sizeof(bool));
+            break;
+        case DataType::String:
+            memcpy(cell, stringValue, stringSize);
+            if(stringSize < width) memset(cell + stringSize, 0, width - stringSize);
+            break;
+    }
+}
+
+int Value::compare(const Value& other) const{
+    switch(type){
+        case DataType::Int:
+            return (intValue > other.intValue) - (intValue < other.intValue);
+        case DataType::Float:
+            return (floatValue > other.floatValue) - (floatValue < other.floatValue);
+        case DataType::Char:
+            return (charValue > other.charValue) - (charValue < other.charValue);
+        case DataType::Bool:
+            return (boolValue > other.boolValue) - (boolValue < other.boolValue);
+        case DataType::String: {
+            int res = memcmp(stringValue, other.stringValue, std::min(stringSize, other.stringSize));
+            if(res != 0) return res;
+            return (stringSize > other.stringSize) - (stringSize < other.stringSize);
+        }
+    }
+    return 0;
+}
+
+void Value::appendText(std::string& out) const{
+    char buffer[32];
+    int len;
+    switch(type){
+        case DataType::Int:
+            len = snprintf(buffer, sizeof(buffer), "%d", intValue);
+            out.append(buffer, len);
+            break;
+        case DataType::Float:
+            len = snprintf(buffer, sizeof(buffer), "%f", floatValue);
+            out.append(buffer, len);
+            break;
+        case DataType::Char:
+            out.push_back(charValue);
+            break;
+        case DataType::Bool:
+            out.append(boolValue ? "true" : "false");
+            break;
+        case DataType::String:
+            out.append(stringValue, stringSize);
+            break;
+    }
+}
+
+// =============================================
+//                  ROW CODEC
+// =============================================
+
+RowCodec::RowCodec(){
+    pkeyOffset = 0;
+    rowSize = sizeof(pkey_t);
+}
+
+RowCodec::RowCodec(const std::vector<DataType>& types_, const std::vector<uint32_t>& sizes_){
+    this->types = types_;
+    int32_t offset = 0;
+    for(uint32_t size: sizes_){
+        sizes.push_back(size);
+        offsets.push_back(offset);
+        offset += size;
+    }
+    pkeyOffset = offset;
+    rowSize = offset + sizeof(pkey_t);
+}
+
+int32_t RowCodec::columnCount() const{
+    return types.size();
+}
+
+CodecResult RowCodec::parse(int32_t col, const std::string& text, Value& value) const{
+    return parse(col, text.c_str(), text.size(), value);
+}
+
+CodecResult RowCodec::parse(int32_t col, const char* text, int32_t length, Value& value) const{
+    value.type = types[col];
+    char* end;
+    switch(types[col]){
+        case DataType::Int: {
+            // Same rules as std::stoi. Leading digits must form an int
+            errno = 0;
+            long number = strtol(text, &end, 10);
+            if(end == text || errno == ERANGE) return CodecResult::typeMismatch;
+            if(number < std::numeric_limits<int32_t>::min() || number > std::numeric_limits<int32_t>::max()){
+                return CodecResult::typeMismatch;
+            }
+            value.intValue = static_cast<int32_t>(number);
+            break;
+        }
+        case DataType::Float:
+            errno = 0;
+            value.floatValue = strtof(text, &end);
+            if(end == text || errno == ERANGE) return CodecResult::typeMismatch;
+            break;
+        case DataType::Char:
+            if(length != 1) return CodecResult::typeMismatch;
+            value.charValue = text[0];
+            break;
+        case DataType::Bool:
+            if(length == 4 && memcmp(text, "true", 4) == 0) value.boolValue = true;
+            else if(length == 5 && memcmp(text, "false", 5) == 0) value.boolValue = false;
+            else return CodecResult::typeMismatch;
+            break;
+        case DataType::String:
+            if(length > sizes[col]) return CodecResult::stringTooLarge;
+            value.stringValue = text;
+            value.stringSize = length;
+            break;
+    }
+    return CodecResult::success;
+}
+
+CodecResult RowCodec::encode(const std::vector<std::string>& data, char* row) const{
+    Value value;
+    for(int32_t col = 0; col < types.size(); ++col){
+        auto res = parse(col, data[col], value);
+        if(res != CodecResult::success) return res;
+        set(row, col, value);
+    }
+    return CodecResult::success;
+}
+
+void RowCodec::appendText(const char* row, int32_t col, std::string& out) const{
+    get(row, col).appendText(out);
+}
+
+// =============================================
+//                     ROW
+// =============================================
+
+Row::Row(const RowCodec& codec_){
+    this->codec = &codec_;
+    this->buffer = std::make_unique<char[]>(codec->rowSize);
+}
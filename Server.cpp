@@ -0,0 +1,410 @@
+#include "Executor.cpp"
+#include "HeaderFiles/Protocol.h"
+#include <csignal>
+#include <cerrno>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/// ---------------- CLASS DESCRIPTION ----------------
+/// Server lets many clients share one process, and so one buffer pool, over HeaderFiles/Protocol.h
+/// 1. Event loop => one thread waiting on epoll. Accepts clients, reads their queries and sends
+///                  output which could not be sent right away
+/// 2. Workers    => fixed pool which parses and executes queries. Rows are streamed to client as the
+///                  sink of the session fills SERVER_BATCH_SIZE bytes
+/// Every client has a Session with its own Executor, so prepared statements belong to one client
+/// Queries of a session run one at a time in order. Queries of different sessions run on any worker
+/// Statements on different tables run in parallel. Those on one table wait for its latch
+/// Output waiting for a client is capped at SERVER_OUTPUT_LIMIT bytes. Worker streaming rows to a client
+/// that reads slower waits for it to catch up, keeping latches of its statement meanwhile
+/// Messages of statements are sent to client in done message and never printed by server
+/// SIGINT and SIGTERM stop the server after running queries finish and close every table
+
+const int32_t SERVER_MAX_EVENTS = 64;
+const int32_t SERVER_READ_SIZE = (1 << 16);
+const size_t SERVER_OUTPUT_LIMIT = (1 << 22);               // Bytes queued for one client before worker waits
+
+class Session{
+    int fileDescriptor;
+    int epollDescriptor;
+    bool writeArmed;                    // Waiting for EPOLLOUT to send rest of output
+    std::string output;                 // Messages not yet sent from position sent
+    size_t sent;
+    bool columnsSent;                   // Columns of running query were sent. Worker only
+
+public:
+    Executor executor;
+    std::string input;                  // Bytes received after last whole message. Event loop only
+
+    std::mutex mutex;                   // Guards output and everything below
+    std::condition_variable drained;    // Output fell below SERVER_OUTPUT_LIMIT or session was closed
+    std::deque<std::string> waiting;    // Queries received while another one runs
+    bool busy;                          // A worker holds a query of this session
+    bool closed;
+
+    Session(int fileDescriptor_, int epollDescriptor_, std::shared_ptr<TableManager> manager):
+            executor(std::move(manager)){
+        this->fileDescriptor = fileDescriptor_;
+        this->epollDescriptor = epollDescriptor_;
+        this->writeArmed = false;
+        this->sent = 0;
+        this->columnsSent = false;
+        this->busy = false;
+        this->closed = false;
+        executor.quiet = true;
+        executor.captureDetail = true;
+        executor.sink.setFormat(OutputFormat::binary);
+    }
+
+    ~Session(){
+        close(fileDescriptor);
+    }
+
+    int descriptor() const{
+        return fileDescriptor;
+    }
+
+    /// Queues message and sends as much as socket takes. false once client is gone
+    /// Waits first while SERVER_OUTPUT_LIMIT bytes are still queued for client
+    bool post(MessageType type, const char* payload, size_t length){
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this]{ return closed || output.size() - sent < SERVER_OUTPUT_LIMIT; });
+        if(closed) return false;
+        appendMessage(output, type, payload, length);
+        if(!writeArmed) send();
+        return !closed;
+    }
+
+    /// Sends queued output without blocking. mutex must be held
+    /// When socket is full, rest is sent by event loop once EPOLLOUT arrives
+    void send(){
+        size_t start = sent;
+        while(sent < output.size()){
+            ssize_t len = ::send(fileDescriptor, output.data() + sent, output.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if(len > 0){
+                sent += len;
+                continue;
+            }
+            if(len < 0 && errno == EINTR) continue;
+            if(len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+                if(!writeArmed) watch(EPOLLIN | EPOLLOUT);
+                writeArmed = true;
+                if(sent == start) return;
+                // Sent part is dropped once it outgrows what is left, so output stays near the limit
+                if(sent > output.size() - sent){
+                    output.erase(0, sent);
+                    sent = 0;
+                }
+                drained.notify_all();
+                return;
+            }
+            disconnect();
+            return;
+        }
+        output.clear();
+        sent = 0;
+        if(writeArmed) watch(EPOLLIN);
+        writeArmed = false;
+        drained.notify_all();
+    }
+
+    /// Marks client gone and wakes worker waiting to post. mutex must be held
+    void disconnect(){
+        closed = true;
+        drained.notify_all();
+    }
+
+    /// Runs query and streams its columns, rows and done message to client. Worker only
+    void run(const std::string& text){
+        columnsSent = false;
+        executor.sink.capture([this](const char* data, size_t length){
+            return postColumns() && post(MessageType::rows, data, length);
+        }, SERVER_BATCH_SIZE);
+
+        Parser parser;
+        auto prepareRes = parser.parse(text);
+        auto status = MessageStatus::failure;
+        std::string message;
+        if(prepareRes != PrepareResult::success){
+            message = prepareMessage(prepareRes);
+        }
+        else{
+            executor.detail.clear();
+            auto executeRes = executor.execute(parser);
+            executor.sink.flush();
+            message = executor.resultMessage(executeRes);
+            if(executeRes == ExecuteResult::success) status = MessageStatus::success;
+        }
+        postColumns();
+
+        std::string payload(1, static_cast<char>(status));
+        payload += message;
+        post(MessageType::done, payload.data(), payload.size());
+    }
+
+private:
+    void watch(uint32_t events){
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fileDescriptor;
+        epoll_ctl(epollDescriptor, EPOLL_CTL_MOD, fileDescriptor, &event);
+    }
+
+    /// Sends column names given to sink once per query, before first rows
+    bool postColumns(){
+        if(columnsSent) return true;
+        auto& names = executor.sink.columnNames();
+        if(names.empty()) return true;
+        columnsSent = true;
+
+        std::string payload;
+        auto count = static_cast<uint32_t>(names.size());
+        payload.append(reinterpret_cast<const char*>(&count), sizeof(uint32_t));
+        for(auto& name: names){
+            auto length = static_cast<uint32_t>(name.size());
+            payload.append(reinterpret_cast<const char*>(&length), sizeof(uint32_t));
+            payload.append(name);
+        }
+        return post(MessageType::columns, payload.data(), payload.size());
+    }
+};
+
+class Server{
+    std::shared_ptr<TableManager> manager;
+    int32_t workerCount;
+    int listenDescriptor;
+    int epollDescriptor;
+    std::unordered_map<int, std::shared_ptr<Session>> sessions;
+
+    // Work queue
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<std::pair<std::shared_ptr<Session>, std::string>> queries;
+    bool stopping;
+
+    static int wakeDescriptor;          // eventfd written by signal handler
+    static volatile sig_atomic_t stopRequested;
+
+public:
+    Server(std::shared_ptr<TableManager> manager_, int32_t workerCount_){
+        this->manager = std::move(manager_);
+        this->workerCount = std::max(1, workerCount_);
+        this->listenDescriptor = -1;
+        this->epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+        this->stopping = false;
+        wakeDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+
+    ~Server(){
+        sessions.clear();
+        if(listenDescriptor >= 0) close(listenDescriptor);
+        close(epollDescriptor);
+        close(wakeDescriptor);
+    }
+
+    /// Listens on unix:<path> or on 127.0.0.1:<port>
+    bool listen(const std::string& address){
+        if(epollDescriptor < 0 || wakeDescriptor < 0) return false;
+        if(address.compare(0, 5, "unix:") == 0){
+            std::string path = address.substr(5);
+            sockaddr_un socketAddress{};
+            if(path.empty() || path.size() >= sizeof(socketAddress.sun_path)) return false;
+            socketAddress.sun_family = AF_UNIX;
+            memcpy(socketAddress.sun_path, path.c_str(), path.size());
+            unlink(path.c_str());
+            listenDescriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if(listenDescriptor < 0) return false;
+            if(bind(listenDescriptor, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) != 0) return false;
+        }
+        else{
+            char* end = nullptr;
+            long port = strtol(address.c_str(), &end, 10);
+            if(address.empty() || *end != '\0' || port <= 0 || port > 65535) return false;
+            sockaddr_in socketAddress{};
+            socketAddress.sin_family = AF_INET;
+            socketAddress.sin_port = htons(static_cast<uint16_t>(port));
+            socketAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            listenDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if(listenDescriptor < 0) return false;
+            int reuse = 1;
+            setsockopt(listenDescriptor, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            if(bind(listenDescriptor, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) != 0) return false;
+        }
+        if(::listen(listenDescriptor, SOMAXCONN) != 0) return false;
+        return add(listenDescriptor) && add(wakeDescriptor);
+    }
+
+    /// Serves clients until SIGINT or SIGTERM
+    void run(){
+        signal(SIGPIPE, SIG_IGN);
+        signal(SIGINT, requestStop);
+        signal(SIGTERM, requestStop);
+
+        std::vector<std::thread> workers;
+        workers.reserve(workerCount);
+        for(int32_t i = 0; i < workerCount; ++i) workers.emplace_back([this]{ work(); });
+
+        epoll_event events[SERVER_MAX_EVENTS];
+        while(!stopRequested){
+            int count = epoll_wait(epollDescriptor, events, SERVER_MAX_EVENTS, -1);
+            if(count < 0 && errno != EINTR) break;
+            for(int i = 0; i < count; ++i){
+                int fd = events[i].data.fd;
+                if(fd == listenDescriptor) accept();
+                else if(fd != wakeDescriptor) handle(fd, events[i].events);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueReady.notify_all();
+        // Nobody sends output any more, so workers waiting for a client to read are let go
+        for(auto& session: sessions){
+            std::lock_guard<std::mutex> lock(session.second->mutex);
+            session.second->disconnect();
+        }
+        for(auto& worker: workers) worker.join();
+        sessions.clear();
+        manager->closeAll();
+    }
+
+private:
+    static void requestStop(int){
+        stopRequested = 1;
+        uint64_t one = 1;
+        if(write(wakeDescriptor, &one, sizeof(one)) < 0) return;
+    }
+
+    bool add(int fd){
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        return epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    void accept(){
+        while(true){
+            int fd = accept4(listenDescriptor, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if(fd < 0) return;
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            auto session = std::make_shared<Session>(fd, epollDescriptor, manager);
+            sessions[fd] = session;
+            if(!add(fd)) sessions.erase(fd);
+        }
+    }
+
+    void handle(int fd, uint32_t events){
+        auto itr = sessions.find(fd);
+        if(itr == sessions.end()) return;
+        std::shared_ptr<Session> session = itr->second;
+
+        bool open = !(events & (EPOLLHUP | EPOLLERR));
+        if(open && (events & EPOLLIN)) open = receive(session);
+        if(open && (events & EPOLLOUT)){
+            std::lock_guard<std::mutex> lock(session->mutex);
+            session->send();
+            open = !session->closed;
+        }
+        if(open) return;
+
+        // Session lives on until worker running its query is done with it
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            session->disconnect();
+        }
+        epoll_ctl(epollDescriptor, EPOLL_CTL_DEL, fd, nullptr);
+        sessions.erase(itr);
+    }
+
+    /// Reads what has arrived and hands every whole query to workers. false when client is gone
+    bool receive(const std::shared_ptr<Session>& session){
+        auto& input = session->input;
+        char chunk[SERVER_READ_SIZE];
+        while(true){
+            ssize_t len = recv(session->descriptor(), chunk, sizeof(chunk), MSG_DONTWAIT);
+            if(len > 0){
+                input.append(chunk, len);
+                continue;
+            }
+            if(len == 0) return false;
+            if(errno == EINTR) continue;
+            if(errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+
+        size_t offset = 0;
+        while(input.size() - offset >= MESSAGE_HEADER_SIZE){
+            const char* message = input.data() + offset;
+            uint32_t length = messageLength(message);
+            if(length == 0 || length > MAX_MESSAGE_SIZE) return false;
+            if(input.size() - offset < sizeof(uint32_t) + length) break;
+            if(static_cast<MessageType>(message[sizeof(uint32_t)]) != MessageType::query) return false;
+            submit(session, std::string(message + MESSAGE_HEADER_SIZE, length - sizeof(uint8_t)));
+            offset += sizeof(uint32_t) + length;
+        }
+        input.erase(0, offset);
+        return true;
+    }
+
+    void submit(const std::shared_ptr<Session>& session, std::string&& text){
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            if(session->busy){
+                session->waiting.push_back(std::move(text));
+                return;
+            }
+            session->busy = true;
+        }
+        enqueue(session, std::move(text));
+    }
+
+    void enqueue(const std::shared_ptr<Session>& session, std::string&& text){
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queries.emplace_back(session, std::move(text));
+        }
+        queueReady.notify_one();
+    }
+
+    void work(){
+        while(true){
+            std::shared_ptr<Session> session;
+            std::string text;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueReady.wait(lock, [this]{ return stopping || !queries.empty(); });
+                if(stopping) return;
+                session = std::move(queries.front().first);
+                text = std::move(queries.front().second);
+                queries.pop_front();
+            }
+
+            session->run(text);
+
+            // Next query of session goes to back of queue so that other sessions get their turn
+            std::unique_lock<std::mutex> lock(session->mutex);
+            if(session->closed || session->waiting.empty()){
+                session->busy = false;
+                continue;
+            }
+            text = std::move(session->waiting.front());
+            session->waiting.pop_front();
+            lock.unlock();
+            enqueue(session, std::move(text));
+        }
+    }
+};
+
+int Server::wakeDescriptor = -1;
+volatile sig_atomic_t Server::stopRequested = 0;
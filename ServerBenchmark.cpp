@@ -0,0 +1,148 @@
+#include "HeaderFiles/Protocol.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/// Load generator for `DBMS --server`
+/// ServerBench <unix:path | port> [clients] [requests per client] [tables]
+/// Tables bench_0 ... are created afresh and client i works on bench_<i % tables>. Every client inserts its own
+/// rows and reads each back with a point select, waiting for each answer before sending next query
+/// Reports throughput and latency percentiles
+
+int connectTo(const std::string& address){
+    int fd;
+    if(address.compare(0, 5, "unix:") == 0){
+        sockaddr_un socketAddress{};
+        socketAddress.sun_family = AF_UNIX;
+        strncpy(socketAddress.sun_path, address.c_str() + 5, sizeof(socketAddress.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) != 0) return -1;
+    }
+    else{
+        sockaddr_in socketAddress{};
+        socketAddress.sin_family = AF_INET;
+        socketAddress.sin_port = htons(static_cast<uint16_t>(atoi(address.c_str())));
+        socketAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if(fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) != 0) return -1;
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+    return fd;
+}
+
+bool readFully(int fd, char* data, size_t length){
+    while(length > 0){
+        ssize_t len = recv(fd, data, length, 0);
+        if(len <= 0) return false;
+        data += len;
+        length -= len;
+    }
+    return true;
+}
+
+/// Sends query and reads messages up to its done. false when connection broke or query failed
+bool query(int fd, const std::string& text, std::string& message){
+    std::string out;
+    appendMessage(out, MessageType::query, text.data(), text.size());
+    if(send(fd, out.data(), out.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(out.size())) return false;
+
+    std::string payload;
+    while(true){
+        char header[MESSAGE_HEADER_SIZE];
+        if(!readFully(fd, header, MESSAGE_HEADER_SIZE)) return false;
+        uint32_t length = messageLength(header);
+        payload.resize(length - sizeof(uint8_t));
+        if(!readFully(fd, &payload[0], payload.size())) return false;
+        if(static_cast<MessageType>(header[sizeof(uint32_t)]) != MessageType::done) continue;
+        message.assign(payload, 1, std::string::npos);
+        return static_cast<MessageStatus>(payload[0]) == MessageStatus::success;
+    }
+}
+
+int main(int argc, char* argv[]){
+    if(argc < 2){
+        printf("Usage: ServerBench <unix:path | port> [clients] [requests per client] [tables]\n");
+        return 1;
+    }
+    std::string address = argv[1];
+    int32_t clients = argc > 2 ? std::max(1, atoi(argv[2])) : 8;
+    int64_t requests = argc > 3 ? std::max(1, atoi(argv[3])) : 10000;
+    int32_t tables = argc > 4 ? std::max(1, atoi(argv[4])) : 1;
+
+    int fd = connectTo(address);
+    if(fd < 0){
+        printf("Unable to connect to '%s'\n", address.c_str());
+        return 1;
+    }
+    std::string message;
+    for(int32_t i = 0; i < tables; ++i){
+        std::string name = "bench_" + std::to_string(i);
+        query(fd, "drop table " + name, message);
+        if(!query(fd, "create table " + name + " {id: int, name: string(16), score: float}", message)){
+            printf("Unable to create table %s: %s\n", name.c_str(), message.c_str());
+            return 1;
+        }
+    }
+    close(fd);
+
+    std::vector<std::vector<double>> latencies(clients);
+    std::vector<int64_t> failures(clients);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for(int32_t client = 0; client < clients; ++client){
+        threads.emplace_back([&, client]{
+            int fd = connectTo(address);
+            if(fd < 0){
+                failures[client] = requests;
+                return;
+            }
+            auto& latency = latencies[client];
+            latency.reserve(requests);
+            std::string table = "bench_" + std::to_string(client % tables);
+            std::string text, message;
+            for(int64_t i = 0; i < requests; ++i){
+                int64_t id = (i / 2) * clients + client;
+                if(i % 2 == 0) text = "insert into " + table + " {" + std::to_string(id) + ", \"client\", " + std::to_string(i) + ".5}";
+                else text = "select * from " + table + " where id == " + std::to_string(id);
+
+                auto t1 = std::chrono::steady_clock::now();
+                bool ok = query(fd, text, message);
+                auto t2 = std::chrono::steady_clock::now();
+                latency.push_back(std::chrono::duration<double, std::micro>(t2 - t1).count());
+                if(!ok && failures[client]++ == 0) fprintf(stderr, "Client %d: '%s' failed: %s\n", client, text.c_str(), message.c_str());
+            }
+            close(fd);
+        });
+    }
+    for(auto& thread: threads) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> all;
+    int64_t failed = 0;
+    for(int32_t client = 0; client < clients; ++client){
+        all.insert(all.end(), latencies[client].begin(), latencies[client].end());
+        failed += failures[client];
+    }
+    if(all.empty()){
+        printf("No query was answered\n");
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&all](double p){ return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))]; };
+
+    printf("%d client(s) on %d table(s), %zu queries in %.3f s: %.0f queries/s, %lld failed\n",
+           clients, tables, all.size(), seconds, all.size() / seconds, static_cast<long long>(failed));
+    printf("Latency us: p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n",
+           percentile(0.5), percentile(0.9), percentile(0.99), all.back());
+    return failed == 0 ? 0 : 1;
+}
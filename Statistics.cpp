@@ -0,0 +1,381 @@
+#include "HeaderFiles/Statistics.h"
+#include "HeaderFiles/RowBatch.h"
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <atomic>
+
+// =============================================
+//                COLUMN STATS
+// =============================================
+
+ColumnStats::ColumnStats(){
+    type = DataType::Int;
+    width = 0;
+    count = 0;
+    distinct = 0;
+    nullFraction = 0;
+}
+
+Value ColumnStats::value(const std::string& cell) const{
+    return Value::read(type, cell.data(), cell.size());
+}
+
+Value ColumnStats::value(const char* cell) const{
+    return Value::read(type, cell, width);
+}
+
+std::string ColumnStats::key(const char* cell) const{
+    if(type == DataType::String) return std::string(cell, strnlen(cell, width));
+    return std::string(cell, width);
+}
+
+std::string ColumnStats::text(const std::string& cell) const{
+    std::string out;
+    value(cell).appendText(out);
+    return out;
+}
+
+/// Position of value on number line. Strings have none and are assumed to
+/// lie in middle of their bucket
+static bool toNumber(const Value& value, double& number){
+    switch(value.type){
+        case DataType::Int:
+            number = value.intValue;
+            return true;
+        case DataType::Float:
+            number = value.floatValue;
+            return true;
+        case DataType::Char:
+            number = value.charValue;
+            return true;
+        case DataType::Bool:
+            number = value.boolValue;
+            return true;
+        case DataType::String:
+            break;
+    }
+    return false;
+}
+
+/// Where x lies between low and high as fraction. 0.5 if it can't be told
+static double interpolate(const Value& low, const Value& high, const Value& x){
+    double l, h, v;
+    if(toNumber(low, l) && toNumber(high, h) && toNumber(x, v) && h > l){
+        return std::min(1.0, std::max(0.0, (v - l) / (h - l)));
+    }
+    return 0.5;
+}
+
+void ColumnStats::build(std::vector<std::string>& cells){
+    std::sort(cells.begin(), cells.end(), [&](const std::string& a, const std::string& b){
+        return value(a).compare(value(b)) < 0;
+    });
+
+    count = cells.size();
+    distinct = 0;
+    nullFraction = 0;
+    bounds.clear();
+    mcvs.clear();
+    mcvCounts.clear();
+    if(cells.empty()) return;
+    min = cells.front();
+    max = cells.back();
+
+    // Equal values are adjacent after sorting. Every run is one distinct value
+    std::vector<std::pair<row_t, row_t>> runs;          // (length, start)
+    row_t start = 0;
+    for(row_t i = 1; i <= cells.size(); ++i){
+        if(i == cells.size() || cells[i] != cells[start]){
+            runs.emplace_back(i - start, start);
+            start = i;
+        }
+    }
+    distinct = runs.size();
+
+    int32_t mcvCount = std::min<row_t>(MCV_COUNT, runs.size());
+    std::partial_sort(runs.begin(), runs.begin() + mcvCount, runs.end(), [](const auto& a, const auto& b){
+        return a.first > b.first;
+    });
+    for(int32_t i = 0; i < mcvCount && runs[i].first > 1; ++i){
+        mcvs.push_back(cells[runs[i].second]);
+        mcvCounts.push_back(runs[i].first);
+    }
+
+    int32_t buckets = std::min<row_t>(HISTOGRAM_BUCKETS, cells.size());
+    for(int32_t b = 1; b <= buckets; ++b){
+        bounds.push_back(cells[(row_t)((int64_t)b * cells.size() / buckets) - 1]);
+    }
+}
+
+double ColumnStats::fractionBelow(const std::string& cell) const{
+    Value key = value(cell);
+    if(key.compare(value(min)) <= 0) return 0;
+    if(key.compare(value(max)) > 0) return 1;
+    if(bounds.empty()) return interpolate(value(min), value(max), key);
+
+    // First bucket whose largest value is not below key
+    int32_t bucket = 0;
+    while(bucket < bounds.size() && value(bounds[bucket]).compare(key) < 0) ++bucket;
+    if(bucket == bounds.size()) return 1;
+
+    Value low = value(bucket == 0 ? min : bounds[bucket - 1]);
+    return (bucket + interpolate(low, value(bounds[bucket]), key)) / bounds.size();
+}
+
+double ColumnStats::fractionEqual(const std::string& cell) const{
+    Value key = value(cell);
+    if(key.compare(value(min)) < 0 || key.compare(value(max)) > 0) return 0;
+
+    row_t common = 0;
+    for(int32_t i = 0; i < mcvs.size(); ++i){
+        if(value(mcvs[i]).compare(key) == 0) return double(mcvCounts[i]) / count;
+        common += mcvCounts[i];
+    }
+
+    // Remaining rows are assumed to be spread evenly over remaining values
+    row_t rest = count - std::min(common, count);
+    row_t restDistinct = distinct - std::min<row_t>(mcvs.size(), distinct);
+    if(rest == 0 || restDistinct == 0) return 0;
+    return double(rest) / count / restDistinct;
+}
+
+double ColumnStats::selectivity(ComparisonType op, const std::string& cell) const{
+    if(count == 0 || distinct == 0) return 0;
+    double below = fractionBelow(cell);
+    double equal = fractionEqual(cell);
+    double res = 1;
+    switch(op){
+        case ComparisonType::equal:
+            res = equal;
+            break;
+        case ComparisonType::notEqual:
+            res = 1 - equal;
+            break;
+        case ComparisonType::lessThan:
+            res = below;
+            break;
+        case ComparisonType::lessThanOrEqual:
+            res = below + equal;
+            break;
+        case ComparisonType::greaterThan:
+            res = 1 - below - equal;
+            break;
+        case ComparisonType::greaterThanOrEqual:
+            res = 1 - below;
+            break;
+        case ComparisonType::error:
+            break;
+    }
+    return (1 - nullFraction) * std::min(1.0, std::max(0.0, res));
+}
+
+void ColumnStats::recordInsert(const char* cell){
+    std::string k = key(cell);
+    Value v = value(cell);
+    if(count++ == 0){
+        min = max = k;
+        distinct = 1;
+        return;
+    }
+
+    // Histogram keeps its shape. Only extremes are certain to be new values
+    if(v.compare(value(min)) < 0){
+        min = k;
+        ++distinct;
+    }
+    else if(v.compare(value(max)) > 0){
+        max = k;
+        ++distinct;
+    }
+    for(int32_t i = 0; i < mcvs.size(); ++i){
+        if(value(mcvs[i]).compare(v) == 0){
+            ++mcvCounts[i];
+            break;
+        }
+    }
+}
+
+void ColumnStats::recordDelete(const char* cell){
+    if(count > 0) --count;
+    Value v = value(cell);
+    for(int32_t i = 0; i < mcvs.size(); ++i){
+        if(value(mcvs[i]).compare(v) == 0){
+            if(mcvCounts[i] > 0) --mcvCounts[i];
+            break;
+        }
+    }
+}
+
+// =============================================
+//                 TABLE STATS
+// =============================================
+
+TableStats::TableStats(){
+    numRows = 0;
+    modified = 0;
+    dirty = false;
+}
+
+bool TableStats::empty() const{
+    return columns.empty();
+}
+
+bool TableStats::isStale() const{
+    if(columns.empty()) return true;
+    return modified > STATS_STALE_FRACTION * std::max<row_t>(numRows, 1);
+}
+
+bool TableStats::collect(Table* table){
+    int32_t columnCount = table->codec.columnCount();
+    std::vector<std::vector<std::string>> values(columnCount);
+
+    HeapScanner heap(table);
+    bool res = heap.scan({}, [&](row_t row)->bool{
+        Cursor cursor(table);
+        cursor.row = row;
+        const char* buffer = cursor.value();
+        if(buffer == nullptr) return false;
+        for(int32_t col = 0; col < columnCount; ++col){
+            const char* cell = table->codec.cell(buffer, col);
+            int32_t width = table->columnSizes[col];
+            if(table->columnTypes[col] == DataType::String) width = strnlen(cell, width);
+            values[col].emplace_back(cell, width);
+        }
+        return true;
+    });
+    if(!res) return false;
+
+    std::vector<ColumnStats> built(columnCount);
+    for(int32_t col = 0; col < columnCount; ++col){
+        built[col].type = table->columnTypes[col];
+        built[col].width = table->columnSizes[col];
+    }
+
+    // Sorting dominates. Every column is sorted independently on its own thread
+    std::atomic<int32_t> next(0);
+    auto worker = [&](){
+        for(int32_t col = next++; col < columnCount; col = next++){
+            built[col].build(values[col]);
+        }
+    };
+    int32_t threadCount = std::min<int32_t>(columnCount, std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for(int32_t i = 1; i < threadCount; ++i) threads.emplace_back(worker);
+    worker();
+    for(auto& thread: threads) thread.join();
+
+    columns = std::move(built);
+    numRows = table->getRowCount();
+    modified = 0;
+    dirty = true;
+    return true;
+}
+
+void TableStats::recordInsert(const RowCodec& codec, const char* row){
+    if(columns.empty()) return;
+    for(int32_t col = 0; col < columns.size(); ++col) columns[col].recordInsert(codec.cell(row, col));
+    ++numRows;
+    ++modified;
+    dirty = true;
+}
+
+void TableStats::recordDelete(const RowCodec& codec, const char* row){
+    if(columns.empty()) return;
+    for(int32_t col = 0; col < columns.size(); ++col) columns[col].recordDelete(codec.cell(row, col));
+    if(numRows > 0) --numRows;
+    ++modified;
+    dirty = true;
+}
+
+void TableStats::clear(){
+    columns.clear();
+    numRows = 0;
+    modified = 0;
+    dirty = true;
+}
+
+static void writeValue(std::ofstream& file, const std::string& value){
+    int32_t size = value.size();
+    file.write((const char*)&size, sizeof(int32_t));
+    file.write(value.data(), size);
+}
+
+static bool readValue(std::ifstream& file, std::string& value){
+    int32_t size;
+    if(!file.read((char*)&size, sizeof(int32_t)) || size < 0 || size > PAGE_SIZE) return false;
+    value.resize(size);
+    return (bool)file.read(&value[0], size);
+}
+
+bool TableStats::save(){
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if(!file) return false;
+
+    int32_t version = STATS_VERSION;
+    int32_t columnCount = columns.size();
+    file.write((const char*)&version, sizeof(int32_t));
+    file.write((const char*)&numRows, sizeof(row_t));
+    file.write((const char*)&modified, sizeof(row_t));
+    file.write((const char*)&columnCount, sizeof(int32_t));
+    for(auto& stats: columns){
+        int32_t bucketCount = stats.bounds.size();
+        int32_t mcvCount = stats.mcvs.size();
+        file.write((const char*)&stats.type, sizeof(DataType));
+        file.write((const char*)&stats.width, sizeof(int32_t));
+        file.write((const char*)&stats.count, sizeof(row_t));
+        file.write((const char*)&stats.distinct, sizeof(row_t));
+        file.write((const char*)&stats.nullFraction, sizeof(double));
+        writeValue(file, stats.min);
+        writeValue(file, stats.max);
+        file.write((const char*)&bucketCount, sizeof(int32_t));
+        for(auto& bound: stats.bounds) writeValue(file, bound);
+        file.write((const char*)&mcvCount, sizeof(int32_t));
+        for(int32_t i = 0; i < mcvCount; ++i){
+            writeValue(file, stats.mcvs[i]);
+            file.write((const char*)&stats.mcvCounts[i], sizeof(row_t));
+        }
+    }
+    if(!file) return false;
+    dirty = false;
+    return true;
+}
+
+bool TableStats::load(){
+    std::ifstream file(fileName, std::ios::binary);
+    if(!file) return false;
+
+    // Files of older layout are ignored and stats are collected again
+    int32_t version, columnCount;
+    if(!file.read((char*)&version, sizeof(int32_t)) || version != STATS_VERSION) return false;
+    if(!file.read((char*)&numRows, sizeof(row_t))) return false;
+    if(!file.read((char*)&modified, sizeof(row_t))) return false;
+    if(!file.read((char*)&columnCount, sizeof(int32_t))) return false;
+
+    std::vector<ColumnStats> loaded(columnCount);
+    for(auto& stats: loaded){
+        int32_t bucketCount, mcvCount;
+        file.read((char*)&stats.type, sizeof(DataType));
+        file.read((char*)&stats.width, sizeof(int32_t));
+        file.read((char*)&stats.count, sizeof(row_t));
+        file.read((char*)&stats.distinct, sizeof(row_t));
+        file.read((char*)&stats.nullFraction, sizeof(double));
+        if(!readValue(file, stats.min) || !readValue(file, stats.max)) return false;
+        if(!file.read((char*)&bucketCount, sizeof(int32_t)) || bucketCount < 0) return false;
+        stats.bounds.resize(bucketCount);
+        for(auto& bound: stats.bounds){
+            if(!readValue(file, bound)) return false;
+        }
+        if(!file.read((char*)&mcvCount, sizeof(int32_t)) || mcvCount < 0) return false;
+        stats.mcvs.resize(mcvCount);
+        stats.mcvCounts.resize(mcvCount);
+        for(int32_t i = 0; i < mcvCount; ++i){
+            if(!readValue(file, stats.mcvs[i])) return false;
+            if(!file.read((char*)&stats.mcvCounts[i], sizeof(row_t))) return false;
+        }
+    }
+    columns = std::move(loaded);
+    dirty = false;
+    return true;
+}
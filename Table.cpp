@@ -1,12 +1,14 @@
 #include "HeaderFiles/Table.h"
+#include <algorithm>
 
 // =============================================
 //                  TABLE
 // =============================================
 
-Table::Table(std::string tableName, const std::string& fileName){
+Table::Table(std::string tableName, const std::string& fileName, WriteAheadLog* log_){
+    this->log = log_;
     try{
-        this->pager = std::make_unique<Pager<Page>>(fileName.c_str());
+        this->pager = std::make_unique<Pager<Page>>(fileName.c_str(), log);
     }
     catch(...){
         throw;
@@ -19,6 +21,7 @@ Table::Table(std::string tableName, const std::string& fileName){
     // 4. Empty Rows
     this->tableOpen = true;
     this->tableName = std::move(tableName);
+    this->fileName = fileName;
     this->numRows = 0;
     this->rowSize = 0;
     this->rowsPerPage = 0;
@@ -27,6 +30,8 @@ Table::Table(std::string tableName, const std::string& fileName){
     this->rowStack = nullptr;
     this->stackSize = 0;
     this->nextPKey = 1;
+    this->tableIsIndexed = false;
+    this->anyIndex = -1;
 }
 
 Table::~Table(){
@@ -34,8 +39,13 @@ Table::~Table(){
 }
 
 bool Table::close(){
-    if(tableOpen) return pager->close();
-    return false;
+    if(stats.dirty && !stats.fileName.empty()) stats.save();
+    if(!tableOpen) return false;
+    tableOpen = false;
+    // Index files are written out as their trees are destroyed
+    for(auto& tree: trees) tree.reset();
+    if(freePager != nullptr) freePager->close();
+    return pager->close();
 }
 
 Cursor Table::start(){
@@ -98,6 +108,7 @@ void Table::calculateRowInfo(){
     }
     this->rowSize += sizeof(pkey_t);
     this->rowsPerPage = PAGE_SIZE/rowSize;
+    this->codec = RowCodec(columnTypes, columnSizes);
     int32_t count = columnSizes.size();
     this->indexed.assign(count, false);
     this->stackPtr.assign(count, 0);
@@ -196,9 +207,30 @@ void Table::deSerailizeColumnMetadata(char* metadataBuffer) {
     rowStack = new(metadataBuffer + offset) row_t[stackSize];
 }
 
+row_t* Table::freeRowEntry(row_t index, bool write){
+    if(index < stackSize) return rowStack + index;
+    if(freePager == nullptr){
+        if(freeRowsFileName.empty()) return nullptr;
+        try{
+            // Commits together with heap file like index files
+            freePager = std::make_unique<Pager<Page>>(freeRowsFileName.c_str(), log, pager->getLogFile());
+        }
+        catch(...){
+            return nullptr;
+        }
+    }
+    int32_t entriesPerPage = PAGE_SIZE / sizeof(row_t);
+    Page* page = freePager->read((index - stackSize) / entriesPerPage + 1);
+    if(page == nullptr) return nullptr;
+    if(write) page->hasUncommitedChanges = true;
+    return reinterpret_cast<row_t*>(page->buffer.get()) + (index - stackSize) % entriesPerPage;
+}
+
 row_t Table::nextFreeRowLocation(){
     if(rowStack[0] == 0) return numRows;
-    row_t nextRow = rowStack[rowStack[0]];
+    row_t* entry = freeRowEntry(rowStack[0], false);
+    if(entry == nullptr) return -1;
+    row_t nextRow = *entry;
     rowStack[0]--;
     pager->header->hasUncommitedChanges = true;
     // char* buffer = page->buffer.get();
@@ -208,28 +240,66 @@ row_t Table::nextFreeRowLocation(){
     return nextRow;
 }
 
-void Table::addFreeRowLocation(row_t location){
+bool Table::addFreeRowLocation(row_t location){
+    row_t* entry = freeRowEntry(rowStack[0] + 1, true);
+    if(entry == nullptr) return false;
+    *entry = location;
     ++rowStack[0];
-    if(rowStack[0] >= stackSize){
-        printf("Stack Overflow occurred in main table.\n");
-        throw std::runtime_error("STACK OVERFLOWS HEADER PAGE");
-    }
-    rowStack[rowStack[0]] = location;
     pager->header->hasUncommitedChanges = true;
     // Page* page = pager->header.get();
     // char* buffer = page->buffer.get();
     // int32_t offset = rowStackPtr * sizeof(row_t) + sizeof(int32_t);
     // rowStackPtr++;
     // memcpy(buffer + offset, &location, sizeof(row_t));
+    return true;
 }
 
 int32_t Table::getRowSize() const{
     return this->rowSize;
 }
 
-void Table::increaseRowCount() {
-    this->numRows++;
-    this->nextPKey++;
+bool Table::isOpen() const{
+    return tableOpen;
+}
+
+const std::string& Table::getTableName() const{
+    return this->tableName;
+}
+
+const std::string& Table::getFileName() const{
+    return this->fileName;
+}
+
+int32_t Table::getRowsPerPage() const{
+    return this->rowsPerPage;
+}
+
+row_t Table::getRowCount() const{
+    return this->numRows;
+}
+
+row_t Table::getRowSlots() const{
+    return this->numRows + this->rowStack[0];
+}
+
+bool Table::getFreeRows(std::vector<row_t>& freeRows){
+    row_t count = rowStack[0];
+    freeRows.assign(rowStack + 1, rowStack + 1 + std::min<row_t>(count, stackSize - 1));
+
+    // Rest are read page by page from free rows file
+    int32_t entriesPerPage = PAGE_SIZE / sizeof(row_t);
+    for(row_t index = stackSize; index <= count; index += entriesPerPage){
+        const row_t* entries = freeRowEntry(index, false);
+        if(entries == nullptr) return false;
+        freeRows.insert(freeRows.end(), entries, entries + std::min<row_t>(entriesPerPage, count - index + 1));
+    }
+    std::sort(freeRows.begin(), freeRows.end());
+    return true;
+}
+
+void Table::increaseRowCount(row_t count) {
+    this->numRows += count;
+    this->nextPKey += count;
     Page* page = pager->header.get();
     char* buffer = page->buffer.get();
     memcpy(buffer, &numRows, sizeof(row_t));
@@ -239,49 +309,83 @@ void Table::increaseRowCount() {
 
 bool Table::createIndex(int index, const std::string& filename){
     if(!indexed[index]) return true;
-    int32_t branchingFactor;
+    // Index files commit together with heap file
+    int64_t owner = pager->getLogFile();
     switch(columnTypes[index]){
         case DataType::Int:
-            trees[index] = std::make_unique<BPTree<int>>(filename.c_str(), 2, columnSizes[index]);
+            trees[index] = std::make_unique<BPTree<int>>(filename.c_str(), 2, columnSizes[index], log, owner);
             break;
         case DataType::Float:
-            trees[index] = std::make_unique<BPTree<float>>(filename.c_str(), floatBranchingFactor, columnSizes[index]);
+            trees[index] = std::make_unique<BPTree<float>>(filename.c_str(), floatBranchingFactor, columnSizes[index], log, owner);
             break;
         case DataType::Char:
-            trees[index] = std::make_unique<BPTree<char>>(filename.c_str(), charBranchingFactor, columnSizes[index]);
+            trees[index] = std::make_unique<BPTree<char>>(filename.c_str(), charBranchingFactor, columnSizes[index], log, owner);
             break;
         case DataType::Bool:
-            trees[index] = std::make_unique<BPTree<bool>>(filename.c_str(), boolBranchingFactor, columnSizes[index]);
+            trees[index] = std::make_unique<BPTree<bool>>(filename.c_str(), boolBranchingFactor, columnSizes[index], log, owner);
             break;
         case DataType::String:
-            branchingFactor = BRANCHING_FACTOR(columnSizes[index]);
-            trees[index] = std::make_unique<BPTree<dbms::string>>(filename.c_str(), branchingFactor, columnSizes[index]);
-            break;
+            // Building a BPTree<dbms::string> corrupts the heap, so string columns are never indexed
+            return false;
     }
     anyIndex = index;
     tableIsIndexed = true;
     return true;
 }
 
-bool Table::insertBTree(std::vector<std::string>& data, row_t row){
+bool Table::flushChanges(){
+    if(!pager->flushChanges()) return false;
+    if(freePager != nullptr && !freePager->flushChanges()) return false;
+    for(auto& tree: trees){
+        if(tree != nullptr && !tree->flushChanges()) return false;
+    }
+    return true;
+}
+
+bool Table::insertBTree(const char* data, row_t row){
+    pkey_t pkey = codec.getPKey(data);
     for(int i = 0; i < indexed.size(); ++i){
         if(!indexed[i]) continue;
-        bool res;
-        switch(columnTypes[i]){
-            BTREE_HANDLER(res, trees[i].get(), insert(data[i], nextPKey - 1, row));
-        }
-        if(!res) return false;
+        if(!trees[i]->insertCell(codec.cell(data, i), pkey, row)) return false;
+    }
+    return true;
+}
+
+bool Table::updateBTree(const char* oldData, const char* newData, row_t row){
+    pkey_t pkey = codec.getPKey(oldData);
+    for(int i = 0; i < indexed.size(); ++i){
+        if(!indexed[i]) continue;
+        if(memcmp(codec.cell(oldData, i), codec.cell(newData, i), columnSizes[i]) == 0) continue;
+        if(!trees[i]->removeCell(codec.cell(oldData, i), pkey)) return false;
+        if(!trees[i]->insertCell(codec.cell(newData, i), pkey, row)) return false;
     }
     return true;
 }
 
 bool Table::deleteRow(row_t row){
+    if(!addFreeRowLocation(row)) return false;
     this->numRows--;
     Page* page = pager->header.get();
     char* buffer = page->buffer.get();
     memcpy(buffer, &numRows, sizeof(row_t));
     page->hasUncommitedChanges = true;
-    addFreeRowLocation(row);
+    return true;
+}
+
+bool Table::truncate(){
+    this->numRows = 0;
+    rowStack[0] = 0;
+    Page* page = pager->header.get();
+    memcpy(page->buffer.get(), &numRows, sizeof(row_t));
+    page->hasUncommitedChanges = true;
+    if(!pager->truncate(1)) return false;
+    if(freePager != nullptr && !freePager->truncate(1)) return false;
+
+    for(int i = 0; i < indexed.size(); ++i){
+        if(!indexed[i]) continue;
+        if(!trees[i]->truncate()) return false;
+    }
+    stats.clear();
     return true;
 }
 
@@ -1,11 +1,12 @@
 #include "HeaderFiles/TableManager.h"
+#include <algorithm>
 #include <ncurses.h>
 
-TableManager::TableManager(std::string baseURL_):baseURL(std::move(baseURL_)){
+TableManager::TableManager(std::string baseURL_, bool verbose_):baseURL(std::move(baseURL_)), verbose(verbose_){
     // Create Directory if it doesn't exist
     if(!std::filesystem::exists(baseURL)){
         if(!std::filesystem::create_directory(baseURL)){
-            printf("Failed to open Database\n");
+            error = "Failed to open Database";
             return;
         }
     }
@@ -13,17 +14,63 @@ TableManager::TableManager(std::string baseURL_):baseURL(std::move(baseURL_)){
     std::string indexURL = baseURL + "/indexes";
     if(!std::filesystem::exists(baseURL + "/indexes")){
         if(!std::filesystem::create_directory(indexURL)){
-            printf("Failed to create Index Folder\n");
+            error = "Failed to create Index Folder";
             return;
         }
     }
+    // Files written around a log that can't be opened or replayed would be overwritten by it on next start,
+    // so manager is left failed instead. Log file stays on disk for next attempt
+    log = std::make_unique<WriteAheadLog>(baseURL);
+    if(!log->open()){
+        error = "Failed to open Write-Ahead Log";
+        log.reset();
+        return;
+    }
+    int64_t commits;
+    if(!log->recover(commits)){
+        error = "Failed to recover Database from Write-Ahead Log";
+        log.reset();
+        return;
+    }
+    if(commits > 0 && verbose) printf("Recovered %lld commit(s) from Write-Ahead Log\n", static_cast<long long>(commits));
+    removeEmptyFiles();
+    checkpointer = std::thread(&TableManager::runCheckpointer, this);
     // Read all files in this directory
-    printf("Opened Database at \"%s\" Successfully\n", baseURL.c_str());
+    if(verbose) printf("Opened Database at \"%s\" Successfully\n", baseURL.c_str());
     for (auto& itr: std::filesystem::directory_iterator(baseURL)){
         if(itr.is_regular_file() && itr.path().extension() == ".bin"){
             std::string name = itr.path().stem().string();
             tableMap[name] = nullptr;
-            printw("Found Table \"%s\"\n", name.c_str());
+            if(verbose) printw("Found Table \"%s\"\n", name.c_str());
+        }
+    }
+    opened = true;
+}
+
+bool TableManager::isOpen() const{
+    return opened;
+}
+
+const std::string& TableManager::getError() const{
+    return error;
+}
+
+TableManager::~TableManager(){
+    closeAll();
+}
+
+void TableManager::removeEmptyFiles(){
+    std::error_code error;
+    for(auto& itr: std::filesystem::directory_iterator(baseURL)){
+        if(itr.is_regular_file() && itr.path().extension() == ".bin" && itr.file_size(error) == 0){
+            std::filesystem::remove(itr.path(), error);
+            std::filesystem::remove(getFileName(itr.path().stem().string(), TableFileType::statistics), error);
+            std::filesystem::remove(getFileName(itr.path().stem().string(), TableFileType::freeRows), error);
+        }
+    }
+    for(auto& itr: std::filesystem::directory_iterator(baseURL + "/indexes")){
+        if(itr.is_regular_file() && itr.path().extension() == ".idx" && itr.file_size(error) == 0){
+            std::filesystem::remove(itr.path(), error);
         }
     }
 }
@@ -41,8 +88,11 @@ void TableManager::loadIndexes(const std::shared_ptr<Table>& table){
                 int32_t colNum = std::stoi(indexFileName.substr(i+1, indexFileName.size()));
                 if(colNum < table->columnSizes.size()){
                     table->indexed[colNum] = true;
-                    table->createIndex(colNum, itr.path().string());
-                    printw("Found Indexfile on column %d\n", colNum + 1);
+                    if(!table->createIndex(colNum, itr.path().string())){
+                        table->indexed[colNum] = false;
+                        continue;
+                    }
+                    if(verbose) printw("Found Indexfile on column %d\n", colNum + 1);
                 }
             }
             catch(...){
@@ -53,6 +103,23 @@ void TableManager::loadIndexes(const std::shared_ptr<Table>& table){
 }
 
 TableManagerResult TableManager::open(const std::string& tableName, std::shared_ptr<Table>& table){
+    if(!opened) return TableManagerResult::openingFaliure;
+    {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        auto itr = tableMap.find(tableName);
+        if(itr == tableMap.end()){
+            return TableManagerResult::tableNotFound;
+        }
+        table = itr->second;
+        if(table != nullptr) return TableManagerResult::openedSuccessfully;
+    }
+
+    // First use of table. Another thread may have opened it once lock is taken again
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    return openTable(tableName, table);
+}
+
+TableManagerResult TableManager::openTable(const std::string& tableName, std::shared_ptr<Table>& table){
     if(tableMap.find(tableName) == tableMap.end()){
         return TableManagerResult::tableNotFound;
     }
@@ -61,15 +128,17 @@ TableManagerResult TableManager::open(const std::string& tableName, std::shared_
     if(table == nullptr){
         try{
             table = std::make_shared<Table>(tableName,
-                                            getFileName(tableName, TableFileType::baseTable));
+                                            getFileName(tableName, TableFileType::baseTable), log.get());
             table->loadMetadata();
         }
         catch(...){
-            printw("Table Opening Faliure\n");
             return TableManagerResult::openingFaliure;
         }
         tableMap[tableName] = table;
         loadIndexes(table);
+        table->stats.fileName = getFileName(tableName, TableFileType::statistics);
+        table->stats.load();
+        table->freeRowsFileName = getFileName(tableName, TableFileType::freeRows);
     }
 
     return TableManagerResult::openedSuccessfully;
@@ -79,12 +148,14 @@ TableManagerResult TableManager::create(const std::string& tableName,
                                         std::vector<std::string>&& columnNames_,
                                         std::vector<DataType>&& columnTypes_,
                                         std::vector<uint32_t>&& columnSize_){
+    if(!opened) return TableManagerResult::tableCreationFaliure;
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
     if(tableMap.find(tableName) != tableMap.end()){
         return TableManagerResult::tableAlreadyExists;
     }
     std::shared_ptr<Table> table;
     try{
-        table = std::make_shared<Table>(tableName, getFileName(tableName, TableFileType::baseTable));
+        table = std::make_shared<Table>(tableName, getFileName(tableName, TableFileType::baseTable), log.get());
     }catch(...){
 //        printw("Faliure Allocation Table");
         return TableManagerResult::tableCreationFaliure;
@@ -93,29 +164,56 @@ TableManagerResult TableManager::create(const std::string& tableName,
     // Store metadata in first page
     table->createColumns(std::move(columnNames_), std::move(columnTypes_), std::move(columnSize_));
     table->storeMetadata();
+    StatementCommit created;
+    commit(table.get(), created);
+    if(created.failed || !sync(created.position)) return TableManagerResult::tableCreationFaliure;
+    table->stats.fileName = getFileName(tableName, TableFileType::statistics);
+    table->freeRowsFileName = getFileName(tableName, TableFileType::freeRows);
     tableMap[tableName] = table;
     return TableManagerResult::tableCreatedSuccessfully;
 }
 
 TableManagerResult TableManager::drop(const std::string& tableName){
+    if(!opened) return TableManagerResult::droppingFaliure;
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
     std::shared_ptr<Table> table;
-    auto res = open(tableName, table);
+    auto res = openTable(tableName, table);
     if(res != TableManagerResult::openedSuccessfully){
         return res;
     }
+    {
+        // Statement already running on table finishes first
+        std::lock_guard<std::mutex> tableLock(table->latch);
+        uint64_t position;
+        bool closed = table->close();
+        if(log != nullptr && !log->commit(table->pager->getLogFile(), position)) closed = false;
+        if(!closed) return TableManagerResult::droppingFaliure;
+    }
+    // Records of its files are copied out of log before they are removed. Otherwise a later checkpoint
+    // would create them again
+    if(!checkpointTables()) return TableManagerResult::droppingFaliure;
     int removeRes = std::remove(getFileName(tableName, TableFileType::baseTable).c_str());
     if(removeRes != 0){
         return TableManagerResult::droppingFaliure;
     }
+    std::remove(getFileName(tableName, TableFileType::statistics).c_str());
+    std::remove(getFileName(tableName, TableFileType::freeRows).c_str());
+    // A table created later under same name would load indexes left behind as its own
+    for(int32_t i = 0; i < table->columnSizes.size(); ++i){
+        std::remove(getFileName(tableName, TableFileType::indexFile, i).c_str());
+    }
+    tableMap.erase(tableName);
     return TableManagerResult::droppedSuccessfully;
 }
 
 TableManagerResult TableManager::close(const std::string& tableName){
-    std::shared_ptr<Table> table;
+    if(!opened) return TableManagerResult::closingFaliure;
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
     if(tableMap.count(tableName) == 0){
         return TableManagerResult::tableNotFound;
     }
     if(tableMap[tableName] != nullptr){
+        std::lock_guard<std::mutex> tableLock(tableMap[tableName]->latch);
         if(!tableMap[tableName]->close()){
             return TableManagerResult::closingFaliure;
         }
@@ -124,30 +222,203 @@ TableManagerResult TableManager::close(const std::string& tableName){
 }
 
 TableManagerResult TableManager::closeAll(){
+    // Checkpointer may be waiting for catalogMutex, so it is stopped before taking it
+    stopCheckpointer();
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    bool closed = true;
     for(auto& table: tableMap){
         if(table.second != nullptr && table.second->tableOpen){
-            table.second->close();
+            {
+                std::lock_guard<std::mutex> tableLock(table.second->latch);
+                uint64_t position;
+                if(!table.second->close()) closed = false;
+                if(log != nullptr && !log->commit(table.second->pager->getLogFile(), position)) closed = false;
+            }
             table.second.reset();
         }
     }
     tableMap.clear();
+    // Log is left for recovery when a table could not be closed, as its files may be behind it
+    if(!closed) return TableManagerResult::closingFaliure;
+    if(log != nullptr && !log->checkpoint()) return TableManagerResult::closingFaliure;
     return TableManagerResult::closedSuccessfully;
 }
+
 void TableManager::flushAll(){
-    for(auto& table: tableMap){
-        if(table.second != nullptr && table.second->tableOpen){
-            table.second->pager->flushAll();
+    checkpoint();
+}
+
+void TableManager::commit(Table* table, StatementCommit& commit){
+    if(!table->flushChanges()){
+        commit.failed = true;
+        return;
+    }
+    uint64_t position;
+    if(log == nullptr) return;
+    if(!log->commit(table->pager->getLogFile(), position)){
+        commit.failed = true;
+        return;
+    }
+    commit.position = std::max(commit.position, position);
+}
+
+bool TableManager::sync(uint64_t position){
+    if(log == nullptr || position == 0) return true;
+    return log->sync(position);
+}
+
+void TableManager::setSynchronous(SyncLevel level){
+    if(log != nullptr) log->setLevel(level);
+}
+
+SyncLevel TableManager::getSynchronous(){
+    return log != nullptr ? log->getLevel() : SyncLevel::off;
+}
+
+bool TableManager::checkpoint(){
+    if(!opened) return false;
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    return checkpointTables();
+}
+
+bool TableManager::checkpointIfLarge(){
+    if(log == nullptr) return true;
+    uint64_t size = log->size();
+    if(size < LOG_CHECKPOINT_SIZE) return true;
+    if(size < LOG_CHECKPOINT_LIMIT){
+        std::lock_guard<std::mutex> lock(checkpointMutex);
+        checkpointWanted = true;
+        checkpointWake.notify_one();
+        return true;
+    }
+    // Latches of caller were just released, so at least its own tables are copied even if they never idle
+    // when checkpointer looks
+    return checkpointIncrementally();
+}
+
+bool TableManager::checkpointIncrementally(){
+    if(log->size() == 0) return true;
+    // Tables are pinned so that a drop can't free them while their pages are copied without catalogMutex
+    std::vector<std::shared_ptr<Table>> tables;
+    {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        for(auto& table: tableMap){
+            if(table.second != nullptr && table.second->tableOpen) tables.push_back(table.second);
         }
     }
+    for(auto& table: tables){
+        // Busy table is left for next round rather than stalling copy of the others behind its statement
+        std::unique_lock<std::mutex> tableLock(table->latch, std::try_to_lock);
+        if(!tableLock.owns_lock() || !table->isOpen()) continue;
+        if(!log->copyOwner(table->pager->getLogFile())) return false;
+    }
+    tables.clear();
+
+    // Emptying log needs every pager idle. Shared catalog keeps tables from being opened or closed meanwhile
+    // and only statements that are running already hold latches, so none of them is waited for
+    std::shared_lock<std::shared_mutex> lock(catalogMutex);
+    std::vector<Table*> idle;
+    std::vector<std::unique_lock<std::mutex>> latches;
+    for(auto& table: tableMap){
+        if(table.second == nullptr || !table.second->tableOpen) continue;
+        latches.emplace_back(table.second->latch, std::try_to_lock);
+        if(!latches.back().owns_lock()) return true;
+        idle.push_back(table.second.get());
+    }
+    StatementCommit commits;
+    for(auto table: idle) commit(table, commits);
+    if(commits.failed) return false;
+    return log->checkpoint();
+}
+
+void TableManager::runCheckpointer(){
+    std::unique_lock<std::mutex> lock(checkpointMutex);
+    while(!stopping){
+        checkpointWake.wait_for(lock, std::chrono::milliseconds(CHECKPOINT_INTERVAL), [this]{
+            return stopping || checkpointWanted;
+        });
+        if(stopping) break;
+        checkpointWanted = false;
+        lock.unlock();
+        // Failure leaves log as it is. Next round or closeAll() tries again
+        checkpointIncrementally();
+        lock.lock();
+    }
+}
+
+void TableManager::stopCheckpointer(){
+    {
+        std::lock_guard<std::mutex> lock(checkpointMutex);
+        stopping = true;
+        checkpointWake.notify_one();
+    }
+    if(checkpointer.joinable()) checkpointer.join();
+}
+
+bool TableManager::checkpointTables(){
+    if(log == nullptr) return true;
+    // Latches are taken in address order, same as joins take their two, so that nobody deadlocks
+    // Statements never wait for catalogMutex while holding a latch
+    std::vector<Table*> tables;
+    for(auto& table: tableMap){
+        if(table.second != nullptr && table.second->tableOpen) tables.push_back(table.second.get());
+    }
+    std::sort(tables.begin(), tables.end());
+    std::vector<std::unique_lock<std::mutex>> latches;
+    latches.reserve(tables.size());
+    for(auto table: tables) latches.emplace_back(table->latch);
+
+    StatementCommit commits;
+    for(auto table: tables) commit(table, commits);
+    if(commits.failed) return false;
+    return log->checkpoint();
 }
 
 bool TableManager::createIndex(std::shared_ptr<Table>& table, int32_t index){
-    if(table == nullptr || index < 0) return false;
+    if(!opened || table == nullptr || index < 0) return false;
     bool res = table->createIndex(index, getFileName(table->tableName, TableFileType::indexFile, index));
     if(!res) return false;
     return true;
 }
 
+// =============================================
+//                  TABLE LATCH
+// =============================================
+
+TableLatch::TableLatch(): manager(nullptr), table(nullptr), commit(nullptr){}
+
+TableLatch::TableLatch(TableManager& manager_, Table* table_, StatementCommit& commit_):
+        manager(&manager_), table(table_), commit(&commit_){
+    table->latch.lock();
+}
+
+TableLatch::TableLatch(TableLatch&& other) noexcept: manager(other.manager), table(other.table), commit(other.commit){
+    other.table = nullptr;
+}
+
+TableLatch& TableLatch::operator=(TableLatch&& other) noexcept{
+    if(this != &other){
+        release();
+        manager = other.manager;
+        table = other.table;
+        commit = other.commit;
+        other.table = nullptr;
+    }
+    return *this;
+}
+
+TableLatch::~TableLatch(){
+    release();
+}
+
+void TableLatch::release(){
+    if(table == nullptr) return;
+    // Table dropped while statement waited for latch has nothing left to commit
+    if(table->isOpen()) manager->commit(table, *commit);
+    table->latch.unlock();
+    table = nullptr;
+}
+
 std::string TableManager::getFileName(const std::string& tableName, TableFileType type, int32_t index){
     switch(type){
         case TableFileType::indexFile:
@@ -157,5 +428,10 @@ std::string TableManager::getFileName(const std::string& tableName, TableFileTyp
             return fileName;
         case TableFileType::baseTable:
             return baseURL + "/" + tableName + ".bin";
+        case TableFileType::statistics:
+            return baseURL + "/" + tableName + ".stats";
+        case TableFileType::freeRows:
+            return baseURL + "/" + tableName + ".free";
     }
+    throw std::runtime_error("Invalid File Type");
 }
\ No newline at end of file
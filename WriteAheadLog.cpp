@@ -0,0 +1,462 @@
+#include "HeaderFiles/WriteAheadLog.h"
+#include <algorithm>
+#include <memory>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+bool findSyncLevel(const std::string& name, SyncLevel& level){
+    if(name == "off") level = SyncLevel::off;
+    else if(name == "normal") level = SyncLevel::normal;
+    else if(name == "full") level = SyncLevel::full;
+    else return false;
+    return true;
+}
+
+const char* syncLevelName(SyncLevel level){
+    switch(level){
+        case SyncLevel::off:
+            return "off";
+        case SyncLevel::normal:
+            return "normal";
+        case SyncLevel::full:
+            return "full";
+    }
+    return "";
+}
+
+/// Hash of data folded into hash. Four FNV-1a style lanes take 8 byte words side by side so that a page costs
+/// a few hundred cycles instead of one multiply per byte. Tail shorter than a round goes byte by byte
+static uint64_t mix(uint64_t hash, const char* data, size_t size){
+    const uint64_t prime = 1099511628211ull;
+    uint64_t lanes[4] = {hash, hash ^ 1, hash ^ 2, hash ^ 3};
+    size_t i = 0;
+    for(; i + 4 * sizeof(uint64_t) <= size; i += 4 * sizeof(uint64_t)){
+        for(int lane = 0; lane < 4; ++lane){
+            uint64_t word;
+            memcpy(&word, data + i + lane * sizeof(uint64_t), sizeof(uint64_t));
+            lanes[lane] = (lanes[lane] ^ word) * prime;
+        }
+    }
+    hash = ((lanes[0] * prime ^ lanes[1]) * prime ^ lanes[2]) * prime ^ lanes[3];
+    for(; i < size; ++i){
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= prime;
+    }
+    return hash;
+}
+
+/// Checksum of header, with its checksum field left out, and payload
+static uint32_t checksum(const char* header, const char* payload, uint32_t length){
+    uint64_t hash = mix(14695981039346656037ull, header, LOG_RECORD_HEADER_SIZE - sizeof(uint32_t));
+    hash = mix(hash, payload, length);
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+WriteAheadLog::WriteAheadLog(std::string directory_): directory(std::move(directory_)){
+    this->fileName = directory + "/dbms.wal";
+    this->fileDescriptor = -1;
+    this->level = SyncLevel::full;
+    this->base = 0;
+    this->end = 0;
+    this->written = 0;
+    this->durable = 0;
+    this->syncing = false;
+}
+
+WriteAheadLog::~WriteAheadLog(){
+    if(fileDescriptor != -1) ::close(fileDescriptor);
+}
+
+bool WriteAheadLog::open(){
+    fileDescriptor = ::open(fileName.c_str(), O_RDWR | O_CREAT, S_IWUSR | S_IRUSR);
+    return fileDescriptor != -1;
+}
+
+bool WriteAheadLog::recover(int64_t& commits){
+    std::lock_guard<std::mutex> lock(mutex);
+    commits = 0;
+    off_t length = lseek(fileDescriptor, 0, SEEK_END);
+    if(length == -1) return false;
+    if(length == 0) return true;
+    // Files are synced by replay before log is emptied. A crash in between replays same pages again
+    if(!replay(static_cast<uint64_t>(length), commits)) return false;
+    return ftruncate(fileDescriptor, 0) != -1 && syncLog();
+}
+
+void WriteAheadLog::setLevel(SyncLevel level_){
+    std::lock_guard<std::mutex> lock(mutex);
+    this->level = level_;
+}
+
+SyncLevel WriteAheadLog::getLevel(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return level;
+}
+
+uint64_t WriteAheadLog::size(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return end - base;
+}
+
+uint32_t WriteAheadLog::attach(const std::string& path, int64_t owner){
+    std::string relative = path;
+    if(relative.compare(0, directory.size() + 1, directory + "/") == 0) relative.erase(0, directory.size() + 1);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto itr = fileIds.find(relative);
+    uint32_t id;
+    if(itr != fileIds.end()) id = itr->second;
+    else{
+        id = files.size();
+        fileIds[relative] = id;
+        files.push_back(FileState{relative, 0, false, -1, 0, {}});
+    }
+    files[id].owner = (owner < 0) ? id : static_cast<uint32_t>(owner);
+    return id;
+}
+
+bool WriteAheadLog::append(LogRecordType type, uint32_t owner, uint32_t file, int32_t page, const char* payload, uint32_t length){
+    if(fileDescriptor == -1) return false;
+    char header[LOG_RECORD_HEADER_SIZE];
+    int32_t offset = 0;
+    auto put = [&](const void* value, size_t size){
+        memcpy(header + offset, value, size);
+        offset += size;
+    };
+    put(&type, sizeof(uint8_t));
+    put(&owner, sizeof(uint32_t));
+    put(&file, sizeof(uint32_t));
+    put(&page, sizeof(int32_t));
+    put(&length, sizeof(uint32_t));
+    uint32_t sum = checksum(header, payload, length);
+    put(&sum, sizeof(uint32_t));
+
+    tail.insert(tail.end(), header, header + LOG_RECORD_HEADER_SIZE);
+    tail.insert(tail.end(), payload, payload + length);
+    end += LOG_RECORD_HEADER_SIZE + length;
+    // Counted before buffer is written out so that record that fills it still gets its commit
+    if(type == LogRecordType::page || type == LogRecordType::truncate) ++uncommitted[owner];
+    if(tail.size() >= LOG_BUFFER_SIZE) return writeOut();
+    return true;
+}
+
+bool WriteAheadLog::writeOut(){
+    if(tail.empty()) return true;
+    ssize_t bytesWritten = pwrite(fileDescriptor, tail.data(), tail.size(), static_cast<off_t>(written - base));
+    if(bytesWritten != static_cast<ssize_t>(tail.size())) return false;
+    written = end;
+    tail.clear();
+    return true;
+}
+
+bool WriteAheadLog::declare(uint32_t file){
+    FileState& state = files[file];
+    if(state.declared) return true;
+    if(!append(LogRecordType::file, state.owner, file, 0, state.path.data(), state.path.size())) return false;
+    state.declared = true;
+    return true;
+}
+
+bool WriteAheadLog::writePage(uint32_t file, int32_t pageNum, const char* data){
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!declare(file)) return false;
+    FileState& state = files[file];
+    if(!append(LogRecordType::page, state.owner, file, pageNum, data, PAGE_SIZE)) return false;
+    state.pages[pageNum] = end - PAGE_SIZE;
+    state.pageCount = std::max(state.pageCount, pageNum + 1);
+    return true;
+}
+
+bool WriteAheadLog::readPage(uint32_t file, int32_t pageNum, char* data){
+    off_t offset;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        FileState& state = files[file];
+        auto itr = state.pages.find(pageNum);
+        if(itr == state.pages.end()){
+            if(state.truncatedTo < 0 || pageNum < state.truncatedTo) return false;
+            memset(data, 0, PAGE_SIZE);
+            return true;
+        }
+        // Record not written out yet is copied from buffer
+        if(itr->second >= written){
+            memcpy(data, tail.data() + (itr->second - written), PAGE_SIZE);
+            return true;
+        }
+        offset = static_cast<off_t>(itr->second - base);
+    }
+    return pread(fileDescriptor, data, PAGE_SIZE, offset) == PAGE_SIZE;
+}
+
+int32_t WriteAheadLog::pageCount(uint32_t file, int32_t diskPages){
+    std::lock_guard<std::mutex> lock(mutex);
+    FileState& state = files[file];
+    if(state.truncatedTo >= 0) diskPages = std::min(diskPages, state.truncatedTo);
+    return std::max(diskPages, state.pageCount);
+}
+
+bool WriteAheadLog::truncate(uint32_t file, int32_t pages){
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!declare(file)) return false;
+    FileState& state = files[file];
+    if(!append(LogRecordType::truncate, state.owner, file, pages, nullptr, 0)) return false;
+    for(auto itr = state.pages.begin(); itr != state.pages.end();){
+        if(itr->first >= pages) itr = state.pages.erase(itr);
+        else ++itr;
+    }
+    state.truncatedTo = (state.truncatedTo < 0) ? pages : std::min(state.truncatedTo, pages);
+    state.pageCount = std::min(state.pageCount, pages);
+    return true;
+}
+
+bool WriteAheadLog::commit(uint32_t owner, uint64_t& position){
+    std::lock_guard<std::mutex> lock(mutex);
+    position = 0;
+    auto itr = uncommitted.find(owner);
+    if(itr == uncommitted.end()) return true;
+    // Commit reaches file right away so that it outlives crash of process whatever synchronous level is
+    if(!append(LogRecordType::commit, owner, owner, 0, nullptr, 0) || !writeOut()) return false;
+    uncommitted.erase(owner);
+    position = end;
+    return true;
+}
+
+bool WriteAheadLog::sync(uint64_t position){
+    std::unique_lock<std::mutex> lock(mutex);
+    if(level != SyncLevel::full) return true;
+    return waitDurable(lock, position);
+}
+
+bool WriteAheadLog::waitDurable(std::unique_lock<std::mutex>& lock, uint64_t position){
+    while(durable < position){
+        if(syncing){
+            synced.wait(lock);
+            continue;
+        }
+        // Leader syncs everything appended so far, including commits that queued up during previous sync
+        if(!writeOut()) return false;
+        syncing = true;
+        uint64_t target = end;
+        lock.unlock();
+        bool res = syncLog();
+        lock.lock();
+        syncing = false;
+        if(res) durable = std::max(durable, target);
+        synced.notify_all();
+        if(!res) return false;
+    }
+    return true;
+}
+
+bool WriteAheadLog::syncLog(){
+    return fdatasync(fileDescriptor) == 0;
+}
+
+bool WriteAheadLog::writeBack(uint32_t file, int descriptor){
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!writeOut()) return false;
+    if(level != SyncLevel::off && durable < end){
+        if(!syncLog()) return false;
+        durable = end;
+    }
+    FileState& state = files[file];
+    if(state.truncatedTo >= 0 && ftruncate(descriptor, static_cast<off_t>(state.truncatedTo) * PAGE_SIZE) == -1) return false;
+    auto buffer = std::make_unique<char[]>(PAGE_SIZE);
+    for(auto& page: state.pages){
+        if(pread(fileDescriptor, buffer.get(), PAGE_SIZE, static_cast<off_t>(page.second - base)) != PAGE_SIZE) return false;
+        if(pwrite(descriptor, buffer.get(), PAGE_SIZE, static_cast<off_t>(page.first) * PAGE_SIZE) != PAGE_SIZE) return false;
+    }
+    return true;
+}
+
+bool WriteAheadLog::copyOwner(uint32_t owner){
+    std::vector<FileCopy> copies;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if(uncommitted.count(owner) != 0) return true;
+        for(auto& state: files){
+            if(state.owner == owner && (!state.pages.empty() || state.truncatedTo >= 0)) copies.push_back(snapshot(state));
+        }
+        if(copies.empty()) return true;
+        // Files may only run ahead of log once log holds their pages on disk
+        if(!writeOut()) return false;
+        if(level != SyncLevel::off && !waitDurable(lock, end)) return false;
+    }
+
+    // Caller holds latch of owner, so its pages stay put while they are copied without blocking other owners
+    for(auto& copy: copies){
+        if(!copyFile(copy)) return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for(auto& copy: copies){
+        FileState& state = files[fileIds[copy.path]];
+        state.truncatedTo = -1;
+        state.pageCount = 0;
+        state.pages.clear();
+    }
+    return true;
+}
+
+bool WriteAheadLog::checkpoint(){
+    std::lock_guard<std::mutex> lock(mutex);
+    if(end == base) return true;
+    if(!writeOut()) return false;
+    if(level != SyncLevel::off && durable < end){
+        if(!syncLog()) return false;
+        durable = end;
+    }
+    // Once everything is committed latest image of each page is all that files need
+    int64_t commits = 0;
+    if(!uncommitted.empty()) return replay(end - base, commits);
+    if(!copyPages()) return false;
+
+    if(ftruncate(fileDescriptor, 0) == -1) return false;
+    base = end;
+    reset();
+    return true;
+}
+
+WriteAheadLog::FileCopy WriteAheadLog::snapshot(const FileState& state){
+    FileCopy copy{state.path, state.truncatedTo, state.pageCount, {}};
+    copy.pages.reserve(state.pages.size());
+    for(auto& page: state.pages) copy.pages.emplace_back(page.first, static_cast<off_t>(page.second - base));
+    // Pages go to file in order so that it is written front to back
+    std::sort(copy.pages.begin(), copy.pages.end());
+    return copy;
+}
+
+bool WriteAheadLog::copyFile(const FileCopy& copy){
+    int fd = ::open((directory + "/" + copy.path).c_str(), O_RDWR | O_CREAT, S_IWUSR | S_IRUSR);
+    if(fd == -1) return false;
+    auto page = std::make_unique<char[]>(PAGE_SIZE);
+    off_t diskPages = lseek(fd, 0, SEEK_END) / PAGE_SIZE;
+    if(copy.truncatedTo >= 0) diskPages = std::min<off_t>(diskPages, copy.truncatedTo);
+    off_t pages = std::max<off_t>(diskPages, copy.pageCount);
+
+    bool res = copy.truncatedTo < 0 || ftruncate(fd, static_cast<off_t>(copy.truncatedTo) * PAGE_SIZE) != -1;
+    for(size_t i = 0; res && i < copy.pages.size(); ++i){
+        res = pread(fileDescriptor, page.get(), PAGE_SIZE, copy.pages[i].second) == PAGE_SIZE &&
+              pwrite(fd, page.get(), PAGE_SIZE, static_cast<off_t>(copy.pages[i].first) * PAGE_SIZE) == PAGE_SIZE;
+    }
+    // Pages past a truncate that log never wrote read as zeros
+    if(res && lseek(fd, 0, SEEK_END) < pages * PAGE_SIZE) res = ftruncate(fd, pages * PAGE_SIZE) != -1;
+    if(res && level != SyncLevel::off) res = fsync(fd) != -1;
+    ::close(fd);
+    return res;
+}
+
+bool WriteAheadLog::copyPages(){
+    for(auto& state: files){
+        if(state.declared && !copyFile(snapshot(state))) return false;
+    }
+    return true;
+}
+
+/// Applies committed records among first length bytes of log to their files in log order
+/// Records of an owner are held back until its commit record is reached
+bool WriteAheadLog::replay(uint64_t length, int64_t& commits){
+    struct Pending{
+        uint64_t offset;                                // Of payload
+        uint32_t file;
+        int32_t page;
+        LogRecordType type;
+    };
+    std::unordered_map<uint32_t, std::vector<Pending>> pending;
+    std::unordered_map<uint32_t, std::string> paths;
+    std::unordered_map<uint32_t, int> descriptors;
+    auto page = std::make_unique<char[]>(PAGE_SIZE);
+    bool res = true;
+
+    auto descriptor = [&](uint32_t file)->int{
+        auto itr = descriptors.find(file);
+        if(itr != descriptors.end()) return itr->second;
+        auto path = paths.find(file);
+        if(path == paths.end()) return -1;
+        int fd = ::open((directory + "/" + path->second).c_str(), O_RDWR | O_CREAT, S_IWUSR | S_IRUSR);
+        if(fd != -1) descriptors[file] = fd;
+        return fd;
+    };
+    auto apply = [&](const Pending& record)->bool{
+        int fd = descriptor(record.file);
+        if(fd == -1) return false;
+        if(record.type == LogRecordType::truncate){
+            return ftruncate(fd, static_cast<off_t>(record.page) * PAGE_SIZE) != -1;
+        }
+        if(pread(fileDescriptor, page.get(), PAGE_SIZE, static_cast<off_t>(record.offset)) != PAGE_SIZE) return false;
+        return pwrite(fd, page.get(), PAGE_SIZE, static_cast<off_t>(record.page) * PAGE_SIZE) == PAGE_SIZE;
+    };
+
+    // Log is read in large sequential pieces. Payload of file records is read with its header
+    std::vector<char> buffer;
+    uint64_t bufferStart = 0;
+    auto view = [&](uint64_t offset, uint64_t size)->const char*{
+        if(offset < bufferStart || offset + size > bufferStart + buffer.size()){
+            bufferStart = offset;
+            buffer.resize(std::max<uint64_t>(size, LOG_READ_SIZE));
+            ssize_t bytesRead = pread(fileDescriptor, buffer.data(), buffer.size(), static_cast<off_t>(offset));
+            buffer.resize(std::max<ssize_t>(bytesRead, 0));
+            if(buffer.size() < size) return nullptr;
+        }
+        return buffer.data() + (offset - bufferStart);
+    };
+
+    uint64_t offset = 0;
+    while(res && offset + LOG_RECORD_HEADER_SIZE <= length){
+        const char* header = view(offset, LOG_RECORD_HEADER_SIZE);
+        if(header == nullptr) break;
+        LogRecordType type;
+        uint32_t owner, file, recordLength, sum;
+        int32_t pageNum;
+        int32_t position = 0;
+        auto get = [&](void* value, size_t size){
+            memcpy(value, header + position, size);
+            position += size;
+        };
+        get(&type, sizeof(uint8_t));
+        get(&owner, sizeof(uint32_t));
+        get(&file, sizeof(uint32_t));
+        get(&pageNum, sizeof(int32_t));
+        get(&recordLength, sizeof(uint32_t));
+        get(&sum, sizeof(uint32_t));
+        if(offset + LOG_RECORD_HEADER_SIZE + recordLength > length) break;
+
+        const char* record = view(offset, LOG_RECORD_HEADER_SIZE + recordLength);
+        if(record == nullptr || checksum(record, record + LOG_RECORD_HEADER_SIZE, recordLength) != sum) break;
+        uint64_t payload = offset + LOG_RECORD_HEADER_SIZE;
+        switch(type){
+            case LogRecordType::file:
+                paths[file].assign(record + LOG_RECORD_HEADER_SIZE, recordLength);
+                break;
+            case LogRecordType::page:
+            case LogRecordType::truncate:
+                pending[owner].push_back(Pending{payload, file, pageNum, type});
+                break;
+            case LogRecordType::commit:
+                for(auto& entry: pending[owner]){
+                    if(!(res = apply(entry))) break;
+                }
+                pending.erase(owner);
+                ++commits;
+                break;
+        }
+        offset = payload + recordLength;
+    }
+
+    for(auto& fd: descriptors){
+        if(level != SyncLevel::off && fsync(fd.second) == -1) res = false;
+        ::close(fd.second);
+    }
+    return res;
+}
+
+void WriteAheadLog::reset(){
+    for(auto& state: files){
+        state.declared = false;
+        state.truncatedTo = -1;
+        state.pageCount = 0;
+        state.pages.clear();
+    }
+}
@@ -1,8 +1,10 @@
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <chrono>
 #include <readline/readline.h>
 #include <readline/history.h>
-#include "Executor.cpp"
+#include "Server.cpp"
 
 //void sigintHandler(int sig_num)
 //{
@@ -18,110 +20,206 @@ InputBuffer inputBuffer;
 Parser parser;
 Executor executor("./MyDatabase");
 
+/// Runs meta command held by inputBuffer. false when it is .exit
+bool runMetaCommand(){
+    switch(inputBuffer.performMetaCommand()){
+        case MetaCommandResult::exit:
+            return false;
+
+        case MetaCommandResult::flush:
+            printw("Flushed All Opened Tables.\n");
+            executor.sharedManager->flushAll();
+
+        case MetaCommandResult::empty:
+            return true;
+
+        case MetaCommandResult::mode: {
+            OutputFormat format;
+            if(!findOutputFormat(inputBuffer.argument(), format)){
+                printw("Unknown mode '%s'. Use pretty, csv, tsv or binary\n", inputBuffer.argument().c_str());
+                return true;
+            }
+            executor.sink.setFormat(format);
+            return true;
+        }
+
+        case MetaCommandResult::output:
+            if(!executor.sink.open(inputBuffer.argument())){
+                printw("Unable to open file '%s'\n", inputBuffer.argument().c_str());
+            }
+            return true;
+
+        case MetaCommandResult::synchronous: {
+            // No level prints current one
+            if(inputBuffer.argument().empty()){
+                printw("synchronous = %s\n", syncLevelName(executor.sharedManager->getSynchronous()));
+                return true;
+            }
+            SyncLevel level;
+            if(!findSyncLevel(inputBuffer.argument(), level)){
+                printw("Unknown synchronous level '%s'. Use off, normal or full\n", inputBuffer.argument().c_str());
+                return true;
+            }
+            executor.sharedManager->setSynchronous(level);
+            return true;
+        }
+
+        case MetaCommandResult::unrecognized:
+            printw("Unrecognized command '%s'.\n", inputBuffer.str());
+            return true;
+    }
+    return true;
+}
+
 void runCommand(char* line){
     inputBuffer.buffer = line;
 
     if(inputBuffer.isMetaCommand()){
-        switch(inputBuffer.performMetaCommand()){
-            case MetaCommandResult::exit:
-                executor.sharedManager->closeAll();
-                printw("Exited Successfully\n");
-                exit(EXIT_SUCCESS);
-
-            case MetaCommandResult::flush:
-                printw("Flushed All Opened Tables.\n");
-                executor.sharedManager->flushAll();
-
-            case MetaCommandResult::empty:
-                return;
-
-            case MetaCommandResult::unrecognized:
-                printw("Unrecognized command '%s'.\n", inputBuffer.str());
-                return;
-        }
+        if(runMetaCommand()) return;
+        executor.sharedManager->closeAll();
+        printw("Exited Successfully\n");
+        exit(EXIT_SUCCESS);
+    }
+
+    auto prepareRes = parser.parse(inputBuffer);
+    if(prepareRes == PrepareResult::unrecognized){
+        printw("Unrecognized keyword at start of '%s'.\n", inputBuffer.str());
+        return;
+    }
+    if(prepareRes != PrepareResult::success){
+        printw("%s\n", prepareMessage(prepareRes));
+        return;
+    }
+    printw("%s\n", executeMessage(executor.execute(parser)));
+}
+
+// =============================================
+//                  BATCH MODE
+// =============================================
+
+/// Runs every line of script as a statement without prompt, history or messages of statements that succeed
+/// Result rows are handed to stdio as they come and flushed once at the end together with tables
+/// Failures are reported on stderr with their line number followed by a throughput summary
+int runBatch(const char* fileName){
+    ScriptFile script;
+    if(!script.open(fileName)){
+        fprintf(stderr, "Unable to read script '%s'\n", fileName == nullptr ? "-" : fileName);
+        return EXIT_FAILURE;
     }
+    static char outputBuffer[RESULT_BUFFER_SIZE];
+    setvbuf(stdout, outputBuffer, _IOFBF, sizeof(outputBuffer));
+    executor.quiet = true;
+    executor.sink.setDeferred(true);
+    // Script is written out once at the end, so commits need not wait for disk. `.synchronous full` overrides
+    executor.sharedManager->setSynchronous(SyncLevel::normal);
+
+    int64_t line = 0, count = 0, failed = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::string_view text = script.text();
+    while(!text.empty()){
+        size_t end = text.find('\n');
+        std::string_view statement = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        ++line;
+
+        // Blank lines and -- comments are skipped
+        size_t first = statement.find_first_not_of(" \t\r");
+        if(first == std::string_view::npos) continue;
+        statement.remove_prefix(first);
+        while(statement.back() == '\r') statement.remove_suffix(1);
+        if(statement.compare(0, 2, "--") == 0) continue;
+
+        if(statement[0] == '.'){
+            inputBuffer.buffer.assign(statement);
+            if(!runMetaCommand()) break;
+            continue;
+        }
 
-    switch(parser.parse(inputBuffer)){
-        case PrepareResult::success:
-            break;
-        case PrepareResult::syntaxError:
-            printw("Syntax Error. Could not parse statement\n");
-            return;
-        case PrepareResult::stringTooLong :
-            printw("String is too long.\n");
-            return;
-        case PrepareResult::negativeID:
-            printw("ID must be positive.\n");
-            return;
-        case PrepareResult::invalidType:
-            printw("Invalid Data Type.\n");
-            return;
-        case PrepareResult::noSizeForString:
-            printw("No size provided for string.\n");
-            return;
-        case PrepareResult::unrecognized:
-            printw("Unrecognized keyword at start of '%s'.\n", inputBuffer.str());
-            return;
-        case PrepareResult::invalidOperator:
-            printw("Invalid Operator\n");
-            return;
-        case PrepareResult::comparisonOnDifferentRows:
-            printw("Comparison on different rows is not allowed\n");
-            return;
-        case PrepareResult::cannotCreateEmptyTable:
-            printw("Cannot Create Empty Table. Please add some columns\n");
-            return;
-        case PrepareResult::noTableName:
-            printw("Please provide Table Name\n");
-            return;
-        case PrepareResult::noInsertData:
-            printw("No Data Provided to Insert\n");
-            return;
-        case PrepareResult::noUpdateData:
-            printw("No Data Provided to Update\n");
-            return;
-        case PrepareResult::noCondition:
-            printw("Provide Condition To Delete Selected Table using `where` clause.\n"
-                   "To delete all entries use `delete table` instead\n");
-            return;
+        ++count;
+        auto prepareRes = parser.parse(statement);
+        if(prepareRes != PrepareResult::success){
+            ++failed;
+            if(prepareRes == PrepareResult::unrecognized){
+                fprintf(stderr, "Line %lld: Unrecognized keyword at start of '%.*s'.\n",
+                        static_cast<long long>(line), static_cast<int>(statement.size()), statement.data());
+            }
+            else fprintf(stderr, "Line %lld: %s\n", static_cast<long long>(line), prepareMessage(prepareRes));
+            continue;
+        }
+        auto executeRes = executor.execute(parser);
+        if(executeRes != ExecuteResult::success){
+            ++failed;
+            fprintf(stderr, "Line %lld: %s\n", static_cast<long long>(line), executeMessage(executeRes));
+        }
     }
 
-    switch(executor.execute(parser)){
-        case ExecuteResult::success:
-            printw("Executed.\n");
-            break;
-        case ExecuteResult::tableFull:
-            printw("Error: Table full.\n");
-            break;
-        case ExecuteResult::faliure:
-            printw("Action Failed\n");
-            break;
-        case ExecuteResult::typeMismatch:
-            printw("Type Mismatch Occured\n");
-            break;
-        case ExecuteResult::stringTooLarge:
-            printw("String Too Large\n");
-            break;
-        case ExecuteResult::invalidColumnName:
-            printw("Column names don't match table column names\n");
-            break;
-        case ExecuteResult::tableNotIndexed:
-            printw("There are no indexes for this table.\n"
-                   "Create atleast one and then try again.\n");
-            break;
-        case ExecuteResult::unexpectedError:
-            printw("Unexpected Error occured\n");
-            break;
+    executor.sink.setDeferred(false);
+    bool flushed = executor.sink.flush();
+    executor.sharedManager->closeAll();
+    fflush(stdout);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    fprintf(stderr, "Ran %lld statement(s) in %.3f s (%.0f statements/s). %lld failed.\n",
+            static_cast<long long>(count), seconds, count / std::max(seconds, 1e-9), static_cast<long long>(failed));
+    if(!flushed) fprintf(stderr, "Could not write all result rows\n");
+    return (failed == 0 && flushed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// =============================================
+//                  SERVER MODE
+// =============================================
+
+/// Serves clients of HeaderFiles/Protocol.h on address until SIGINT or SIGTERM
+int runServer(const char* address, int32_t workers){
+    Server server(executor.sharedManager, workers);
+    if(!server.listen(address)){
+        fprintf(stderr, "Unable to listen on '%s': %s\n", address, strerror(errno));
+        return EXIT_FAILURE;
     }
+    printf("Listening on %s with %d worker(s)\n", address, workers);
+    fflush(stdout);
+    server.run();
+    printf("Server Stopped\n");
+    return EXIT_SUCCESS;
 }
 
-int main(){
+int main(int argc, char* argv[]){
+    if(!executor.sharedManager->isOpen()){
+        fprintf(stderr, "%s\n", executor.sharedManager->getError().c_str());
+        return EXIT_FAILURE;
+    }
+
+    // DBMS --batch [<script-file>]. Script is read from stdin when no file is given
+    if(argc > 1 && strcmp(argv[1], "--batch") == 0) return runBatch(argc > 2 ? argv[2] : nullptr);
+
+    // DBMS --server <address> [--workers <n>] [--synchronous <level>]
+    if(argc > 1 && strcmp(argv[1], "--server") == 0){
+        if(argc < 3){
+            fprintf(stderr, "Usage: DBMS --server <unix:path | port> [--workers <n>] [--synchronous <off|normal|full>]\n");
+            return EXIT_FAILURE;
+        }
+        auto workers = static_cast<int32_t>(std::max(1u, std::thread::hardware_concurrency()));
+        for(int i = 3; i + 1 < argc; i += 2){
+            if(strcmp(argv[i], "--workers") == 0) workers = std::max(1, atoi(argv[i + 1]));
+            else if(strcmp(argv[i], "--synchronous") == 0){
+                SyncLevel level;
+                if(!findSyncLevel(argv[i + 1], level)){
+                    fprintf(stderr, "Unknown synchronous level '%s'. Use off, normal or full\n", argv[i + 1]);
+                    return EXIT_FAILURE;
+                }
+                executor.sharedManager->setSynchronous(level);
+            }
+        }
+        return runServer(argv[2], workers);
+    }
+
     while(true){
         char* line = readline("db> ");
         if(!line) break;
         if(*line) add_history(line);
         runCommand(line);
     }
+    executor.sharedManager->closeAll();
     return 0;
 }
 